@@ -0,0 +1,472 @@
+/*
+// @author anonymized
+// @last-modified 2018-08
+// Copyright 2018 anonymized
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+*/
+#ifndef _BITSLICED_H_
+#define _BITSLICED_H_
+
+// ---------------------------------------------------------------------
+// Bitsliced AES rounds on sixteen blocks in eight AVX2 registers, for hosts
+// without AES-NI. Each 128-bit lane holds eight blocks: register i holds bit
+// i of every byte, and bit j of byte k of a lane holds byte k of block j of
+// that lane. Byte permutations of the state, such as ShiftRows and the tweak
+// permutation h, are PSHUFBs on every register, and the S-box is a Boolean
+// circuit on the eight registers. No memory access or branch depends on the
+// data.
+// ---------------------------------------------------------------------
+
+#include <immintrin.h>
+#include <stddef.h>
+
+#include "utils-opt.h"
+
+// ---------------------------------------------------------------------
+// Constants
+// ---------------------------------------------------------------------
+
+#define BITSLICED_NUM_BLOCKS        16
+
+#define BITSLICED_SHIFT_ROWS \
+    avx_setr8(0x00, 0x05, 0x0a, 0x0f, 0x04, 0x09, 0x0e, 0x03, \
+              0x08, 0x0d, 0x02, 0x07, 0x0c, 0x01, 0x06, 0x0b, \
+              0x00, 0x05, 0x0a, 0x0f, 0x04, 0x09, 0x0e, 0x03, \
+              0x08, 0x0d, 0x02, 0x07, 0x0c, 0x01, 0x06, 0x0b)
+#define BITSLICED_INV_SHIFT_ROWS \
+    avx_setr8(0x00, 0x0d, 0x0a, 0x07, 0x04, 0x01, 0x0e, 0x0b, \
+              0x08, 0x05, 0x02, 0x0f, 0x0c, 0x09, 0x06, 0x03, \
+              0x00, 0x0d, 0x0a, 0x07, 0x04, 0x01, 0x0e, 0x0b, \
+              0x08, 0x05, 0x02, 0x0f, 0x0c, 0x09, 0x06, 0x03)
+
+// Byte i + 1 and byte i + 2 of the column of byte i
+#define BITSLICED_ROTATE_ONE \
+    avx_setr8(0x01, 0x02, 0x03, 0x00, 0x05, 0x06, 0x07, 0x04, \
+              0x09, 0x0a, 0x0b, 0x08, 0x0d, 0x0e, 0x0f, 0x0c, \
+              0x01, 0x02, 0x03, 0x00, 0x05, 0x06, 0x07, 0x04, \
+              0x09, 0x0a, 0x0b, 0x08, 0x0d, 0x0e, 0x0f, 0x0c)
+#define BITSLICED_ROTATE_TWO \
+    avx_setr8(0x02, 0x03, 0x00, 0x01, 0x06, 0x07, 0x04, 0x05, \
+              0x0a, 0x0b, 0x08, 0x09, 0x0e, 0x0f, 0x0c, 0x0d, \
+              0x02, 0x03, 0x00, 0x01, 0x06, 0x07, 0x04, 0x05, \
+              0x0a, 0x0b, 0x08, 0x09, 0x0e, 0x0f, 0x0c, 0x0d)
+
+// ---------------------------------------------------------------------
+// Macros
+// ---------------------------------------------------------------------
+
+/**
+ * Swaps the bits of a selected by mask << n with the bits of b selected by
+ * mask.
+ */
+#define bitsliced_swap_move(a, b, mask, n) {\
+    const __m256i tmp = avx_and(avx_xor(_mm256_srli_epi64(a, n), b), mask); \
+    b = avx_xor(b, tmp); \
+    a = avx_xor(a, _mm256_slli_epi64(tmp, n)); \
+}
+
+// ---------------------------------------------------------------------
+// Conversion
+// ---------------------------------------------------------------------
+
+/**
+ * Transposes the 8x8 bit matrix of every byte position over the eight
+ * registers. Converts from one block per register to bit planes and back.
+ */
+static inline void bitsliced_transpose(__m256i x[8]) {
+    const __m256i mask_one = avx_set8(0x55);
+    const __m256i mask_two = avx_set8(0x33);
+    const __m256i mask_four = avx_set8(0x0f);
+
+    bitsliced_swap_move(x[0], x[1], mask_one, 1);
+    bitsliced_swap_move(x[2], x[3], mask_one, 1);
+    bitsliced_swap_move(x[4], x[5], mask_one, 1);
+    bitsliced_swap_move(x[6], x[7], mask_one, 1);
+
+    bitsliced_swap_move(x[0], x[2], mask_two, 2);
+    bitsliced_swap_move(x[1], x[3], mask_two, 2);
+    bitsliced_swap_move(x[4], x[6], mask_two, 2);
+    bitsliced_swap_move(x[5], x[7], mask_two, 2);
+
+    bitsliced_swap_move(x[0], x[4], mask_four, 4);
+    bitsliced_swap_move(x[1], x[5], mask_four, 4);
+    bitsliced_swap_move(x[2], x[6], mask_four, 4);
+    bitsliced_swap_move(x[3], x[7], mask_four, 4);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Blocks i and i + 8 go to the low and high lane of register i.
+ */
+static inline void bitsliced_load(__m256i x[8],
+                                  const __m128i blocks[BITSLICED_NUM_BLOCKS]) {
+    for (size_t i = 0; i < 8; ++i) {
+        x[i] = _mm256_set_m128i(blocks[i + 8], blocks[i]);
+    }
+
+    bitsliced_transpose(x);
+}
+
+// ---------------------------------------------------------------------
+
+static inline void bitsliced_store(__m128i blocks[BITSLICED_NUM_BLOCKS],
+                                   __m256i x[8]) {
+    bitsliced_transpose(x);
+
+    for (size_t i = 0; i < 8; ++i) {
+        blocks[i] = _mm256_castsi256_si128(x[i]);
+        blocks[i + 8] = _mm256_extracti128_si256(x[i], 1);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * The bit planes of sixteen copies of block.
+ */
+static inline void bitsliced_broadcast(__m256i x[8], const __m128i block) {
+    const __m256i value = _mm256_broadcastsi128_si256(block);
+
+    for (int i = 0; i < 8; ++i) {
+        const __m256i bit = avx_set8(1 << i);
+        x[i] = _mm256_cmpeq_epi8(avx_and(value, bit), bit);
+    }
+}
+
+// ---------------------------------------------------------------------
+// Linear operations
+// ---------------------------------------------------------------------
+
+static inline void bitsliced_xor(__m256i x[8], const __m256i y[8]) {
+    for (size_t i = 0; i < 8; ++i) {
+        x[i] = avx_xor(x[i], y[i]);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Byte i of the state becomes byte table[i], as PSHUFB on a single block.
+ */
+static inline void bitsliced_shuffle(__m256i x[8], const __m256i table) {
+    for (size_t i = 0; i < 8; ++i) {
+        x[i] = _mm256_shuffle_epi8(x[i], table);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Multiplies every byte by 2 in GF(2^8).
+ */
+static inline void bitsliced_xtime(__m256i x[8]) {
+    const __m256i msb = x[7];
+    x[7] = x[6];
+    x[6] = x[5];
+    x[5] = x[4];
+    x[4] = avx_xor(x[3], msb);
+    x[3] = avx_xor(x[2], msb);
+    x[2] = x[1];
+    x[1] = avx_xor(x[0], msb);
+    x[0] = msb;
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * LFSR2 of Deoxys-BC on every byte: (x7 .. x0) -> (x6 .. x0, x7 ^ x5).
+ */
+static inline void bitsliced_lfsr_two(__m256i x[8]) {
+    const __m256i lsb = avx_xor(x[7], x[5]);
+    x[7] = x[6];
+    x[6] = x[5];
+    x[5] = x[4];
+    x[4] = x[3];
+    x[3] = x[2];
+    x[2] = x[1];
+    x[1] = x[0];
+    x[0] = lsb;
+}
+
+// ---------------------------------------------------------------------
+
+static inline void bitsliced_lfsr_two_inverse(__m256i x[8]) {
+    const __m256i msb = avx_xor(x[0], x[6]);
+    x[0] = x[1];
+    x[1] = x[2];
+    x[2] = x[3];
+    x[3] = x[4];
+    x[4] = x[5];
+    x[5] = x[6];
+    x[6] = x[7];
+    x[7] = msb;
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * 2 * x_i + 3 * x_{i+1} + x_{i+2} + x_{i+3} in every column.
+ */
+static inline void bitsliced_mix_columns(__m256i x[8]) {
+    __m256i sum[8];
+    __m256i rest[8];
+
+    for (size_t i = 0; i < 8; ++i) {
+        const __m256i one = _mm256_shuffle_epi8(x[i], BITSLICED_ROTATE_ONE);
+        sum[i] = avx_xor(x[i], one);
+        rest[i] = avx_xor(one, _mm256_shuffle_epi8(sum[i],
+                                                   BITSLICED_ROTATE_TWO));
+    }
+
+    bitsliced_xtime(sum);
+
+    for (size_t i = 0; i < 8; ++i) {
+        x[i] = avx_xor(sum[i], rest[i]);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * InvMixColumns is MixColumns after multiplying every column with the
+ * circulant (5, 0, 4, 0).
+ */
+static inline void bitsliced_inv_mix_columns(__m256i x[8]) {
+    __m256i four_times[8];
+
+    for (size_t i = 0; i < 8; ++i) {
+        const __m256i two = _mm256_shuffle_epi8(x[i], BITSLICED_ROTATE_TWO);
+        four_times[i] = avx_xor(x[i], two);
+    }
+
+    bitsliced_xtime(four_times);
+    bitsliced_xtime(four_times);
+    bitsliced_xor(x, four_times);
+    bitsliced_mix_columns(x);
+}
+
+// ---------------------------------------------------------------------
+// S-box, generated by scripts/bitsliced-sbox.py
+// ---------------------------------------------------------------------
+
+// 32 AND, 79 XOR, and 4 XNOR gates
+static inline void bitsliced_sub_bytes(__m256i state[8]) {
+    const __m256i ones = avx_set8(-1);
+    const __m256i x0 = state[7];
+    const __m256i x1 = state[6];
+    const __m256i x2 = state[5];
+    const __m256i x3 = state[4];
+    const __m256i x4 = state[3];
+    const __m256i x5 = state[2];
+    const __m256i x6 = state[1];
+    const __m256i x7 = state[0];
+    const __m256i y14 = avx_xor(x3, x5);
+    const __m256i y13 = avx_xor(x0, x6);
+    const __m256i y9 = avx_xor(x0, x3);
+    const __m256i y8 = avx_xor(x0, x5);
+    const __m256i t0 = avx_xor(x1, x2);
+    const __m256i y1 = avx_xor(t0, x7);
+    const __m256i y4 = avx_xor(y1, x3);
+    const __m256i y12 = avx_xor(y13, y14);
+    const __m256i y2 = avx_xor(y1, x0);
+    const __m256i y5 = avx_xor(y1, x6);
+    const __m256i y3 = avx_xor(y5, y8);
+    const __m256i t1 = avx_xor(x4, y12);
+    const __m256i y15 = avx_xor(t1, x5);
+    const __m256i y20 = avx_xor(t1, x1);
+    const __m256i y6 = avx_xor(y15, x7);
+    const __m256i y10 = avx_xor(y15, t0);
+    const __m256i y11 = avx_xor(y20, y9);
+    const __m256i y7 = avx_xor(x7, y11);
+    const __m256i y17 = avx_xor(y10, y11);
+    const __m256i y19 = avx_xor(y10, y8);
+    const __m256i y16 = avx_xor(t0, y11);
+    const __m256i y21 = avx_xor(y13, y16);
+    const __m256i y18 = avx_xor(x0, y16);
+    const __m256i t2 = avx_and(y12, y15);
+    const __m256i t3 = avx_and(y3, y6);
+    const __m256i t4 = avx_xor(t3, t2);
+    const __m256i t5 = avx_and(y4, x7);
+    const __m256i t6 = avx_xor(t5, t2);
+    const __m256i t7 = avx_and(y13, y16);
+    const __m256i t8 = avx_and(y5, y1);
+    const __m256i t9 = avx_xor(t8, t7);
+    const __m256i t10 = avx_and(y2, y7);
+    const __m256i t11 = avx_xor(t10, t7);
+    const __m256i t12 = avx_and(y9, y11);
+    const __m256i t13 = avx_and(y14, y17);
+    const __m256i t14 = avx_xor(t13, t12);
+    const __m256i t15 = avx_and(y8, y10);
+    const __m256i t16 = avx_xor(t15, t12);
+    const __m256i t17 = avx_xor(t4, t14);
+    const __m256i t18 = avx_xor(t6, t16);
+    const __m256i t19 = avx_xor(t9, t14);
+    const __m256i t20 = avx_xor(t11, t16);
+    const __m256i t21 = avx_xor(t17, y20);
+    const __m256i t22 = avx_xor(t18, y19);
+    const __m256i t23 = avx_xor(t19, y21);
+    const __m256i t24 = avx_xor(t20, y18);
+    const __m256i t25 = avx_xor(t21, t22);
+    const __m256i t26 = avx_and(t21, t23);
+    const __m256i t27 = avx_xor(t24, t26);
+    const __m256i t28 = avx_and(t25, t27);
+    const __m256i t29 = avx_xor(t28, t22);
+    const __m256i t30 = avx_xor(t23, t24);
+    const __m256i t31 = avx_xor(t22, t26);
+    const __m256i t32 = avx_and(t31, t30);
+    const __m256i t33 = avx_xor(t32, t24);
+    const __m256i t34 = avx_xor(t23, t33);
+    const __m256i t35 = avx_xor(t27, t33);
+    const __m256i t36 = avx_and(t24, t35);
+    const __m256i t37 = avx_xor(t36, t34);
+    const __m256i t38 = avx_xor(t27, t36);
+    const __m256i t39 = avx_and(t29, t38);
+    const __m256i t40 = avx_xor(t25, t39);
+    const __m256i t41 = avx_xor(t40, t37);
+    const __m256i t42 = avx_xor(t29, t33);
+    const __m256i t43 = avx_xor(t29, t40);
+    const __m256i t44 = avx_xor(t33, t37);
+    const __m256i t45 = avx_xor(t42, t41);
+    const __m256i z0 = avx_and(t44, y15);
+    const __m256i z1 = avx_and(t37, y6);
+    const __m256i z2 = avx_and(t33, x7);
+    const __m256i z3 = avx_and(t43, y16);
+    const __m256i z4 = avx_and(t40, y1);
+    const __m256i z5 = avx_and(t29, y7);
+    const __m256i z6 = avx_and(t42, y11);
+    const __m256i z7 = avx_and(t45, y17);
+    const __m256i z8 = avx_and(t41, y10);
+    const __m256i z9 = avx_and(t44, y12);
+    const __m256i z10 = avx_and(t37, y3);
+    const __m256i z11 = avx_and(t33, y4);
+    const __m256i z12 = avx_and(t43, y13);
+    const __m256i z13 = avx_and(t40, y5);
+    const __m256i z14 = avx_and(t29, y2);
+    const __m256i z15 = avx_and(t42, y9);
+    const __m256i z16 = avx_and(t45, y14);
+    const __m256i z17 = avx_and(t41, y8);
+    const __m256i t46 = avx_xor(z15, z16);
+    const __m256i t47 = avx_xor(z10, z11);
+    const __m256i t48 = avx_xor(z5, z13);
+    const __m256i t49 = avx_xor(z9, z10);
+    const __m256i t50 = avx_xor(z2, z12);
+    const __m256i t51 = avx_xor(z2, z5);
+    const __m256i t52 = avx_xor(z7, z8);
+    const __m256i t53 = avx_xor(z0, z3);
+    const __m256i t54 = avx_xor(z6, z7);
+    const __m256i t55 = avx_xor(z16, z17);
+    const __m256i t56 = avx_xor(z12, t48);
+    const __m256i t57 = avx_xor(t50, t53);
+    const __m256i t58 = avx_xor(z4, t46);
+    const __m256i t59 = avx_xor(z3, t54);
+    const __m256i t60 = avx_xor(t46, t57);
+    const __m256i t61 = avx_xor(z14, t57);
+    const __m256i t62 = avx_xor(t52, t58);
+    const __m256i t63 = avx_xor(t49, t58);
+    const __m256i t64 = avx_xor(z4, t59);
+    const __m256i t65 = avx_xor(t61, t62);
+    const __m256i t66 = avx_xor(z1, t63);
+    const __m256i s0 = avx_xor(t59, t63);
+    const __m256i s6 = avx_xor3(t56, t62, ones);
+    const __m256i s7 = avx_xor3(t48, t60, ones);
+    const __m256i t67 = avx_xor(t64, t65);
+    const __m256i s3 = avx_xor(t53, t66);
+    const __m256i s4 = avx_xor(t51, t66);
+    const __m256i s5 = avx_xor(t47, t65);
+    const __m256i s1 = avx_xor3(t64, s3, ones);
+    const __m256i s2 = avx_xor3(t55, t67, ones);
+    state[7] = s0;
+    state[6] = s1;
+    state[5] = s2;
+    state[4] = s3;
+    state[3] = s4;
+    state[2] = s5;
+    state[1] = s6;
+    state[0] = s7;
+}
+
+// B(x) ^ 0x05, where B is the inverse of the linear part of the affine map
+static inline void bitsliced_inverse_affine(__m256i state[8]) {
+    const __m256i ones = avx_set8(-1);
+    __m256i x[8];
+    x[0] = state[0];
+    x[1] = state[1];
+    x[2] = state[2];
+    x[3] = state[3];
+    x[4] = state[4];
+    x[5] = state[5];
+    x[6] = state[6];
+    x[7] = state[7];
+    state[0] = avx_xor(avx_xor3(x[7], x[5], x[2]), ones);
+    state[1] = avx_xor3(x[0], x[6], x[3]);
+    state[2] = avx_xor(avx_xor3(x[1], x[7], x[4]), ones);
+    state[3] = avx_xor3(x[2], x[0], x[5]);
+    state[4] = avx_xor3(x[3], x[1], x[6]);
+    state[5] = avx_xor3(x[4], x[2], x[7]);
+    state[6] = avx_xor3(x[5], x[3], x[0]);
+    state[7] = avx_xor3(x[6], x[4], x[1]);
+}
+
+// ---------------------------------------------------------------------
+
+static inline void bitsliced_inv_sub_bytes(__m256i state[8]) {
+    bitsliced_inverse_affine(state);
+    bitsliced_sub_bytes(state);
+    bitsliced_inverse_affine(state);
+}
+
+// ---------------------------------------------------------------------
+// Rounds
+// ---------------------------------------------------------------------
+
+/**
+ * AESENC on every block: MixColumns(ShiftRows(SubBytes(x))) ^ round_key.
+ */
+static inline void bitsliced_aes_round(__m256i x[8],
+                                       const __m256i round_key[8]) {
+    bitsliced_sub_bytes(x);
+    bitsliced_shuffle(x, BITSLICED_SHIFT_ROWS);
+    bitsliced_mix_columns(x);
+    bitsliced_xor(x, round_key);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Inverts bitsliced_aes_round().
+ */
+static inline void bitsliced_aes_inverse_round(__m256i x[8],
+                                               const __m256i round_key[8]) {
+    bitsliced_xor(x, round_key);
+    bitsliced_inv_mix_columns(x);
+    bitsliced_shuffle(x, BITSLICED_INV_SHIFT_ROWS);
+    bitsliced_inv_sub_bytes(x);
+}
+
+// ---------------------------------------------------------------------
+
+#endif  // _BITSLICED_H_
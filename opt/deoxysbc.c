@@ -38,6 +38,10 @@
 #include "deoxysbc.h"
 #include "utils-opt.h"
 
+#ifdef DEOXYS_BC_BITSLICED
+#include "bitsliced.h"
+#endif
+
 
 // ---------------------------------------------------------------------
 // Constants
@@ -783,6 +787,68 @@ static const unsigned char RCON[17] = {
     deoxys_declast_round_eight(states, states, round_tweaks, round_keys[i]);\
 }
 
+// ---------------------------------------------------------------------
+// Macros on two blocks in parallel
+// ---------------------------------------------------------------------
+
+#define combine_two_tweaks(x, tweak_blocks, counter, permutation) {\
+    x[0] = permute(vxor(tweak_blocks[0], \
+        vand(vshift_bytes_left(counter, 8), BYTE_8_MASK)), permutation); \
+    x[1] = permute(vxor(tweak_blocks[1], \
+        vand(vshift_bytes_left(counter, 6), BYTE_8_MASK)), permutation); \
+}
+
+// ---------------------------------------------------------------------
+
+#define combine_two_tweaks_no_permute(x, tweak_blocks, counter) {\
+    x[0] = vxor(tweak_blocks[0], \
+                vand(vshift_bytes_left(counter, 8), BYTE_8_MASK)); \
+    x[1] = vxor(tweak_blocks[1], \
+                vand(vshift_bytes_left(counter, 6), BYTE_8_MASK)); \
+}
+
+// ---------------------------------------------------------------------
+
+#define sse_update_round_two(\
+    states, round_tweaks, tweak_blocks, counters, round_keys, i, j) {\
+    combine_two_tweaks(round_tweaks, tweak_blocks, counters[j], \
+                       H_PERMUTATION_##i); \
+    states[0] = vaesenc(states[0], vxor(round_keys[j], round_tweaks[0])); \
+    states[1] = vaesenc(states[1], vxor(round_keys[j], round_tweaks[1])); \
+}
+
+// ---------------------------------------------------------------------
+
+#define sse_update_round_two_no_permute(\
+    states, round_tweaks, tweak_blocks, counters, round_keys, j) {\
+    combine_two_tweaks_no_permute(round_tweaks, tweak_blocks, counters[j]); \
+    states[0] = vaesenc(states[0], vxor(round_keys[j], round_tweaks[0])); \
+    states[1] = vaesenc(states[1], vxor(round_keys[j], round_tweaks[1])); \
+}
+
+// ---------------------------------------------------------------------
+
+#define sse_update_invround_two_invmc(\
+    states, round_tweaks, tweak_blocks, counters, round_keys, i, j) {\
+    combine_two_tweaks(round_tweaks, tweak_blocks, counters[j], \
+                       H_PERMUTATION_##i); \
+    states[0] = vaesdec(states[0], \
+                        vxor(round_keys[j], vinversemc(round_tweaks[0]))); \
+    states[1] = vaesdec(states[1], \
+                        vxor(round_keys[j], vinversemc(round_tweaks[1]))); \
+}
+
+// ---------------------------------------------------------------------
+
+#define sse_update_invround_two_invmc_no_permute(\
+    states, round_tweaks, tweak_blocks, counters, round_keys, j) {\
+    combine_two_tweaks_no_permute(round_tweaks, tweak_blocks, counters[j]); \
+    states[0] = vaesdec(states[0], \
+                        vxor(round_keys[j], vinversemc(round_tweaks[0]))); \
+    states[1] = vaesdec(states[1], \
+                        vxor(round_keys[j], vinversemc(round_tweaks[1]))); \
+}
+
 // ---------------------------------------------------------------------
 // For the middle step
 // ---------------------------------------------------------------------
@@ -869,6 +935,89 @@ static const unsigned char RCON[17] = {
     x[7] = vxor(x[7], vand(vshift_bytes_right(counter, 6), BYTE_8_MASK)); \
 }
 
+// ---------------------------------------------------------------------
+
+/**
+ * Computes the round tweaks of eight blocks from their tweak blocks and
+ * the LFSR2-updated counters, without AVX2: since h is a byte permutation,
+ * h^i(tweak_block) xor h^i(counter) = h^i(tweak_block xor counter).
+ */
+#define combine_eight_tweaks(x, tweak_blocks, counter, permutation) {\
+    x[0] = permute(vxor(tweak_blocks[0], \
+        vand(vshift_bytes_left(counter, 8), BYTE_8_MASK)), permutation); \
+    x[1] = permute(vxor(tweak_blocks[1], \
+        vand(vshift_bytes_left(counter, 6), BYTE_8_MASK)), permutation); \
+    x[2] = permute(vxor(tweak_blocks[2], \
+        vand(vshift_bytes_left(counter, 4), BYTE_8_MASK)), permutation); \
+    x[3] = permute(vxor(tweak_blocks[3], \
+        vand(vshift_bytes_left(counter, 2), BYTE_8_MASK)), permutation); \
+    x[4] = permute(vxor(tweak_blocks[4], \
+        vand(vshift_bytes_right(counter, 0), BYTE_8_MASK)), permutation); \
+    x[5] = permute(vxor(tweak_blocks[5], \
+        vand(vshift_bytes_right(counter, 2), BYTE_8_MASK)), permutation); \
+    x[6] = permute(vxor(tweak_blocks[6], \
+        vand(vshift_bytes_right(counter, 4), BYTE_8_MASK)), permutation); \
+    x[7] = permute(vxor(tweak_blocks[7], \
+        vand(vshift_bytes_right(counter, 6), BYTE_8_MASK)), permutation); \
+}
+
+// ---------------------------------------------------------------------
+
+#define combine_eight_tweaks_no_permute(x, tweak_blocks, counter) {\
+    x[0] = vxor(tweak_blocks[0], \
+                 vand(vshift_bytes_left(counter, 8), BYTE_8_MASK)); \
+    x[1] = vxor(tweak_blocks[1], \
+                 vand(vshift_bytes_left(counter, 6), BYTE_8_MASK)); \
+    x[2] = vxor(tweak_blocks[2], \
+                 vand(vshift_bytes_left(counter, 4), BYTE_8_MASK)); \
+    x[3] = vxor(tweak_blocks[3], \
+                 vand(vshift_bytes_left(counter, 2), BYTE_8_MASK)); \
+    x[4] = vxor(tweak_blocks[4], \
+                 vand(vshift_bytes_right(counter, 0), BYTE_8_MASK)); \
+    x[5] = vxor(tweak_blocks[5], \
+                 vand(vshift_bytes_right(counter, 2), BYTE_8_MASK)); \
+    x[6] = vxor(tweak_blocks[6], \
+                 vand(vshift_bytes_right(counter, 4), BYTE_8_MASK)); \
+    x[7] = vxor(tweak_blocks[7], \
+                 vand(vshift_bytes_right(counter, 6), BYTE_8_MASK)); \
+}
+
+// ---------------------------------------------------------------------
+
+#define sse_update_round_eight(\
+    states, round_tweaks, tweak_blocks, counters, round_keys, i, j) {\
+    combine_eight_tweaks(round_tweaks, tweak_blocks, counters[j], \
+                         H_PERMUTATION_##i); \
+    deoxys_enc_round_eight(states, round_tweaks, round_keys[j]); \
+}
+
+// ---------------------------------------------------------------------
+
+#define sse_update_round_eight_no_permute(\
+    states, round_tweaks, tweak_blocks, counters, round_keys, j) {\
+    combine_eight_tweaks_no_permute(round_tweaks, tweak_blocks, counters[j]); \
+    deoxys_enc_round_eight(states, round_tweaks, round_keys[j]); \
+}
+
+// ---------------------------------------------------------------------
+
+#define sse_update_invround_eight_invmc(\
+    states, round_tweaks, tweak_blocks, counters, round_keys, i, j) {\
+    combine_eight_tweaks(round_tweaks, tweak_blocks, counters[j], \
+                         H_PERMUTATION_##i); \
+    aes_invert_mix_columns_eight(round_tweaks, vzero); \
+    deoxys_dec_round_eight(states, round_tweaks, round_keys[j]); \
+}
+
+// ---------------------------------------------------------------------
+
+#define sse_update_invround_eight_invmc_no_permute(\
+    states, round_tweaks, tweak_blocks, counters, round_keys, j) {\
+    combine_eight_tweaks_no_permute(round_tweaks, tweak_blocks, counters[j]); \
+    aes_invert_mix_columns_eight(round_tweaks, vzero); \
+    deoxys_dec_round_eight(states, round_tweaks, round_keys[j]); \
+}
+
 // ---------------------------------------------------------------------
 // For setup of four tweaks
 // ---------------------------------------------------------------------
@@ -952,6 +1101,24 @@ static void add_round_constants(deoxys_bc_block_t* round_keys,
 
 // ---------------------------------------------------------------------
 
+/**
+ * Applies InvMixColumns to the inner round keys for the equivalent inverse
+ * cipher with AESDEC.
+ */
+static void setup_decryption_keys(const deoxys_bc_block_t* round_keys,
+                                  deoxys_bc_block_t* decryption_keys,
+                                  const size_t num_rounds) {
+    decryption_keys[0] = round_keys[0];
+
+    for (size_t i = 1; i < num_rounds; ++i) {
+        decryption_keys[i] = vinversemc(round_keys[i]);
+    }
+
+    decryption_keys[num_rounds] = round_keys[num_rounds];
+}
+
+// ---------------------------------------------------------------------
+
 void deoxys_bc_128_384_setup_key(deoxys_bc_128_384_ctx_t* ctx,
                                  const deoxys_bc_key_t key) {
     deoxys_bc_block_t* round_keys = ctx->round_keys;
@@ -968,14 +1135,9 @@ void deoxys_bc_128_384_setup_key(deoxys_bc_128_384_ctx_t* ctx,
 // ---------------------------------------------------------------------
 
 void deoxys_bc_128_384_setup_decryption_key(deoxys_bc_128_384_ctx_t* ctx) {
-    ctx->decryption_keys[0] = ctx->round_keys[0];
-
-    for (size_t i = 1; i < DEOXYS_BC_128_384_NUM_ROUNDS; ++i) {
-        ctx->decryption_keys[i] = vinversemc(ctx->round_keys[i]);
-    }
-
-    ctx->decryption_keys[DEOXYS_BC_128_384_NUM_ROUNDS]
-        = ctx->round_keys[DEOXYS_BC_128_384_NUM_ROUNDS];
+    setup_decryption_keys(ctx->round_keys,
+                          ctx->decryption_keys,
+                          DEOXYS_BC_128_384_NUM_ROUNDS);
 }
 
 // ---------------------------------------------------------------------
@@ -1001,7 +1163,8 @@ static void deoxys_bc_128_384_setup_tweak(
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_setup_base_counters(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_setup_base_counters(const deoxys_bc_128_384_ctx_t* ctx,
+                                           deoxys_bc_128_384_base_t* base,
                                            const uint8_t tweak_domain,
                                            const size_t tweak_counter) {
     // ---------------------------------------------------------------------
@@ -1010,67 +1173,59 @@ void deoxys_bc_128_384_setup_base_counters(deoxys_bc_128_384_ctx_t* ctx,
 
     const uint64_t domain = (uint64_t)tweak_domain;
     const uint64_t base_counter = tweak_counter & 0xFFFFFFFFFFFFFF00L;
+    __m128i base_counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
 
-    ctx->base_counters[0] = set64(base_counter, domain);
+    base_counters[0] = set64(base_counter, domain);
 
     __m128i tmp;
-    lfsr_two_six_sequence_base(ctx->base_counters, tmp);
-    lfsr_two_six_sequence_base((ctx->base_counters + 6), tmp);
-    lfsr_two_four_sequence_base((ctx->base_counters + 12), tmp);
+    lfsr_two_six_sequence_base(base_counters, tmp);
+    lfsr_two_six_sequence_base((base_counters + 6), tmp);
+    lfsr_two_four_sequence_base((base_counters + 12), tmp);
 
-    permute_base(ctx->base_counters);
-    permute_base((ctx->base_counters + 8));
+    permute_base(base_counters);
+    permute_base((base_counters + 8));
 
     for (size_t i = 0; i < DEOXYS_BC_128_384_NUM_ROUND_KEYS; ++i) {
-        ctx->combined_round_keys[i] = vxor(ctx->round_keys[i],
-                                           ctx->base_counters[i]);
+        base->combined_round_keys[i] = vxor(ctx->round_keys[i],
+                                            base_counters[i]);
     }
 
-    ctx->combined_decryption_keys[0]
+    base->combined_decryption_keys[0]
         =  vxor(ctx->decryption_keys[0],
-                ctx->base_counters[0]);
-    ctx->combined_decryption_keys[DEOXYS_BC_128_384_NUM_ROUNDS]
+                base_counters[0]);
+    base->combined_decryption_keys[DEOXYS_BC_128_384_NUM_ROUNDS]
         = vxor(ctx->decryption_keys[DEOXYS_BC_128_384_NUM_ROUNDS],
-               ctx->base_counters[DEOXYS_BC_128_384_NUM_ROUNDS]);
+               base_counters[DEOXYS_BC_128_384_NUM_ROUNDS]);
 
     for (size_t i = 1; i < DEOXYS_BC_128_384_NUM_ROUNDS; ++i) {
-        tmp = vinversemc(ctx->base_counters[i]);
-        ctx->combined_decryption_keys[i] = vxor(ctx->decryption_keys[i], tmp);
+        tmp = vinversemc(base_counters[i]);
+        base->combined_decryption_keys[i] = vxor(ctx->decryption_keys[i], tmp);
     }
 }
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_setup_middle_base(deoxys_bc_128_384_ctx_t* ctx,
-                                         const uint8_t tweak_domain,
-                                         const size_t tweak_counter,
-                                         const __m128i tweak_block) {
+void deoxys_bc_128_384_setup_middle_base(
+    deoxys_bc_128_384_base_t* base,
+    const deoxys_bc_128_384_base_t* counter_base,
+    const __m128i tweak_block) {
     // ---------------------------------------------------------------------
-    // LFSR2 on 16 rounds on the base counter and domain
+    // The permutation is linear, so h^i(base_i xor T) = h^i(base_i) xor h^i(T)
+    // and we only have to add the permuted tweak block to the counter base.
     // ---------------------------------------------------------------------
 
-    const uint64_t domain = (uint64_t)tweak_domain;
-    const uint64_t base_counter = tweak_counter & 0xFFFFFFFFFFFFFF00L;
-
-    ctx->base_counters[0] = set64(base_counter, domain);
-
-    __m128i tmp;
-    lfsr_two_six_sequence_base(ctx->base_counters, tmp);
-    lfsr_two_six_sequence_base((ctx->base_counters + 6), tmp);
-    lfsr_two_four_sequence_base((ctx->base_counters + 12), tmp);
+    __m128i tweaks[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
 
-    // XOR T
     for (size_t i = 0; i < DEOXYS_BC_128_384_NUM_ROUND_KEYS; ++i) {
-        ctx->base_counters[i] = vxor(ctx->base_counters[i], tweak_block);
+        tweaks[i] = tweak_block;
     }
 
-    // Permute base counters and tweak
-    permute_base(ctx->base_counters);
-    permute_base((ctx->base_counters + 8));
+    permute_base(tweaks);
+    permute_base((tweaks + 8));
 
     for (size_t i = 0; i < DEOXYS_BC_128_384_NUM_ROUND_KEYS; ++i) {
-        ctx->combined_round_keys[i] = vxor(ctx->round_keys[i],
-                                           ctx->base_counters[i]);
+        base->combined_round_keys[i] =
+            vxor(counter_base->combined_round_keys[i], tweaks[i]);
     }
 }
 
@@ -1110,30 +1265,104 @@ static __m128i deoxys_bc_128_encrypt(const __m128i* round_keys,
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_encrypt(const deoxys_bc_128_384_ctx_t* ctx,
                                const uint8_t tweak_domain,
                                const size_t tweak_counter,
                                const deoxys_bc_block_t tweak_block,
                                const deoxys_bc_block_t plaintext,
                                deoxys_bc_block_t* ciphertext) {
-    deoxys_bc_128_384_setup_tweak(ctx->round_tweaks,
+    __m128i round_tweaks[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
+    deoxys_bc_128_384_setup_tweak(round_tweaks,
                                   tweak_domain,
                                   tweak_counter,
                                   tweak_block);
 
     *ciphertext = deoxys_bc_128_encrypt(ctx->round_keys,
-                                        ctx->round_tweaks,
+                                        round_tweaks,
                                         DEOXYS_BC_128_384_NUM_ROUNDS,
                                         plaintext);
 }
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt_four(deoxys_bc_128_384_ctx_t* ctx,
+/**
+ * Computes the round tweaks of all lanes on the fly, round by round, so that
+ * the independent AES rounds of the lanes overlap in the pipeline. Inlined
+ * with a constant num_blocks, so that the lanes can stay in registers.
+ */
+static inline __attribute__((always_inline)) void encrypt_batch(
+    const deoxys_bc_128_384_ctx_t* ctx,
+    const size_t num_blocks,
+    const uint8_t tweak_domains[],
+    const size_t tweak_counters[],
+    const __m128i tweak_blocks[],
+    __m128i states[]) {
+    __m128i first_tweaks[DEOXYS_BC_MAX_BATCH_SIZE];
+    __m128i second_tweaks[DEOXYS_BC_MAX_BATCH_SIZE];
+    __m128i tmp;
+
+    for (size_t j = 0; j < num_blocks; ++j) {
+        first_tweaks[j] = tweak_blocks[j];
+        second_tweaks[j] = set64(tweak_counters[j],
+                                 (uint64_t)tweak_domains[j]);
+        states[j] = vxor3(states[j],
+                          vxor(first_tweaks[j], second_tweaks[j]),
+                          ctx->round_keys[0]);
+    }
+
+    for (size_t i = 1; i <= DEOXYS_BC_128_384_NUM_ROUNDS; ++i) {
+        for (size_t j = 0; j < num_blocks; ++j) {
+            lfsr_two(second_tweaks[j], tmp);
+            second_tweaks[j] = permute_tweak(tmp);
+            first_tweaks[j] = permute_tweak(first_tweaks[j]);
+            states[j] = vaesenc(states[j], vxor3(ctx->round_keys[i],
+                                                 first_tweaks[j],
+                                                 second_tweaks[j]));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_encrypt_batch(const deoxys_bc_128_384_ctx_t* ctx,
+                                     const size_t num_blocks,
+                                     const uint8_t tweak_domains[],
+                                     const size_t tweak_counters[],
+                                     const __m128i tweak_blocks[],
+                                     __m128i states[]) {
+    switch (num_blocks) {
+        case 1:
+            encrypt_batch(ctx, 1, tweak_domains, tweak_counters,
+                          tweak_blocks, states);
+            break;
+        case 2:
+            encrypt_batch(ctx, 2, tweak_domains, tweak_counters,
+                          tweak_blocks, states);
+            break;
+        case 3:
+            encrypt_batch(ctx, 3, tweak_domains, tweak_counters,
+                          tweak_blocks, states);
+            break;
+        case 4:
+            encrypt_batch(ctx, 4, tweak_domains, tweak_counters,
+                          tweak_blocks, states);
+            break;
+        default:
+            encrypt_batch(ctx, num_blocks, tweak_domains, tweak_counters,
+                          tweak_blocks, states);
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------
+#ifdef __AVX2__
+
+void deoxys_bc_128_384_encrypt_four(const deoxys_bc_128_384_base_t* base,
                                     const size_t tweak_counter,
                                     const __m256i tweak_blocks[2],
                                     deoxys_bc_block_t states[4]) {
     __m256i tmp, z;
+    __m128i round_tweaks[4];
     __m256i avx_round_tweaks[2];
     __m256i avx_counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
     const uint8_t ctr = tweak_counter & 0xFF;
@@ -1143,71 +1372,72 @@ void deoxys_bc_128_384_encrypt_four(deoxys_bc_128_384_ctx_t* ctx,
     lfsr_two_avx_eight_sequence_counters((avx_counters + 8), z, tmp);
 
     combine_avx_two(avx_round_tweaks, tweak_blocks, avx_counters[0]);
-    unpack_two(avx_round_tweaks, ctx->round_tweaks);
+    unpack_two(avx_round_tweaks, round_tweaks);
 
-    vxor_four(ctx->round_tweaks, states, states);
-    vxor_four_same(states, ctx->combined_round_keys[0]);
+    vxor_four(round_tweaks, states, states);
+    vxor_four_same(states, base->combined_round_keys[0]);
 
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       1, 1);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       2, 2);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       3, 3);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       4, 4);
 
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       5, 5);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       6, 6);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       7, 7);
     update_round_four_no_permute(avx_round_tweaks, tweak_blocks, avx_counters,
-                                 ctx->round_tweaks, states,
-                                 ctx->combined_round_keys, 8);
+                                 round_tweaks, states,
+                                 base->combined_round_keys, 8);
 
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       1, 9);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       2, 10);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       3, 11);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       4, 12);
 
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       5, 13);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       6, 14);
     update_round_four(avx_round_tweaks, tweak_blocks, avx_counters,
-                      ctx->round_tweaks, states, ctx->combined_round_keys,
+                      round_tweaks, states, base->combined_round_keys,
                       7, 15);
     update_round_four_no_permute(avx_round_tweaks, tweak_blocks, avx_counters,
-                                 ctx->round_tweaks, states,
-                                 ctx->combined_round_keys, 16);
+                                 round_tweaks, states,
+                                 base->combined_round_keys, 16);
 }
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt_eight(deoxys_bc_128_384_ctx_t* ctx,
-                                    const size_t tweak_counter,
-                                    const __m256i tweak_blocks[4],
-                                    deoxys_bc_block_t states[8]) {
+void deoxys_bc_128_384_encrypt_eight(const deoxys_bc_128_384_base_t* base,
+                                     const size_t tweak_counter,
+                                     const __m256i tweak_blocks[4],
+                                     deoxys_bc_block_t states[8]) {
     __m256i tmp, z;
+    __m128i round_tweaks[8];
     __m256i avx_round_tweaks[4];
     __m256i avx_counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
     const uint8_t ctr = tweak_counter & 0xFF;
@@ -1217,69 +1447,67 @@ void deoxys_bc_128_384_encrypt_eight(deoxys_bc_128_384_ctx_t* ctx,
     lfsr_two_avx_eight_sequence_counters((avx_counters + 8), z, tmp);
 
     combine_avx_four(avx_round_tweaks, tweak_blocks, avx_counters[0]);
-    unpack_four(avx_round_tweaks,
-                      ctx->round_tweaks);
-
-    vxor_eight(ctx->round_tweaks, states, states);
-    vxor_eight_same(states, ctx->combined_round_keys[0]);
+    unpack_four(avx_round_tweaks, round_tweaks);
 
+    vxor_eight(round_tweaks, states, states);
+    vxor_eight_same(states, base->combined_round_keys[0]);
 
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        1, 1);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        2, 2);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        3, 3);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        4, 4);
 
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        5, 5);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        6, 6);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        7, 7);
     update_round_eight_no_permute(avx_round_tweaks, tweak_blocks, avx_counters,
-                                  ctx->round_tweaks, states,
-                                  ctx->combined_round_keys, 8);
+                                  round_tweaks, states,
+                                  base->combined_round_keys, 8);
 
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        1, 9);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        2, 10);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        3, 11);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        4, 12);
 
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        5, 13);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        6, 14);
     update_round_eight(avx_round_tweaks, tweak_blocks, avx_counters,
-                       ctx->round_tweaks, states, ctx->combined_round_keys,
+                       round_tweaks, states, base->combined_round_keys,
                        7, 15);
     update_round_eight_no_permute(avx_round_tweaks, tweak_blocks, avx_counters,
-                                  ctx->round_tweaks, states,
-                                  ctx->combined_round_keys, 16);
+                                  round_tweaks, states,
+                                  base->combined_round_keys, 16);
 }
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt_eight_eight(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_encrypt_eight_eight(const deoxys_bc_128_384_base_t* base,
                                            const size_t tweak_counter,
                                            const __m128i tweak_blocks[8],
                                            __m128i states[8]) {
@@ -1289,22 +1517,175 @@ void deoxys_bc_128_384_encrypt_eight_eight(deoxys_bc_128_384_ctx_t* ctx,
     avx_tweak_blocks[2] = vset128(tweak_blocks[4], tweak_blocks[5]);
     avx_tweak_blocks[3] = vset128(tweak_blocks[6], tweak_blocks[7]);
 
-    deoxys_bc_128_384_encrypt_eight(ctx,
+    deoxys_bc_128_384_encrypt_eight(base,
                                     tweak_counter,
                                     avx_tweak_blocks,
                                     states);
 }
 
+#else  // !__AVX2__
+
+void deoxys_bc_128_384_encrypt_eight_eight(const deoxys_bc_128_384_base_t* base,
+                                           const size_t tweak_counter,
+                                           const __m128i tweak_blocks[8],
+                                           __m128i states[8]) {
+    __m128i z;
+    __m128i tmp;
+    __m128i round_tweaks[8];
+    __m128i counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
+    const uint8_t ctr = tweak_counter & 0xFF;
+
+    init_middle_counters(counters, ctr);
+    lfsr_two_eight_sequence_counters(counters, z, tmp);
+    lfsr_two_eight_sequence_counters((counters + 8), z, tmp);
+
+    combine_eight_tweaks_no_permute(round_tweaks, tweak_blocks, counters[0]);
+    vxor_eight(round_tweaks, states, states);
+    vxor_eight_same(states, base->combined_round_keys[0]);
+
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 1, 1);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 2, 2);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 3, 3);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 4, 4);
+
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 5, 5);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 6, 6);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 7, 7);
+    sse_update_round_eight_no_permute(states, round_tweaks, tweak_blocks,
+                                      counters, base->combined_round_keys,
+                                      8);
+
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 1, 9);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 2, 10);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 3, 11);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 4, 12);
+
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 5, 13);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 6, 14);
+    sse_update_round_eight(states, round_tweaks, tweak_blocks, counters,
+                           base->combined_round_keys, 7, 15);
+    sse_update_round_eight_no_permute(states, round_tweaks, tweak_blocks,
+                                      counters, base->combined_round_keys,
+                                      16);
+}
+
+#endif  // __AVX2__
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_encrypt_four_four(const deoxys_bc_128_384_base_t* base,
+                                         const size_t tweak_counter,
+                                         const __m128i tweak_blocks[4],
+                                         __m128i states[4]) {
+#ifdef __AVX2__
+    __m256i avx_tweak_blocks[2];
+    avx_tweak_blocks[0] = vset128(tweak_blocks[0], tweak_blocks[1]);
+    avx_tweak_blocks[1] = vset128(tweak_blocks[2], tweak_blocks[3]);
+
+    deoxys_bc_128_384_encrypt_four(base, tweak_counter, avx_tweak_blocks,
+                                   states);
+#else
+    // Without AVX2, four blocks are not cheaper than eight
+    __m128i eight_tweak_blocks[8];
+    __m128i eight_states[8];
+
+    for (size_t i = 0; i < 8; ++i) {
+        eight_tweak_blocks[i] = (i < 4) ? tweak_blocks[i] : vzero;
+        eight_states[i] = (i < 4) ? states[i] : vzero;
+    }
+
+    deoxys_bc_128_384_encrypt_eight_eight(base,
+                                          tweak_counter,
+                                          eight_tweak_blocks,
+                                          eight_states);
+    memcpy(states, eight_states, 4 * sizeof(__m128i));
+#endif
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_encrypt_two(const deoxys_bc_128_384_base_t* base,
+                                   const size_t tweak_counter,
+                                   const __m128i tweak_blocks[2],
+                                   __m128i states[2]) {
+    __m128i z;
+    __m128i tmp;
+    __m128i round_tweaks[2];
+    __m128i counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
+    const uint8_t ctr = tweak_counter & 0xFF;
+
+    init_middle_counters(counters, ctr);
+    lfsr_two_eight_sequence_counters(counters, z, tmp);
+    lfsr_two_eight_sequence_counters((counters + 8), z, tmp);
+
+    combine_two_tweaks_no_permute(round_tweaks, tweak_blocks, counters[0]);
+    states[0] = vxor3(states[0], round_tweaks[0],
+                      base->combined_round_keys[0]);
+    states[1] = vxor3(states[1], round_tweaks[1],
+                      base->combined_round_keys[0]);
+
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 1, 1);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 2, 2);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 3, 3);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 4, 4);
+
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 5, 5);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 6, 6);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 7, 7);
+    sse_update_round_two_no_permute(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_round_keys,
+                                    8);
+
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 1, 9);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 2, 10);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 3, 11);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 4, 12);
+
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 5, 13);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 6, 14);
+    sse_update_round_two(states, round_tweaks, tweak_blocks, counters,
+                         base->combined_round_keys, 7, 15);
+    sse_update_round_two_no_permute(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_round_keys,
+                                    16);
+}
+
 // ---------------------------------------------------------------------
 
 #define aesenc_round_and_combine_counters(states, i, permutation) { \
-    vaesenc_round_eight(states, ctx->combined_round_keys[i]); \
+    vaesenc_round_eight(states, base->combined_round_keys[i]); \
     combine_eight(states, counters[i], permutation); \
 }
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt_eight_one(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_encrypt_eight_one(const deoxys_bc_128_384_base_t* base,
                                          const size_t tweak_counter,
                                          __m128i states[8]) {
     __m128i z;
@@ -1316,7 +1697,7 @@ void deoxys_bc_128_384_encrypt_eight_one(deoxys_bc_128_384_ctx_t* ctx,
     lfsr_two_eight_sequence_counters(counters, z, tmp);
     lfsr_two_eight_sequence_counters((counters + 8), z, tmp);
 
-    vxor_eight_same(states, ctx->combined_round_keys[0]);
+    vxor_eight_same(states, base->combined_round_keys[0]);
     combine_eight_no_permute(states, counters[0]);
 
     aesenc_round_and_combine_counters(states, 1, H_PERMUTATION_1);
@@ -1327,7 +1708,7 @@ void deoxys_bc_128_384_encrypt_eight_one(deoxys_bc_128_384_ctx_t* ctx,
     aesenc_round_and_combine_counters(states, 6, H_PERMUTATION_6);
     aesenc_round_and_combine_counters(states, 7, H_PERMUTATION_7);
 
-    vaesenc_round_eight(states, ctx->combined_round_keys[8]);
+    vaesenc_round_eight(states, base->combined_round_keys[8]);
     combine_eight_no_permute(states, counters[8]);
 
     aesenc_round_and_combine_counters(states, 9, H_PERMUTATION_1);
@@ -1338,8 +1719,8 @@ void deoxys_bc_128_384_encrypt_eight_one(deoxys_bc_128_384_ctx_t* ctx,
     aesenc_round_and_combine_counters(states, 14, H_PERMUTATION_6);
     aesenc_round_and_combine_counters(states, 15, H_PERMUTATION_7);
 
-    vaesenc_round_eight(states,
-                        ctx->combined_round_keys[DEOXYS_BC_128_384_NUM_ROUNDS]);
+    vaesenc_round_eight(
+        states, base->combined_round_keys[DEOXYS_BC_128_384_NUM_ROUNDS]);
     combine_eight_no_permute(states, counters[DEOXYS_BC_128_384_NUM_ROUNDS]);
 }
 
@@ -1367,30 +1748,70 @@ static __m128i deoxys_bc_128_decrypt(const __m128i* round_keys,
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_decrypt(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_decrypt(const deoxys_bc_128_384_ctx_t* ctx,
                                const uint8_t tweak_domain,
                                const size_t tweak_counter,
                                const deoxys_bc_block_t tweak_block,
                                const deoxys_bc_block_t ciphertext,
                                deoxys_bc_block_t* plaintext) {
-    deoxys_bc_128_384_setup_decryption_tweak(ctx->round_tweaks,
+    __m128i round_tweaks[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
+    deoxys_bc_128_384_setup_decryption_tweak(round_tweaks,
                                              tweak_domain,
                                              tweak_counter,
                                              tweak_block);
 
     *plaintext = deoxys_bc_128_decrypt(ctx->decryption_keys,
-                                       ctx->round_tweaks,
+                                       round_tweaks,
                                        DEOXYS_BC_128_384_NUM_ROUNDS,
                                        ciphertext);
 }
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_decrypt_four(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_decrypt_batch(const deoxys_bc_128_384_ctx_t* ctx,
+                                     const size_t num_blocks,
+                                     const uint8_t tweak_domains[],
+                                     const size_t tweak_counters[],
+                                     const __m128i tweak_blocks[],
+                                     __m128i states[]) {
+    const __m128i* keys = ctx->decryption_keys;
+    __m128i round_tweaks[DEOXYS_BC_MAX_BATCH_SIZE]
+                        [DEOXYS_BC_128_384_NUM_ROUND_KEYS];
+
+    for (size_t j = 0; j < num_blocks; ++j) {
+        deoxys_bc_128_384_setup_decryption_tweak(round_tweaks[j],
+                                                 tweak_domains[j],
+                                                 tweak_counters[j],
+                                                 tweak_blocks[j]);
+        states[j] = vinversemc(vxor3(
+            states[j],
+            round_tweaks[j][DEOXYS_BC_128_384_NUM_ROUNDS],
+            keys[DEOXYS_BC_128_384_NUM_ROUNDS]));
+    }
+
+    // Round by round over all lanes, as in deoxys_bc_128_384_encrypt_batch()
+    for (size_t i = DEOXYS_BC_128_384_NUM_ROUNDS - 1; i > 0; --i) {
+        for (size_t j = 0; j < num_blocks; ++j) {
+            states[j] = vaesdec(states[j],
+                                vxor(keys[i], round_tweaks[j][i]));
+        }
+    }
+
+    for (size_t j = 0; j < num_blocks; ++j) {
+        states[j] = vaesdeclast(states[j],
+                                vxor(keys[0], round_tweaks[j][0]));
+    }
+}
+
+// ---------------------------------------------------------------------
+#ifdef __AVX2__
+
+void deoxys_bc_128_384_decrypt_four(const deoxys_bc_128_384_base_t* base,
                                     const size_t tweak_counter,
                                     __m256i tweak_blocks[2],
                                     deoxys_bc_block_t states[4]) {
     __m256i tmp, z;
+    __m128i round_tweaks[4];
     __m256i avx_round_tweaks[2];
     __m256i avx_counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
     const uint8_t ctr = tweak_counter & 0xFF;
@@ -1402,70 +1823,70 @@ void deoxys_bc_128_384_decrypt_four(deoxys_bc_128_384_ctx_t* ctx,
     combine_avx_two(avx_round_tweaks,
                     tweak_blocks,
                     avx_counters[DEOXYS_BC_128_384_NUM_ROUNDS]);
-    unpack_two(avx_round_tweaks, ctx->round_tweaks);
+    unpack_two(avx_round_tweaks, round_tweaks);
 
-    vxor_four(ctx->round_tweaks, states, states);
-    vxor_four_same(states,
-                   ctx->combined_decryption_keys[DEOXYS_BC_128_384_NUM_ROUNDS]);
+    vxor_four(round_tweaks, states, states);
+    vxor_four_same(
+        states, base->combined_decryption_keys[DEOXYS_BC_128_384_NUM_ROUNDS]);
     vinversemc_four(states);
 
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 7, 15);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 7, 15);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 6, 14);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 6, 14);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 5, 13);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 5, 13);
 
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 4, 12);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 4, 12);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 3, 11);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 3, 11);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 2, 10);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 2, 10);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 1, 9);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 1, 9);
 
     update_invround_four_invmc_no_permute(avx_round_tweaks, tweak_blocks,
-                            avx_counters, ctx->round_tweaks, states,
-                            ctx->combined_decryption_keys, 8);
+                            avx_counters, round_tweaks, states,
+                            base->combined_decryption_keys, 8);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 7, 7);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 7, 7);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 6, 6);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 6, 6);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 5, 5);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 5, 5);
 
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 4, 4);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 4, 4);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 3, 3);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 3, 3);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 2, 2);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 2, 2);
     update_invround_four_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                               ctx->round_tweaks, states,
-                               ctx->combined_decryption_keys, 1, 1);
+                               round_tweaks, states,
+                               base->combined_decryption_keys, 1, 1);
 
     update_invlastround_four_no_permute(avx_round_tweaks, tweak_blocks,
-                                        avx_counters, ctx->round_tweaks, states,
-                                        ctx->combined_decryption_keys, 0);
+                                        avx_counters, round_tweaks, states,
+                                        base->combined_decryption_keys, 0);
 }
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_decrypt_eight_eight(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_decrypt_eight_eight(const deoxys_bc_128_384_base_t* base,
                                            const size_t tweak_counter,
                                            const __m128i tweak_blocks[8],
                                            __m128i states[8]) {
@@ -1475,7 +1896,7 @@ void deoxys_bc_128_384_decrypt_eight_eight(deoxys_bc_128_384_ctx_t* ctx,
     avx_tweak_blocks[2] = vset128(tweak_blocks[4], tweak_blocks[5]);
     avx_tweak_blocks[3] = vset128(tweak_blocks[6], tweak_blocks[7]);
 
-    deoxys_bc_128_384_decrypt_eight(ctx,
+    deoxys_bc_128_384_decrypt_eight(base,
                                     tweak_counter,
                                     avx_tweak_blocks,
                                     states);
@@ -1483,11 +1904,12 @@ void deoxys_bc_128_384_decrypt_eight_eight(deoxys_bc_128_384_ctx_t* ctx,
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_decrypt_eight(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_decrypt_eight(const deoxys_bc_128_384_base_t* base,
                                      const size_t tweak_counter,
                                      __m256i tweak_blocks[4],
                                      deoxys_bc_block_t states[8]) {
     __m256i tmp, z;
+    __m128i round_tweaks[8];
     __m256i avx_round_tweaks[4];
     __m256i avx_counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
     const uint8_t ctr = tweak_counter & 0xFF;
@@ -1499,65 +1921,1005 @@ void deoxys_bc_128_384_decrypt_eight(deoxys_bc_128_384_ctx_t* ctx,
     combine_avx_four(avx_round_tweaks,
                      tweak_blocks,
                      avx_counters[DEOXYS_BC_128_384_NUM_ROUNDS]);
-    unpack_four(avx_round_tweaks, ctx->round_tweaks);
+    unpack_four(avx_round_tweaks, round_tweaks);
 
-    vxor_eight(ctx->round_tweaks, states, states);
+    vxor_eight(round_tweaks, states, states);
     vxor_eight_same(states,
-        ctx->combined_decryption_keys[DEOXYS_BC_128_384_NUM_ROUNDS]);
+        base->combined_decryption_keys[DEOXYS_BC_128_384_NUM_ROUNDS]);
     aes_invert_mix_columns_eight(states, vzero);
 
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 7, 15);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 7, 15);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 6, 14);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 6, 14);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 5, 13);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 5, 13);
 
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 4, 12);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 4, 12);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 3, 11);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 3, 11);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 2, 10);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 2, 10);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 1, 9);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 1, 9);
 
     update_invround_eight_invmc_no_permute(avx_round_tweaks, tweak_blocks,
-                                           avx_counters, ctx->round_tweaks,
+                                           avx_counters, round_tweaks,
                                            states,
-                                           ctx->combined_decryption_keys, 8);
+                                           base->combined_decryption_keys, 8);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 7, 7);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 7, 7);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 6, 6);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 6, 6);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 5, 5);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 5, 5);
 
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 4, 4);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 4, 4);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 3, 3);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 3, 3);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 2, 2);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 2, 2);
     update_invround_eight_invmc(avx_round_tweaks, tweak_blocks, avx_counters,
-                                ctx->round_tweaks, states,
-                                ctx->combined_decryption_keys, 1, 1);
+                                round_tweaks, states,
+                                base->combined_decryption_keys, 1, 1);
 
     update_invlastround_eight_no_permute(avx_round_tweaks, tweak_blocks,
-                                         avx_counters, ctx->round_tweaks,
-                                         states, ctx->combined_decryption_keys,
+                                         avx_counters, round_tweaks,
+                                         states, base->combined_decryption_keys,
                                          0);
 }
+
+#else  // !__AVX2__
+
+void deoxys_bc_128_384_decrypt_eight_eight(const deoxys_bc_128_384_base_t* base,
+                                           const size_t tweak_counter,
+                                           const __m128i tweak_blocks[8],
+                                           __m128i states[8]) {
+    __m128i z;
+    __m128i tmp;
+    __m128i round_tweaks[8];
+    __m128i counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
+    const uint8_t ctr = tweak_counter & 0xFF;
+
+    init_middle_counters(counters, ctr);
+    lfsr_two_eight_sequence_counters(counters, z, tmp);
+    lfsr_two_eight_sequence_counters((counters + 8), z, tmp);
+
+    combine_eight_tweaks_no_permute(round_tweaks, tweak_blocks,
+                                    counters[DEOXYS_BC_128_384_NUM_ROUNDS]);
+    vxor_eight(round_tweaks, states, states);
+    vxor_eight_same(states,
+        base->combined_decryption_keys[DEOXYS_BC_128_384_NUM_ROUNDS]);
+    aes_invert_mix_columns_eight(states, vzero);
+
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    7, 15);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    6, 14);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    5, 13);
+
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    4, 12);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    3, 11);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    2, 10);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    1, 9);
+
+    sse_update_invround_eight_invmc_no_permute(states, round_tweaks,
+                                               tweak_blocks, counters,
+                                               base->combined_decryption_keys,
+                                               8);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    7, 7);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    6, 6);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    5, 5);
+
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    4, 4);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    3, 3);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    2, 2);
+    sse_update_invround_eight_invmc(states, round_tweaks, tweak_blocks,
+                                    counters, base->combined_decryption_keys,
+                                    1, 1);
+
+    combine_eight_tweaks_no_permute(round_tweaks, tweak_blocks, counters[0]);
+    deoxys_declast_round_eight(states, states, round_tweaks,
+                               base->combined_decryption_keys[0]);
+}
+
+#endif  // __AVX2__
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_decrypt_four_four(const deoxys_bc_128_384_base_t* base,
+                                         const size_t tweak_counter,
+                                         const __m128i tweak_blocks[4],
+                                         __m128i states[4]) {
+#ifdef __AVX2__
+    __m256i avx_tweak_blocks[2];
+    avx_tweak_blocks[0] = vset128(tweak_blocks[0], tweak_blocks[1]);
+    avx_tweak_blocks[1] = vset128(tweak_blocks[2], tweak_blocks[3]);
+
+    deoxys_bc_128_384_decrypt_four(base, tweak_counter, avx_tweak_blocks,
+                                   states);
+#else
+    // Without AVX2, four blocks are not cheaper than eight
+    __m128i eight_tweak_blocks[8];
+    __m128i eight_states[8];
+
+    for (size_t i = 0; i < 8; ++i) {
+        eight_tweak_blocks[i] = (i < 4) ? tweak_blocks[i] : vzero;
+        eight_states[i] = (i < 4) ? states[i] : vzero;
+    }
+
+    deoxys_bc_128_384_decrypt_eight_eight(base,
+                                          tweak_counter,
+                                          eight_tweak_blocks,
+                                          eight_states);
+    memcpy(states, eight_states, 4 * sizeof(__m128i));
+#endif
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_decrypt_two(const deoxys_bc_128_384_base_t* base,
+                                   const size_t tweak_counter,
+                                   const __m128i tweak_blocks[2],
+                                   __m128i states[2]) {
+    const __m128i* keys = base->combined_decryption_keys;
+    __m128i z;
+    __m128i tmp;
+    __m128i round_tweaks[2];
+    __m128i counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
+    const uint8_t ctr = tweak_counter & 0xFF;
+
+    init_middle_counters(counters, ctr);
+    lfsr_two_eight_sequence_counters(counters, z, tmp);
+    lfsr_two_eight_sequence_counters((counters + 8), z, tmp);
+
+    combine_two_tweaks_no_permute(round_tweaks, tweak_blocks,
+                                  counters[DEOXYS_BC_128_384_NUM_ROUNDS]);
+    states[0] = vinversemc(vxor3(states[0], round_tweaks[0],
+                                 keys[DEOXYS_BC_128_384_NUM_ROUNDS]));
+    states[1] = vinversemc(vxor3(states[1], round_tweaks[1],
+                                 keys[DEOXYS_BC_128_384_NUM_ROUNDS]));
+
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 7, 15);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 6, 14);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 5, 13);
+
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 4, 12);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 3, 11);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 2, 10);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 1, 9);
+
+    sse_update_invround_two_invmc_no_permute(states, round_tweaks,
+                                             tweak_blocks, counters, keys,
+                                             8);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 7, 7);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 6, 6);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 5, 5);
+
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 4, 4);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 3, 3);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 2, 2);
+    sse_update_invround_two_invmc(states, round_tweaks, tweak_blocks,
+                                  counters, keys, 1, 1);
+
+    combine_two_tweaks_no_permute(round_tweaks, tweak_blocks, counters[0]);
+    states[0] = vaesdeclast(states[0], vxor(keys[0], round_tweaks[0]));
+    states[1] = vaesdeclast(states[1], vxor(keys[0], round_tweaks[1]));
+}
+
+// ---------------------------------------------------------------------
+// Deoxys-BC-128-128 and Deoxys-BC-128-256
+// ---------------------------------------------------------------------
+
+// H has order 8, so H^14 = H^6 is the tweak permutation of the last round of
+// Deoxys-BC-128-256, and H^7 steps the tweaks back by one round.
+#define H_PERMUTATION_128_256_LAST   H_PERMUTATION_6
+#define H_PERMUTATION_INVERSE        H_PERMUTATION_7
+
+// ---------------------------------------------------------------------
+
+/**
+ * Encrypts num_blocks lanes round by round, as encrypt_batch(). Without
+ * tweaks (Deoxys-BC-128-128), tweaks must be NULL. Inlined with constant
+ * num_blocks and num_rounds, so that the lanes can stay in registers.
+ */
+static inline __attribute__((always_inline)) void encrypt_small_lanes(
+    const __m128i* round_keys,
+    const size_t num_rounds,
+    const size_t num_blocks,
+    const __m128i tweaks[],
+    __m128i states[]) {
+    __m128i round_tweaks[DEOXYS_BC_MAX_BATCH_SIZE];
+
+    for (size_t j = 0; j < num_blocks; ++j) {
+        states[j] = vxor(states[j], round_keys[0]);
+
+        if (tweaks != NULL) {
+            round_tweaks[j] = tweaks[j];
+            states[j] = vxor(states[j], round_tweaks[j]);
+        }
+    }
+
+    for (size_t i = 1; i <= num_rounds; ++i) {
+        for (size_t j = 0; j < num_blocks; ++j) {
+            if (tweaks == NULL) {
+                states[j] = vaesenc(states[j], round_keys[i]);
+            } else {
+                round_tweaks[j] = permute_tweak(round_tweaks[j]);
+                states[j] = vaesenc(states[j], vxor(round_keys[i],
+                                                    round_tweaks[j]));
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Inverse of encrypt_small_lanes() on decryption keys. The round tweaks are
+ * stepped back from H^14(T) and passed through InvMixColumns like the keys.
+ */
+static inline __attribute__((always_inline)) void decrypt_small_lanes(
+    const __m128i* decryption_keys,
+    const size_t num_rounds,
+    const size_t num_blocks,
+    const __m128i tweaks[],
+    __m128i states[]) {
+    __m128i round_tweaks[DEOXYS_BC_MAX_BATCH_SIZE];
+
+    for (size_t j = 0; j < num_blocks; ++j) {
+        states[j] = vxor(states[j], decryption_keys[num_rounds]);
+
+        if (tweaks != NULL) {
+            round_tweaks[j] = permute(tweaks[j], H_PERMUTATION_128_256_LAST);
+            states[j] = vxor(states[j], round_tweaks[j]);
+        }
+
+        states[j] = vinversemc(states[j]);
+    }
+
+    for (size_t i = num_rounds - 1; i > 0; --i) {
+        for (size_t j = 0; j < num_blocks; ++j) {
+            if (tweaks == NULL) {
+                states[j] = vaesdec(states[j], decryption_keys[i]);
+            } else {
+                round_tweaks[j] = permute(round_tweaks[j],
+                                          H_PERMUTATION_INVERSE);
+                states[j] = vaesdec(states[j],
+                                    vxor(decryption_keys[i],
+                                         vinversemc(round_tweaks[j])));
+            }
+        }
+    }
+
+    for (size_t j = 0; j < num_blocks; ++j) {
+        if (tweaks == NULL) {
+            states[j] = vaesdeclast(states[j], decryption_keys[0]);
+        } else {
+            states[j] = vaesdeclast(states[j],
+                                    vxor(decryption_keys[0], tweaks[j]));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_setup_key(deoxys_bc_128_128_ctx_t* ctx,
+                                 const deoxys_bc_key_t key) {
+    deoxys_bc_block_t* round_keys = ctx->round_keys;
+    store(round_keys, (__m128i)key);
+
+    for (size_t i = 0; i < DEOXYS_BC_128_128_NUM_ROUNDS; ++i) {
+        round_keys[i+1] = permute_tweak(round_keys[i]);
+    }
+
+    add_round_constants(round_keys, DEOXYS_BC_128_128_NUM_ROUNDS);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_setup_decryption_key(deoxys_bc_128_128_ctx_t* ctx) {
+    setup_decryption_keys(ctx->round_keys,
+                          ctx->decryption_keys,
+                          DEOXYS_BC_128_128_NUM_ROUNDS);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_encrypt(const deoxys_bc_128_128_ctx_t* ctx,
+                               const deoxys_bc_block_t plaintext,
+                               deoxys_bc_block_t* ciphertext) {
+    *ciphertext = plaintext;
+    encrypt_small_lanes(ctx->round_keys, DEOXYS_BC_128_128_NUM_ROUNDS,
+                        1, NULL, ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_encrypt_four(const deoxys_bc_128_128_ctx_t* ctx,
+                                    deoxys_bc_block_t states[4]) {
+    encrypt_small_lanes(ctx->round_keys, DEOXYS_BC_128_128_NUM_ROUNDS,
+                        4, NULL, states);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_encrypt_eight(const deoxys_bc_128_128_ctx_t* ctx,
+                                     deoxys_bc_block_t states[8]) {
+    encrypt_small_lanes(ctx->round_keys, DEOXYS_BC_128_128_NUM_ROUNDS,
+                        8, NULL, states);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_decrypt(const deoxys_bc_128_128_ctx_t* ctx,
+                               const deoxys_bc_block_t ciphertext,
+                               deoxys_bc_block_t* plaintext) {
+    *plaintext = ciphertext;
+    decrypt_small_lanes(ctx->decryption_keys, DEOXYS_BC_128_128_NUM_ROUNDS,
+                        1, NULL, plaintext);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_decrypt_four(const deoxys_bc_128_128_ctx_t* ctx,
+                                    deoxys_bc_block_t states[4]) {
+    decrypt_small_lanes(ctx->decryption_keys, DEOXYS_BC_128_128_NUM_ROUNDS,
+                        4, NULL, states);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_decrypt_eight(const deoxys_bc_128_128_ctx_t* ctx,
+                                     deoxys_bc_block_t states[8]) {
+    decrypt_small_lanes(ctx->decryption_keys, DEOXYS_BC_128_128_NUM_ROUNDS,
+                        8, NULL, states);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_setup_key(deoxys_bc_128_256_ctx_t* ctx,
+                                 const deoxys_bc_key_t key) {
+    deoxys_bc_block_t* round_keys = ctx->round_keys;
+    store(round_keys, (__m128i)key);
+
+    for (size_t i = 0; i < DEOXYS_BC_128_256_NUM_ROUNDS; ++i) {
+        lfsr_two(round_keys[i], round_keys[i+1]);
+        round_keys[i+1] = permute_tweak(round_keys[i + 1]);
+    }
+
+    add_round_constants(round_keys, DEOXYS_BC_128_256_NUM_ROUNDS);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_setup_decryption_key(deoxys_bc_128_256_ctx_t* ctx) {
+    setup_decryption_keys(ctx->round_keys,
+                          ctx->decryption_keys,
+                          DEOXYS_BC_128_256_NUM_ROUNDS);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_encrypt(const deoxys_bc_128_256_ctx_t* ctx,
+                               const deoxys_bc_128_256_tweak_t tweak,
+                               const deoxys_bc_block_t plaintext,
+                               deoxys_bc_block_t* ciphertext) {
+    *ciphertext = plaintext;
+    encrypt_small_lanes(ctx->round_keys, DEOXYS_BC_128_256_NUM_ROUNDS,
+                        1, &tweak, ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_encrypt_four(const deoxys_bc_128_256_ctx_t* ctx,
+                                    const deoxys_bc_128_256_tweak_t tweaks[4],
+                                    deoxys_bc_block_t states[4]) {
+    encrypt_small_lanes(ctx->round_keys, DEOXYS_BC_128_256_NUM_ROUNDS,
+                        4, tweaks, states);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_encrypt_eight(const deoxys_bc_128_256_ctx_t* ctx,
+                                     const deoxys_bc_128_256_tweak_t tweaks[8],
+                                     deoxys_bc_block_t states[8]) {
+    encrypt_small_lanes(ctx->round_keys, DEOXYS_BC_128_256_NUM_ROUNDS,
+                        8, tweaks, states);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_decrypt(const deoxys_bc_128_256_ctx_t* ctx,
+                               const deoxys_bc_128_256_tweak_t tweak,
+                               const deoxys_bc_block_t ciphertext,
+                               deoxys_bc_block_t* plaintext) {
+    *plaintext = ciphertext;
+    decrypt_small_lanes(ctx->decryption_keys, DEOXYS_BC_128_256_NUM_ROUNDS,
+                        1, &tweak, plaintext);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_decrypt_four(const deoxys_bc_128_256_ctx_t* ctx,
+                                    const deoxys_bc_128_256_tweak_t tweaks[4],
+                                    deoxys_bc_block_t states[4]) {
+    decrypt_small_lanes(ctx->decryption_keys, DEOXYS_BC_128_256_NUM_ROUNDS,
+                        4, tweaks, states);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_decrypt_eight(const deoxys_bc_128_256_ctx_t* ctx,
+                                     const deoxys_bc_128_256_tweak_t tweaks[8],
+                                     deoxys_bc_block_t states[8]) {
+    decrypt_small_lanes(ctx->decryption_keys, DEOXYS_BC_128_256_NUM_ROUNDS,
+                        8, tweaks, states);
+}
+
+// ---------------------------------------------------------------------
+// Sixteen blocks in parallel with VAES and AVX-512
+// ---------------------------------------------------------------------
+
+#if defined(DEOXYS_BC_SIXTEEN_ENABLED) && !defined(DEOXYS_BC_BITSLICED)
+
+#define AVX512_BYTE_8_MASK  avx512_broadcast128(BYTE_8_MASK)
+
+#define permute_avx512(x, i) \
+    _mm512_shuffle_epi8(x, avx512_broadcast128(H_PERMUTATION_##i))
+
+// ---------------------------------------------------------------------
+
+/**
+ * Stores ctr + 4 * i + j in byte 8 of the 128-bit lane j of x[i], so that
+ * x[0] .. x[3] hold the counters of blocks 0 .. 15 at the position where
+ * they are XORed to the tweak block.
+ */
+#define init_sixteen_counters(x, ctr) {\
+    x[0] = avx512_and(avx512_set8(ctr), AVX512_BYTE_8_MASK); \
+    x[1] = avx512_add8(x[0], avx512_set64(7, 0, 6, 0, 5, 0, 4, 0)); \
+    x[2] = avx512_add8(x[0], avx512_set64(11, 0, 10, 0, 9, 0, 8, 0)); \
+    x[3] = avx512_add8(x[0], avx512_set64(15, 0, 14, 0, 13, 0, 12, 0)); \
+    x[0] = avx512_add8(x[0], avx512_set64(3, 0, 2, 0, 1, 0, 0, 0)); \
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * The shift trick of lfsr_two_avx_compute_tmp() on counters in byte 8:
+ * w holds x in byte 9 and z in byte 8, so that
+ * LFSR2^r(x) = (w >> (8-r)) & BYTE_8_MASK for r = 1 .. 8.
+ */
+#define lfsr_two_avx512_compute_w(x, w) {\
+    w = avx512_and(avx512_xor(x, avx512_shift_left(x, 2)), \
+                   AVX512_BYTE_8_MASK); \
+    w = avx512_xor(w, avx512_shift_right(w, 6)); \
+    w = avx512_or(avx512_shift_left(x, 8), w); \
+}
+
+// ---------------------------------------------------------------------
+
+#define lfsr_two_avx512_compute_w_four(x, w) {\
+    lfsr_two_avx512_compute_w(x[0], w[0]); \
+    lfsr_two_avx512_compute_w(x[1], w[1]); \
+    lfsr_two_avx512_compute_w(x[2], w[2]); \
+    lfsr_two_avx512_compute_w(x[3], w[3]); \
+}
+
+// ---------------------------------------------------------------------
+
+#define lfsr_two_avx512_counters(w, r) \
+    avx512_and(avx512_shift_right(w, (8 - r)), AVX512_BYTE_8_MASK)
+
+// ---------------------------------------------------------------------
+
+#define avx512_invert_mix_columns(x) \
+    avx512_aesdec(avx512_aesenclast(x, avx512_zero), avx512_zero)
+
+// ---------------------------------------------------------------------
+
+#define sixteen_round_tweak(tweak_block, w, i) \
+    permute_avx512(avx512_xor(tweak_block, lfsr_two_avx512_counters(w, i)), i)
+
+#define sixteen_round_tweak_no_permute(tweak_block, w, r) \
+    avx512_xor(tweak_block, lfsr_two_avx512_counters(w, r))
+
+// ---------------------------------------------------------------------
+
+#define update_round_sixteen(states, tweak_blocks, w, round_keys, i, j) {\
+    const __m512i key = avx512_broadcast128(round_keys[j]); \
+    states[0] = avx512_aesenc(states[0], avx512_xor(key, \
+        sixteen_round_tweak(tweak_blocks[0], w[0], i))); \
+    states[1] = avx512_aesenc(states[1], avx512_xor(key, \
+        sixteen_round_tweak(tweak_blocks[1], w[1], i))); \
+    states[2] = avx512_aesenc(states[2], avx512_xor(key, \
+        sixteen_round_tweak(tweak_blocks[2], w[2], i))); \
+    states[3] = avx512_aesenc(states[3], avx512_xor(key, \
+        sixteen_round_tweak(tweak_blocks[3], w[3], i))); \
+}
+
+// ---------------------------------------------------------------------
+
+#define update_round_sixteen_no_permute(\
+    states, tweak_blocks, w, round_keys, j) {\
+    const __m512i key = avx512_broadcast128(round_keys[j]); \
+    states[0] = avx512_aesenc(states[0], avx512_xor(key, \
+        sixteen_round_tweak_no_permute(tweak_blocks[0], w[0], 8))); \
+    states[1] = avx512_aesenc(states[1], avx512_xor(key, \
+        sixteen_round_tweak_no_permute(tweak_blocks[1], w[1], 8))); \
+    states[2] = avx512_aesenc(states[2], avx512_xor(key, \
+        sixteen_round_tweak_no_permute(tweak_blocks[2], w[2], 8))); \
+    states[3] = avx512_aesenc(states[3], avx512_xor(key, \
+        sixteen_round_tweak_no_permute(tweak_blocks[3], w[3], 8))); \
+}
+
+// ---------------------------------------------------------------------
+
+#define update_invround_sixteen(states, tweak_blocks, w, round_keys, i, j) {\
+    const __m512i key = avx512_broadcast128(round_keys[j]); \
+    states[0] = avx512_aesdec(states[0], avx512_xor(key, \
+        avx512_invert_mix_columns( \
+            sixteen_round_tweak(tweak_blocks[0], w[0], i)))); \
+    states[1] = avx512_aesdec(states[1], avx512_xor(key, \
+        avx512_invert_mix_columns( \
+            sixteen_round_tweak(tweak_blocks[1], w[1], i)))); \
+    states[2] = avx512_aesdec(states[2], avx512_xor(key, \
+        avx512_invert_mix_columns( \
+            sixteen_round_tweak(tweak_blocks[2], w[2], i)))); \
+    states[3] = avx512_aesdec(states[3], avx512_xor(key, \
+        avx512_invert_mix_columns( \
+            sixteen_round_tweak(tweak_blocks[3], w[3], i)))); \
+}
+
+// ---------------------------------------------------------------------
+
+#define update_invround_sixteen_no_permute(\
+    states, tweak_blocks, w, round_keys, j) {\
+    const __m512i key = avx512_broadcast128(round_keys[j]); \
+    states[0] = avx512_aesdec(states[0], avx512_xor(key, \
+        avx512_invert_mix_columns( \
+            sixteen_round_tweak_no_permute(tweak_blocks[0], w[0], 8)))); \
+    states[1] = avx512_aesdec(states[1], avx512_xor(key, \
+        avx512_invert_mix_columns( \
+            sixteen_round_tweak_no_permute(tweak_blocks[1], w[1], 8)))); \
+    states[2] = avx512_aesdec(states[2], avx512_xor(key, \
+        avx512_invert_mix_columns( \
+            sixteen_round_tweak_no_permute(tweak_blocks[2], w[2], 8)))); \
+    states[3] = avx512_aesdec(states[3], avx512_xor(key, \
+        avx512_invert_mix_columns( \
+            sixteen_round_tweak_no_permute(tweak_blocks[3], w[3], 8)))); \
+}
+
+// ---------------------------------------------------------------------
+
+#define update_round_sixteen_one(states, w, round_keys, i, j) {\
+    const __m512i key = avx512_broadcast128(round_keys[j]); \
+    states[0] = avx512_aesenc(states[0], avx512_xor(key, \
+        permute_avx512(lfsr_two_avx512_counters(w[0], i), i))); \
+    states[1] = avx512_aesenc(states[1], avx512_xor(key, \
+        permute_avx512(lfsr_two_avx512_counters(w[1], i), i))); \
+    states[2] = avx512_aesenc(states[2], avx512_xor(key, \
+        permute_avx512(lfsr_two_avx512_counters(w[2], i), i))); \
+    states[3] = avx512_aesenc(states[3], avx512_xor(key, \
+        permute_avx512(lfsr_two_avx512_counters(w[3], i), i))); \
+}
+
+// ---------------------------------------------------------------------
+
+#define update_round_sixteen_one_no_permute(states, w, round_keys, j) {\
+    const __m512i key = avx512_broadcast128(round_keys[j]); \
+    states[0] = avx512_aesenc(states[0], \
+        avx512_xor(key, lfsr_two_avx512_counters(w[0], 8))); \
+    states[1] = avx512_aesenc(states[1], \
+        avx512_xor(key, lfsr_two_avx512_counters(w[1], 8))); \
+    states[2] = avx512_aesenc(states[2], \
+        avx512_xor(key, lfsr_two_avx512_counters(w[2], 8))); \
+    states[3] = avx512_aesenc(states[3], \
+        avx512_xor(key, lfsr_two_avx512_counters(w[3], 8))); \
+}
+
+// ---------------------------------------------------------------------
+
+#define next_sixteen_counters(counters, w) {\
+    counters[0] = lfsr_two_avx512_counters(w[0], 8); \
+    counters[1] = lfsr_two_avx512_counters(w[1], 8); \
+    counters[2] = lfsr_two_avx512_counters(w[2], 8); \
+    counters[3] = lfsr_two_avx512_counters(w[3], 8); \
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_encrypt_sixteen(const deoxys_bc_128_384_base_t* base,
+                                       const size_t tweak_counter,
+                                       const __m128i tweak_blocks[16],
+                                       __m128i states[16]) {
+    const __m128i* round_keys = base->combined_round_keys;
+    const uint8_t ctr = tweak_counter & 0xFF;
+    __m512i x[4];
+    __m512i t[4];
+    __m512i counters[4];
+    __m512i w[4];
+
+    avx512_load_four(x, states);
+    avx512_load_four(t, tweak_blocks);
+    init_sixteen_counters(counters, ctr);
+
+    const __m512i first_key = avx512_broadcast128(round_keys[0]);
+    x[0] = avx512_xor3(x[0], first_key, avx512_xor(t[0], counters[0]));
+    x[1] = avx512_xor3(x[1], first_key, avx512_xor(t[1], counters[1]));
+    x[2] = avx512_xor3(x[2], first_key, avx512_xor(t[2], counters[2]));
+    x[3] = avx512_xor3(x[3], first_key, avx512_xor(t[3], counters[3]));
+
+    lfsr_two_avx512_compute_w_four(counters, w);
+
+    update_round_sixteen(x, t, w, round_keys, 1, 1);
+    update_round_sixteen(x, t, w, round_keys, 2, 2);
+    update_round_sixteen(x, t, w, round_keys, 3, 3);
+    update_round_sixteen(x, t, w, round_keys, 4, 4);
+    update_round_sixteen(x, t, w, round_keys, 5, 5);
+    update_round_sixteen(x, t, w, round_keys, 6, 6);
+    update_round_sixteen(x, t, w, round_keys, 7, 7);
+    update_round_sixteen_no_permute(x, t, w, round_keys, 8);
+
+    next_sixteen_counters(counters, w);
+    lfsr_two_avx512_compute_w_four(counters, w);
+
+    update_round_sixteen(x, t, w, round_keys, 1, 9);
+    update_round_sixteen(x, t, w, round_keys, 2, 10);
+    update_round_sixteen(x, t, w, round_keys, 3, 11);
+    update_round_sixteen(x, t, w, round_keys, 4, 12);
+    update_round_sixteen(x, t, w, round_keys, 5, 13);
+    update_round_sixteen(x, t, w, round_keys, 6, 14);
+    update_round_sixteen(x, t, w, round_keys, 7, 15);
+    update_round_sixteen_no_permute(x, t, w, round_keys, 16);
+
+    avx512_store_four(states, x);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_encrypt_sixteen_one(
+    const deoxys_bc_128_384_base_t* base,
+    const size_t tweak_counter,
+    __m128i states[16]) {
+    const __m128i* round_keys = base->combined_round_keys;
+    const uint8_t ctr = tweak_counter & 0xFF;
+    __m512i x[4];
+    __m512i counters[4];
+    __m512i w[4];
+
+    avx512_load_four(x, states);
+    init_sixteen_counters(counters, ctr);
+
+    const __m512i first_key = avx512_broadcast128(round_keys[0]);
+    x[0] = avx512_xor3(x[0], first_key, counters[0]);
+    x[1] = avx512_xor3(x[1], first_key, counters[1]);
+    x[2] = avx512_xor3(x[2], first_key, counters[2]);
+    x[3] = avx512_xor3(x[3], first_key, counters[3]);
+
+    lfsr_two_avx512_compute_w_four(counters, w);
+
+    update_round_sixteen_one(x, w, round_keys, 1, 1);
+    update_round_sixteen_one(x, w, round_keys, 2, 2);
+    update_round_sixteen_one(x, w, round_keys, 3, 3);
+    update_round_sixteen_one(x, w, round_keys, 4, 4);
+    update_round_sixteen_one(x, w, round_keys, 5, 5);
+    update_round_sixteen_one(x, w, round_keys, 6, 6);
+    update_round_sixteen_one(x, w, round_keys, 7, 7);
+    update_round_sixteen_one_no_permute(x, w, round_keys, 8);
+
+    next_sixteen_counters(counters, w);
+    lfsr_two_avx512_compute_w_four(counters, w);
+
+    update_round_sixteen_one(x, w, round_keys, 1, 9);
+    update_round_sixteen_one(x, w, round_keys, 2, 10);
+    update_round_sixteen_one(x, w, round_keys, 3, 11);
+    update_round_sixteen_one(x, w, round_keys, 4, 12);
+    update_round_sixteen_one(x, w, round_keys, 5, 13);
+    update_round_sixteen_one(x, w, round_keys, 6, 14);
+    update_round_sixteen_one(x, w, round_keys, 7, 15);
+    update_round_sixteen_one_no_permute(x, w, round_keys, 16);
+
+    avx512_store_four(states, x);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_decrypt_sixteen(const deoxys_bc_128_384_base_t* base,
+                                       const size_t tweak_counter,
+                                       const __m128i tweak_blocks[16],
+                                       __m128i states[16]) {
+    const __m128i* round_keys = base->combined_decryption_keys;
+    const uint8_t ctr = tweak_counter & 0xFF;
+    __m512i x[4];
+    __m512i t[4];
+    __m512i counters[4];
+    __m512i middle_counters[4];
+    __m512i first_w[4];
+    __m512i w[4];
+
+    avx512_load_four(x, states);
+    avx512_load_four(t, tweak_blocks);
+    init_sixteen_counters(counters, ctr);
+
+    lfsr_two_avx512_compute_w_four(counters, first_w);
+    next_sixteen_counters(middle_counters, first_w);
+    lfsr_two_avx512_compute_w_four(middle_counters, w);
+
+    const __m512i last_key =
+        avx512_broadcast128(round_keys[DEOXYS_BC_128_384_NUM_ROUNDS]);
+    x[0] = avx512_xor3(x[0], last_key,
+                       sixteen_round_tweak_no_permute(t[0], w[0], 8));
+    x[1] = avx512_xor3(x[1], last_key,
+                       sixteen_round_tweak_no_permute(t[1], w[1], 8));
+    x[2] = avx512_xor3(x[2], last_key,
+                       sixteen_round_tweak_no_permute(t[2], w[2], 8));
+    x[3] = avx512_xor3(x[3], last_key,
+                       sixteen_round_tweak_no_permute(t[3], w[3], 8));
+
+    x[0] = avx512_invert_mix_columns(x[0]);
+    x[1] = avx512_invert_mix_columns(x[1]);
+    x[2] = avx512_invert_mix_columns(x[2]);
+    x[3] = avx512_invert_mix_columns(x[3]);
+
+    update_invround_sixteen(x, t, w, round_keys, 7, 15);
+    update_invround_sixteen(x, t, w, round_keys, 6, 14);
+    update_invround_sixteen(x, t, w, round_keys, 5, 13);
+    update_invround_sixteen(x, t, w, round_keys, 4, 12);
+    update_invround_sixteen(x, t, w, round_keys, 3, 11);
+    update_invround_sixteen(x, t, w, round_keys, 2, 10);
+    update_invround_sixteen(x, t, w, round_keys, 1, 9);
+    update_invround_sixteen_no_permute(x, t, first_w, round_keys, 8);
+    update_invround_sixteen(x, t, first_w, round_keys, 7, 7);
+    update_invround_sixteen(x, t, first_w, round_keys, 6, 6);
+    update_invround_sixteen(x, t, first_w, round_keys, 5, 5);
+    update_invround_sixteen(x, t, first_w, round_keys, 4, 4);
+    update_invround_sixteen(x, t, first_w, round_keys, 3, 3);
+    update_invround_sixteen(x, t, first_w, round_keys, 2, 2);
+    update_invround_sixteen(x, t, first_w, round_keys, 1, 1);
+
+    const __m512i first_key = avx512_broadcast128(round_keys[0]);
+    x[0] = avx512_aesdeclast(x[0], avx512_xor3(first_key, t[0], counters[0]));
+    x[1] = avx512_aesdeclast(x[1], avx512_xor3(first_key, t[1], counters[1]));
+    x[2] = avx512_aesdeclast(x[2], avx512_xor3(first_key, t[2], counters[2]));
+    x[3] = avx512_aesdeclast(x[3], avx512_xor3(first_key, t[3], counters[3]));
+
+    avx512_store_four(states, x);
+}
+
+#endif  // DEOXYS_BC_SIXTEEN_ENABLED && !DEOXYS_BC_BITSLICED
+
+// ---------------------------------------------------------------------
+// Sixteen blocks in parallel, bitsliced with AVX2
+// ---------------------------------------------------------------------
+
+#ifdef DEOXYS_BC_BITSLICED
+
+/**
+ * Bit planes of the counters tweak_counter .. tweak_counter + 15 in byte 8,
+ * where they are XORed to the tweak block. As in the other multi-block
+ * kernels, the lane offsets are added only to the lowest counter byte.
+ */
+static inline void bitsliced_init_counters(__m256i counters[8],
+                                           const size_t tweak_counter) {
+    const uint8_t ctr = tweak_counter & 0xFF;
+    __m128i blocks[BITSLICED_NUM_BLOCKS];
+
+    for (size_t i = 0; i < BITSLICED_NUM_BLOCKS; ++i) {
+        blocks[i] = set64((uint64_t)(uint8_t)(ctr + i), (uint64_t)0);
+    }
+
+    bitsliced_load(counters, blocks);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Bit planes of round_key ^ h^i(T ^ LFSR2^i(counter)) for all blocks, where
+ * counters already hold LFSR2^i(counter) and permutation is h^i. The middle
+ * layer has its tweak block in the round keys and passes NULL for
+ * tweak_blocks.
+ */
+static inline __attribute__((always_inline)) void bitsliced_round_tweakey(
+    __m256i round_tweakey[8],
+    const __m128i round_key,
+    const __m256i* tweak_blocks,
+    const __m256i counters[8],
+    const __m256i permutation) {
+    __m256i tweak[8];
+
+    for (size_t i = 0; i < 8; ++i) {
+        tweak[i] = (tweak_blocks == NULL) ?
+            counters[i] : avx_xor(tweak_blocks[i], counters[i]);
+    }
+
+    bitsliced_shuffle(tweak, permutation);
+    bitsliced_broadcast(round_tweakey, round_key);
+    bitsliced_xor(round_tweakey, tweak);
+}
+
+// ---------------------------------------------------------------------
+
+#define bitsliced_encrypt_round(x, t, c, k, round_keys, i, j) {\
+    bitsliced_lfsr_two(c); \
+    bitsliced_round_tweakey(k, round_keys[j], t, c, VH_PERMUTATION_##i); \
+    bitsliced_aes_round(x, k); \
+}
+
+// ---------------------------------------------------------------------
+
+#define bitsliced_decrypt_round(x, t, c, k, round_keys, i, j) {\
+    bitsliced_round_tweakey(k, round_keys[j], t, c, VH_PERMUTATION_##i); \
+    bitsliced_aes_inverse_round(x, k); \
+    bitsliced_lfsr_two_inverse(c); \
+}
+
+// ---------------------------------------------------------------------
+
+static inline __attribute__((always_inline)) void encrypt_bitsliced(
+    const __m128i* round_keys,
+    const size_t tweak_counter,
+    const __m128i* tweak_blocks,
+    __m128i states[BITSLICED_NUM_BLOCKS]) {
+    __m256i x[8];
+    __m256i t[8];
+    __m256i c[8];
+    __m256i k[8];
+    const __m256i* tweaks = NULL;
+
+    bitsliced_load(x, states);
+    bitsliced_init_counters(c, tweak_counter);
+
+    if (tweak_blocks != NULL) {
+        bitsliced_load(t, tweak_blocks);
+        tweaks = t;
+    }
+
+    // h^8 is the identity
+    bitsliced_round_tweakey(k, round_keys[0], tweaks, c, VH_PERMUTATION_8);
+    bitsliced_xor(x, k);
+
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 1, 1);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 2, 2);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 3, 3);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 4, 4);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 5, 5);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 6, 6);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 7, 7);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 8, 8);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 1, 9);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 2, 10);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 3, 11);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 4, 12);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 5, 13);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 6, 14);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 7, 15);
+    bitsliced_encrypt_round(x, tweaks, c, k, round_keys, 8, 16);
+
+    bitsliced_store(states, x);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_encrypt_sixteen_bitsliced(
+    const deoxys_bc_128_384_base_t* base,
+    const size_t tweak_counter,
+    const __m128i tweak_blocks[16],
+    __m128i states[16]) {
+    encrypt_bitsliced(base->combined_round_keys,
+                      tweak_counter,
+                      tweak_blocks,
+                      states);
+}
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_encrypt_sixteen_one_bitsliced(
+    const deoxys_bc_128_384_base_t* base,
+    const size_t tweak_counter,
+    __m128i states[16]) {
+    encrypt_bitsliced(base->combined_round_keys, tweak_counter, NULL, states);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Runs the rounds of encryption backwards with the encryption round keys.
+ * Unlike AESDEC, the bitsliced inverse round applies InvMixColumns to the
+ * state, so the round tweakeys need no InvMixColumns.
+ */
+void deoxys_bc_128_384_decrypt_sixteen_bitsliced(
+    const deoxys_bc_128_384_base_t* base,
+    const size_t tweak_counter,
+    const __m128i tweak_blocks[16],
+    __m128i states[16]) {
+    const __m128i* round_keys = base->combined_round_keys;
+    __m256i x[8];
+    __m256i t[8];
+    __m256i c[8];
+    __m256i k[8];
+
+    bitsliced_load(x, states);
+    bitsliced_load(t, tweak_blocks);
+    bitsliced_init_counters(c, tweak_counter);
+
+    for (size_t i = 0; i < DEOXYS_BC_128_384_NUM_ROUNDS; ++i) {
+        bitsliced_lfsr_two(c);
+    }
+
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 8, 16);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 7, 15);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 6, 14);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 5, 13);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 4, 12);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 3, 11);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 2, 10);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 1, 9);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 8, 8);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 7, 7);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 6, 6);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 5, 5);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 4, 4);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 3, 3);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 2, 2);
+    bitsliced_decrypt_round(x, t, c, k, round_keys, 1, 1);
+
+    bitsliced_round_tweakey(k, round_keys[0], t, c, VH_PERMUTATION_8);
+    bitsliced_xor(x, k);
+
+    bitsliced_store(states, x);
+}
+
+#endif  // DEOXYS_BC_BITSLICED
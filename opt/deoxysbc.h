@@ -35,6 +35,7 @@
 #include <stdint.h>
 
 #include "align.h"
+#include "isa.h"
 
 
 // ---------------------------------------------------------------------
@@ -52,6 +53,28 @@
 #define DEOXYS_BC_128_256_NUM_ROUND_KEYS  (DEOXYS_BC_128_256_NUM_ROUNDS+1)
 #define DEOXYS_BC_128_384_NUM_ROUND_KEYS  (DEOXYS_BC_128_384_NUM_ROUNDS+1)
 
+#define DEOXYS_BC_MAX_BATCH_SIZE          8
+
+// The multi-block kernels add the lane offsets only to the lowest counter
+// byte. All counters of one call must lie in the same window of 256 counters
+// that the base was set up for.
+#define DEOXYS_BC_NUM_COUNTERS_PER_BASE   256
+
+#if defined(__VAES__) && defined(__AVX512F__) && defined(__AVX512BW__)
+#define DEOXYS_BC_SIXTEEN_ENABLED
+#elif defined(__AVX2__) && !defined(__AES__)
+// Builds with AVX2 but without AES-NI run the sixteen-block kernels in
+// bitsliced form.
+#define DEOXYS_BC_SIXTEEN_ENABLED
+#define DEOXYS_BC_BITSLICED
+#define deoxys_bc_128_384_encrypt_sixteen \
+    deoxys_bc_128_384_encrypt_sixteen_bitsliced
+#define deoxys_bc_128_384_encrypt_sixteen_one \
+    deoxys_bc_128_384_encrypt_sixteen_one_bitsliced
+#define deoxys_bc_128_384_decrypt_sixteen \
+    deoxys_bc_128_384_decrypt_sixteen_bitsliced
+#endif
+
 // ---------------------------------------------------------------------
 // Types
 // ---------------------------------------------------------------------
@@ -78,23 +101,42 @@ typedef deoxys_bc_block_t
 ALIGN(16)
 typedef struct {
     deoxys_bc_128_128_expanded_key_t round_keys;
+    deoxys_bc_128_128_expanded_key_t decryption_keys;
 } deoxys_bc_128_128_ctx_t;
 
+/**
+ * Key schedule only; the tweak is passed to every call, so that one context
+ * serves all tweaks.
+ */
 ALIGN(16)
 typedef struct {
-    deoxys_bc_128_256_expanded_key_t round_tweaks;
     deoxys_bc_128_256_expanded_key_t round_keys;
+    deoxys_bc_128_256_expanded_key_t decryption_keys;
 } deoxys_bc_128_256_ctx_t;
 
+/**
+ * Immutable key schedule. After setup, the context is only read, so a single
+ * context can be shared by any number of threads without locking. Round
+ * tweaks are computed on the stack of each call; counter bases are owned by
+ * the caller.
+ */
 ALIGN(16)
 typedef struct {
-    __m128i base_counters[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
-    __m128i round_tweaks[DEOXYS_BC_128_384_NUM_ROUND_KEYS];
     deoxys_bc_128_384_expanded_key_t round_keys;
     deoxys_bc_128_384_expanded_key_t decryption_keys;
+} deoxys_bc_128_384_ctx_t;
+
+/**
+ * Round keys combined with the LFSR2-updated and permuted domain and upper
+ * counter bits (counter & ~0xFF) of a tweak. Depends only on the key, the
+ * domain, and the upper counter bits, so it can be computed once and reused
+ * by all multi-block calls for that domain.
+ */
+ALIGN(16)
+typedef struct {
     deoxys_bc_128_384_expanded_key_t combined_round_keys;
     deoxys_bc_128_384_expanded_key_t combined_decryption_keys;
-} deoxys_bc_128_384_ctx_t;
+} deoxys_bc_128_384_base_t;
 
 // ---------------------------------------------------------------------
 // Public API
@@ -109,15 +151,39 @@ void deoxys_bc_128_384_setup_decryption_key(deoxys_bc_128_384_ctx_t* ctx);
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_setup_base_counters(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_setup_base_counters(const deoxys_bc_128_384_ctx_t* ctx,
+                                           deoxys_bc_128_384_base_t* base,
                                            const uint8_t tweak_domain,
                                            const size_t tweak_counter);
 
+// ---------------------------------------------------------------------
+
+/**
+ * Derives the base for deoxys_bc_128_384_encrypt_eight_one() by XORing the
+ * permuted tweak block to the encryption keys of a counter base.
+ */
+void deoxys_bc_128_384_setup_middle_base(
+    deoxys_bc_128_384_base_t* base,
+    const deoxys_bc_128_384_base_t* counter_base,
+    const __m128i tweak_block);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Returns non-zero if the CPU supports VAES, AVX-512F, and AVX-512BW, which
+ * the sixteen-block functions below require. DEOXYS_BC_SIXTEEN_ENABLED is
+ * defined in two variants: the VAES/AVX-512 variant builds these functions,
+ * and the bitsliced AVX2 variant (DEOXYS_BC_BITSLICED) maps their names to
+ * the bitsliced functions further below, which need only
+ * deoxys_bc_128_384_bitsliced_supported().
+ */
+int deoxys_bc_128_384_sixteen_supported(void);
+
 // ---------------------------------------------------------------------
 // Encryption
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_encrypt(const deoxys_bc_128_384_ctx_t* ctx,
                                const uint8_t tweak_domain,
                                const size_t tweak_counter,
                                const deoxys_bc_block_t tweak_block,
@@ -126,43 +192,97 @@ void deoxys_bc_128_384_encrypt(deoxys_bc_128_384_ctx_t* ctx,
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt_four(deoxys_bc_128_384_ctx_t* ctx,
+/**
+ * Encrypts num_blocks <= DEOXYS_BC_MAX_BATCH_SIZE independent blocks in place.
+ * Unlike the multi-block functions below, every lane has its own domain,
+ * counter, and tweak block.
+ */
+void deoxys_bc_128_384_encrypt_batch(const deoxys_bc_128_384_ctx_t* ctx,
+                                     const size_t num_blocks,
+                                     const uint8_t tweak_domains[],
+                                     const size_t tweak_counters[],
+                                     const __m128i tweak_blocks[],
+                                     __m128i states[]);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Like all functions on __m256i tweak blocks, this one is not built into the
+ * SSE4 variant.
+ */
+void deoxys_bc_128_384_encrypt_four(const deoxys_bc_128_384_base_t* base,
                                     const size_t tweak_counter,
                                     const __m256i tweak_blocks[2],
                                     deoxys_bc_block_t states[4]);
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt_eight(deoxys_bc_128_384_ctx_t* ctx,
-                                    const size_t tweak_counter,
-                                    const __m256i tweak_blocks[4],
-                                    deoxys_bc_block_t states[8]);
+void deoxys_bc_128_384_encrypt_eight(const deoxys_bc_128_384_base_t* base,
+                                     const size_t tweak_counter,
+                                     const __m256i tweak_blocks[4],
+                                     deoxys_bc_block_t states[8]);
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt_eight_eight(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_encrypt_eight_eight(const deoxys_bc_128_384_base_t* base,
                                            const size_t tweak_counter,
                                            const __m128i tweak_blocks[8],
                                            __m128i states[8]);
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_setup_middle_base(deoxys_bc_128_384_ctx_t* ctx,
-                                         const uint8_t tweak_domain,
+/**
+ * Like deoxys_bc_128_384_encrypt_eight_eight(), but on four blocks only, for
+ * tails. Builds without AVX2 run the eight-block kernel on padded lanes.
+ */
+void deoxys_bc_128_384_encrypt_four_four(const deoxys_bc_128_384_base_t* base,
                                          const size_t tweak_counter,
-                                         const __m128i tweak_block);
+                                         const __m128i tweak_blocks[4],
+                                         __m128i states[4]);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Like deoxys_bc_128_384_encrypt_eight_eight(), but on two blocks only.
+ */
+void deoxys_bc_128_384_encrypt_two(const deoxys_bc_128_384_base_t* base,
+                                   const size_t tweak_counter,
+                                   const __m128i tweak_blocks[2],
+                                   __m128i states[2]);
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_encrypt_eight_one(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_encrypt_eight_one(const deoxys_bc_128_384_base_t* base,
                                          const size_t tweak_counter,
                                          __m128i states[8]);
 
+// ---------------------------------------------------------------------
+
+/**
+ * Encrypts 16 blocks with counters tweak_counter .. tweak_counter + 15 in
+ * four 512-bit VAES lanes. Requires deoxys_bc_128_384_sixteen_supported().
+ */
+void deoxys_bc_128_384_encrypt_sixteen(const deoxys_bc_128_384_base_t* base,
+                                       const size_t tweak_counter,
+                                       const __m128i tweak_blocks[16],
+                                       __m128i states[16]);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Sixteen-block variant of deoxys_bc_128_384_encrypt_eight_one(). Requires
+ * deoxys_bc_128_384_sixteen_supported().
+ */
+void deoxys_bc_128_384_encrypt_sixteen_one(
+    const deoxys_bc_128_384_base_t* base,
+    const size_t tweak_counter,
+    __m128i states[16]);
+
 // ---------------------------------------------------------------------
 // Decryption
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_decrypt(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_decrypt(const deoxys_bc_128_384_ctx_t* ctx,
                                const uint8_t tweak_domain,
                                const size_t tweak_counter,
                                const deoxys_bc_block_t tweak_block,
@@ -171,25 +291,209 @@ void deoxys_bc_128_384_decrypt(deoxys_bc_128_384_ctx_t* ctx,
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_decrypt_four(deoxys_bc_128_384_ctx_t* ctx,
+/**
+ * Decrypts num_blocks <= DEOXYS_BC_MAX_BATCH_SIZE independent blocks in place.
+ * Unlike the multi-block functions below, every lane has its own domain,
+ * counter, and tweak block.
+ */
+void deoxys_bc_128_384_decrypt_batch(const deoxys_bc_128_384_ctx_t* ctx,
+                                     const size_t num_blocks,
+                                     const uint8_t tweak_domains[],
+                                     const size_t tweak_counters[],
+                                     const __m128i tweak_blocks[],
+                                     __m128i states[]);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Like all functions on __m256i tweak blocks, this one is not built into the
+ * SSE4 variant.
+ */
+void deoxys_bc_128_384_decrypt_four(const deoxys_bc_128_384_base_t* base,
                                     const size_t tweak_counter,
                                     __m256i tweak_blocks[2],
                                     deoxys_bc_block_t states[4]);
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_decrypt_eight(deoxys_bc_128_384_ctx_t* ctx,
-                                    const size_t tweak_counter,
-                                    __m256i tweak_blocks[4],
-                                    deoxys_bc_block_t states[8]);
+void deoxys_bc_128_384_decrypt_eight(const deoxys_bc_128_384_base_t* base,
+                                     const size_t tweak_counter,
+                                     __m256i tweak_blocks[4],
+                                     deoxys_bc_block_t states[8]);
 
 // ---------------------------------------------------------------------
 
-void deoxys_bc_128_384_decrypt_eight_eight(deoxys_bc_128_384_ctx_t* ctx,
+void deoxys_bc_128_384_decrypt_eight_eight(const deoxys_bc_128_384_base_t* base,
                                            const size_t tweak_counter,
                                            const __m128i tweak_blocks[8],
                                            __m128i states[8]);
 
 // ---------------------------------------------------------------------
 
+/**
+ * Like deoxys_bc_128_384_decrypt_eight_eight(), but on four blocks only, for
+ * tails. Builds without AVX2 run the eight-block kernel on padded lanes.
+ */
+void deoxys_bc_128_384_decrypt_four_four(const deoxys_bc_128_384_base_t* base,
+                                         const size_t tweak_counter,
+                                         const __m128i tweak_blocks[4],
+                                         __m128i states[4]);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Like deoxys_bc_128_384_decrypt_eight_eight(), but on two blocks only.
+ */
+void deoxys_bc_128_384_decrypt_two(const deoxys_bc_128_384_base_t* base,
+                                   const size_t tweak_counter,
+                                   const __m128i tweak_blocks[2],
+                                   __m128i states[2]);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Decrypts 16 blocks with counters tweak_counter .. tweak_counter + 15 in
+ * four 512-bit VAES lanes. Requires deoxys_bc_128_384_sixteen_supported().
+ */
+void deoxys_bc_128_384_decrypt_sixteen(const deoxys_bc_128_384_base_t* base,
+                                       const size_t tweak_counter,
+                                       const __m128i tweak_blocks[16],
+                                       __m128i states[16]);
+
+// ---------------------------------------------------------------------
+// Sixteen blocks, bitsliced
+// ---------------------------------------------------------------------
+
+/**
+ * Returns non-zero if the CPU supports AVX2, which the bitsliced functions
+ * below require. Those are only built into the bitsliced AVX2 variant
+ * (DEOXYS_BC_BITSLICED), where they replace the sixteen-block functions.
+ */
+int deoxys_bc_128_384_bitsliced_supported(void);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Like deoxys_bc_128_384_encrypt_sixteen(), but on the bit planes of the
+ * blocks in eight 256-bit registers, without AES-NI.
+ */
+void deoxys_bc_128_384_encrypt_sixteen_bitsliced(
+    const deoxys_bc_128_384_base_t* base,
+    const size_t tweak_counter,
+    const __m128i tweak_blocks[16],
+    __m128i states[16]);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_encrypt_sixteen_one_bitsliced(
+    const deoxys_bc_128_384_base_t* base,
+    const size_t tweak_counter,
+    __m128i states[16]);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_384_decrypt_sixteen_bitsliced(
+    const deoxys_bc_128_384_base_t* base,
+    const size_t tweak_counter,
+    const __m128i tweak_blocks[16],
+    __m128i states[16]);
+
+// ---------------------------------------------------------------------
+// Deoxys-BC-128-128 and Deoxys-BC-128-256
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_setup_key(deoxys_bc_128_128_ctx_t* ctx,
+                                 const deoxys_bc_key_t key);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_setup_decryption_key(deoxys_bc_128_128_ctx_t* ctx);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_encrypt(const deoxys_bc_128_128_ctx_t* ctx,
+                               const deoxys_bc_block_t plaintext,
+                               deoxys_bc_block_t* ciphertext);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Encrypts four independent blocks in place.
+ */
+void deoxys_bc_128_128_encrypt_four(const deoxys_bc_128_128_ctx_t* ctx,
+                                    deoxys_bc_block_t states[4]);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_encrypt_eight(const deoxys_bc_128_128_ctx_t* ctx,
+                                     deoxys_bc_block_t states[8]);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_decrypt(const deoxys_bc_128_128_ctx_t* ctx,
+                               const deoxys_bc_block_t ciphertext,
+                               deoxys_bc_block_t* plaintext);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_decrypt_four(const deoxys_bc_128_128_ctx_t* ctx,
+                                    deoxys_bc_block_t states[4]);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_128_decrypt_eight(const deoxys_bc_128_128_ctx_t* ctx,
+                                     deoxys_bc_block_t states[8]);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_setup_key(deoxys_bc_128_256_ctx_t* ctx,
+                                 const deoxys_bc_key_t key);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_setup_decryption_key(deoxys_bc_128_256_ctx_t* ctx);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_encrypt(const deoxys_bc_128_256_ctx_t* ctx,
+                               const deoxys_bc_128_256_tweak_t tweak,
+                               const deoxys_bc_block_t plaintext,
+                               deoxys_bc_block_t* ciphertext);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Encrypts four blocks in place, each under its own tweak.
+ */
+void deoxys_bc_128_256_encrypt_four(const deoxys_bc_128_256_ctx_t* ctx,
+                                    const deoxys_bc_128_256_tweak_t tweaks[4],
+                                    deoxys_bc_block_t states[4]);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_encrypt_eight(const deoxys_bc_128_256_ctx_t* ctx,
+                                     const deoxys_bc_128_256_tweak_t tweaks[8],
+                                     deoxys_bc_block_t states[8]);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_decrypt(const deoxys_bc_128_256_ctx_t* ctx,
+                               const deoxys_bc_128_256_tweak_t tweak,
+                               const deoxys_bc_block_t ciphertext,
+                               deoxys_bc_block_t* plaintext);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_decrypt_four(const deoxys_bc_128_256_ctx_t* ctx,
+                                    const deoxys_bc_128_256_tweak_t tweaks[4],
+                                    deoxys_bc_block_t states[4]);
+
+// ---------------------------------------------------------------------
+
+void deoxys_bc_128_256_decrypt_eight(const deoxys_bc_128_256_ctx_t* ctx,
+                                     const deoxys_bc_128_256_tweak_t tweaks[8],
+                                     deoxys_bc_block_t states[8]);
+
+// ---------------------------------------------------------------------
+
 #endif  // _DEOXYS_BC_H_
@@ -0,0 +1,319 @@
+/*
+// @author anonymized
+// @last-modified 2018-08
+// Copyright 2018 anonymized
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "deoxysbc.h"
+#include "dispatch.h"
+#include "zcz.h"
+
+// ---------------------------------------------------------------------
+// CPU features
+// ---------------------------------------------------------------------
+
+static int is_ssse3_supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+// ---------------------------------------------------------------------
+
+static int is_sse4_supported(void) {
+    return is_ssse3_supported()
+        && __builtin_cpu_supports("sse4.1")
+        && __builtin_cpu_supports("aes")
+        && __builtin_cpu_supports("pclmul");
+}
+
+// ---------------------------------------------------------------------
+
+static int is_avx2_supported(void) {
+    return is_sse4_supported()
+        && __builtin_cpu_supports("avx2");
+}
+
+// ---------------------------------------------------------------------
+
+static int is_avx512_supported(void) {
+    return is_avx2_supported()
+        && __builtin_cpu_supports("avx512f")
+        && __builtin_cpu_supports("avx512bw")
+        && __builtin_cpu_supports("vaes")
+        && __builtin_cpu_supports("vpclmulqdq");
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * AVX2 without requiring AES-NI and PCLMULQDQ, for the bitsliced variant.
+ */
+static int is_avx2_bitsliced_supported(void) {
+    return is_ssse3_supported()
+        && __builtin_cpu_supports("sse4.1")
+        && __builtin_cpu_supports("avx2");
+}
+
+// ---------------------------------------------------------------------
+
+int deoxys_bc_128_384_sixteen_supported(void) {
+    return is_avx512_supported();
+}
+
+// ---------------------------------------------------------------------
+
+int deoxys_bc_128_384_bitsliced_supported(void) {
+    return is_avx2_bitsliced_supported();
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Returns the implementation for the given instruction set, or NULL if the
+ * CPU does not support it.
+ */
+static const zcz_impl_t* get_impl(const zcz_isa_t isa) {
+    switch (isa) {
+        case ZCZ_ISA_AUTO:
+            if (is_avx512_supported()) {
+                return &ISA_CONCAT(zcz_impl, ZCZ_ISA_AVX512_NAME);
+            }
+
+            if (is_avx2_supported()) {
+                return &ISA_CONCAT(zcz_impl, ZCZ_ISA_AVX2_NAME);
+            }
+
+            if (is_sse4_supported()) {
+                return &ISA_CONCAT(zcz_impl, ZCZ_ISA_SSE4_NAME);
+            }
+
+            if (is_avx2_bitsliced_supported()) {
+                return &ISA_CONCAT(zcz_impl, ZCZ_ISA_AVX2_BITSLICED_NAME);
+            }
+
+            return &ISA_CONCAT(zcz_impl, ZCZ_ISA_SSSE3_NAME);
+        case ZCZ_ISA_SSSE3:
+            return is_ssse3_supported() ?
+                &ISA_CONCAT(zcz_impl, ZCZ_ISA_SSSE3_NAME) : NULL;
+        case ZCZ_ISA_SSE4:
+            return is_sse4_supported() ?
+                &ISA_CONCAT(zcz_impl, ZCZ_ISA_SSE4_NAME) : NULL;
+        case ZCZ_ISA_AVX2:
+            return is_avx2_supported() ?
+                &ISA_CONCAT(zcz_impl, ZCZ_ISA_AVX2_NAME) : NULL;
+        case ZCZ_ISA_AVX512:
+            return is_avx512_supported() ?
+                &ISA_CONCAT(zcz_impl, ZCZ_ISA_AVX512_NAME) : NULL;
+        case ZCZ_ISA_AVX2_BITSLICED:
+            return is_avx2_bitsliced_supported() ?
+                &ISA_CONCAT(zcz_impl, ZCZ_ISA_AVX2_BITSLICED_NAME) : NULL;
+        default:
+            return NULL;
+    }
+}
+
+// ---------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------
+
+void zcz_keysetup(zcz_ctx_t* ctx, const zcz_key_t key) {
+    zcz_keysetup_isa(ctx, key, ZCZ_ISA_AUTO);
+}
+
+// ---------------------------------------------------------------------
+
+int zcz_keysetup_isa(zcz_ctx_t* ctx,
+                     const zcz_key_t key,
+                     const zcz_isa_t isa) {
+    const zcz_impl_t* impl = get_impl(isa);
+
+    if (impl == NULL) {
+        return -1;
+    }
+
+    impl->keysetup(ctx, key);
+    ctx->impl = impl;
+#ifdef ZCZ_STATS
+    ctx->stats = NULL;
+#endif
+    return 0;
+}
+
+// ---------------------------------------------------------------------
+
+const char* zcz_isa_name(const zcz_ctx_t* ctx) {
+    return ctx->impl->name;
+}
+
+#ifdef ZCZ_STATS
+// ---------------------------------------------------------------------
+
+void zcz_set_stats(zcz_ctx_t* ctx, zcz_stats_t* stats) {
+    ctx->stats = stats;
+}
+#endif  // ZCZ_STATS
+
+// ---------------------------------------------------------------------
+
+size_t zcz_workspace_size(const size_t num_bytes) {
+    // All layers work in place in the output buffer.
+    (void)num_bytes;
+    return 0;
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_basic_encrypt(const zcz_ctx_t* ctx,
+                       const uint8_t* plaintext,
+                       const size_t num_plaintext_bytes,
+                       uint8_t* ciphertext) {
+    ctx->impl->basic_encrypt(ctx, plaintext, num_plaintext_bytes, ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_basic_decrypt(const zcz_ctx_t* ctx,
+                       const uint8_t* ciphertext,
+                       const size_t num_ciphertext_bytes,
+                       uint8_t* plaintext) {
+    ctx->impl->basic_decrypt(ctx, ciphertext, num_ciphertext_bytes, plaintext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_encrypt(const zcz_ctx_t* ctx,
+                 const uint8_t* plaintext,
+                 const size_t num_plaintext_bytes,
+                 uint8_t* ciphertext) {
+    ctx->impl->encrypt(ctx, plaintext, num_plaintext_bytes, ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_decrypt(const zcz_ctx_t* ctx,
+                 const uint8_t* ciphertext,
+                 const size_t num_ciphertext_bytes,
+                 uint8_t* plaintext) {
+    ctx->impl->decrypt(ctx, ciphertext, num_ciphertext_bytes, plaintext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_encrypt_ws(const zcz_ctx_t* ctx,
+                    const uint8_t* plaintext,
+                    const size_t num_plaintext_bytes,
+                    uint8_t* ciphertext,
+                    uint8_t* workspace) {
+    (void)workspace;
+    zcz_encrypt(ctx, plaintext, num_plaintext_bytes, ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_decrypt_ws(const zcz_ctx_t* ctx,
+                    const uint8_t* ciphertext,
+                    const size_t num_ciphertext_bytes,
+                    uint8_t* plaintext,
+                    uint8_t* workspace) {
+    (void)workspace;
+    zcz_decrypt(ctx, ciphertext, num_ciphertext_bytes, plaintext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_encrypt_many(const zcz_ctx_t* ctx,
+                      const zcz_message_t* messages,
+                      const size_t num_messages) {
+    ctx->impl->encrypt_many(ctx, messages, num_messages);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_decrypt_many(const zcz_ctx_t* ctx,
+                      const zcz_message_t* messages,
+                      const size_t num_messages) {
+    ctx->impl->decrypt_many(ctx, messages, num_messages);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_encrypt_recompute(const zcz_ctx_t* ctx,
+                           const uint8_t* plaintext,
+                           const size_t num_plaintext_bytes,
+                           zcz_output_fn output,
+                           void* output_context) {
+    ctx->impl->encrypt_recompute(ctx,
+                                 plaintext,
+                                 num_plaintext_bytes,
+                                 output,
+                                 output_context);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_decrypt_recompute(const zcz_ctx_t* ctx,
+                           const uint8_t* ciphertext,
+                           const size_t num_ciphertext_bytes,
+                           zcz_output_fn output,
+                           void* output_context) {
+    ctx->impl->decrypt_recompute(ctx,
+                                 ciphertext,
+                                 num_ciphertext_bytes,
+                                 output,
+                                 output_context);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_encrypt_parallel(const zcz_ctx_t* ctx,
+                          zcz_pool_t* pool,
+                          const uint8_t* plaintext,
+                          const size_t num_plaintext_bytes,
+                          uint8_t* ciphertext) {
+    ctx->impl->encrypt_parallel(ctx,
+                                pool,
+                                plaintext,
+                                num_plaintext_bytes,
+                                ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_decrypt_parallel(const zcz_ctx_t* ctx,
+                          zcz_pool_t* pool,
+                          const uint8_t* ciphertext,
+                          const size_t num_ciphertext_bytes,
+                          uint8_t* plaintext) {
+    ctx->impl->decrypt_parallel(ctx,
+                                pool,
+                                ciphertext,
+                                num_ciphertext_bytes,
+                                plaintext);
+}
@@ -0,0 +1,96 @@
+/*
+// @author anonymized
+// @last-modified 2018-08
+// Copyright 2018 anonymized
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+*/
+
+#ifndef _DISPATCH_H_
+#define _DISPATCH_H_
+
+#include <stdint.h>
+
+#include "zcz.h"
+
+// ---------------------------------------------------------------------
+// Types
+// ---------------------------------------------------------------------
+
+typedef void (*zcz_keysetup_fn)(zcz_ctx_t* ctx, const zcz_key_t key);
+
+typedef void (*zcz_crypt_fn)(const zcz_ctx_t* ctx,
+                             const uint8_t* input,
+                             const size_t num_bytes,
+                             uint8_t* output);
+
+typedef void (*zcz_crypt_many_fn)(const zcz_ctx_t* ctx,
+                                  const zcz_message_t* messages,
+                                  const size_t num_messages);
+
+typedef void (*zcz_crypt_recompute_fn)(const zcz_ctx_t* ctx,
+                                       const uint8_t* input,
+                                       const size_t num_bytes,
+                                       zcz_output_fn output,
+                                       void* output_context);
+
+typedef void (*zcz_crypt_parallel_fn)(const zcz_ctx_t* ctx,
+                                      zcz_pool_t* pool,
+                                      const uint8_t* input,
+                                      const size_t num_bytes,
+                                      uint8_t* output);
+
+/**
+ * Entry points of one build of deoxysbc.c, gfmul.c, and zcz.c for a given
+ * instruction set.
+ */
+typedef struct zcz_impl_s {
+    const char* name;
+    zcz_keysetup_fn keysetup;
+    zcz_crypt_fn basic_encrypt;
+    zcz_crypt_fn basic_decrypt;
+    zcz_crypt_fn encrypt;
+    zcz_crypt_fn decrypt;
+    zcz_crypt_many_fn encrypt_many;
+    zcz_crypt_many_fn decrypt_many;
+    zcz_crypt_recompute_fn encrypt_recompute;
+    zcz_crypt_recompute_fn decrypt_recompute;
+    zcz_crypt_parallel_fn encrypt_parallel;
+    zcz_crypt_parallel_fn decrypt_parallel;
+} zcz_impl_t;
+
+// ---------------------------------------------------------------------
+// Implementations
+// ---------------------------------------------------------------------
+
+extern const zcz_impl_t ISA_CONCAT(zcz_impl, ZCZ_ISA_SSE4_NAME);
+extern const zcz_impl_t ISA_CONCAT(zcz_impl, ZCZ_ISA_AVX2_NAME);
+extern const zcz_impl_t ISA_CONCAT(zcz_impl, ZCZ_ISA_AVX512_NAME);
+extern const zcz_impl_t ISA_CONCAT(zcz_impl, ZCZ_ISA_SSSE3_NAME);
+extern const zcz_impl_t ISA_CONCAT(zcz_impl, ZCZ_ISA_AVX2_BITSLICED_NAME);
+
+// ---------------------------------------------------------------------
+
+#endif  // _DISPATCH_H_
@@ -50,6 +50,26 @@
     y = vxor(x[0], x[4]); \
 }
 
+#define accumulate_sixteen(x, y) { \
+    __m128i upper; \
+    accumulate_eight(x, y); \
+    accumulate_eight((x + 8), upper); \
+    y = vxor(y, upper); \
+}
+
+/**
+ * Multiplies the carries x by 135 = x^7 + x^2 + x + 1. The Horner sums below
+ * carry at most 32 bits out of a 64-bit half, so the product still fits into
+ * it and needs no carry-less multiplication, which is costly in software.
+ */
+#define times_135(x) \
+    vxor(vxor(x, vshift_left_64(x, 1)), \
+         vxor(vshift_left_64(x, 2), vshift_left_64(x, 7)))
+
+#define avx_times_135(x) \
+    avx_xor(avx_xor(x, _mm256_slli_epi64(x, 1)), \
+            avx_xor(_mm256_slli_epi64(x, 2), _mm256_slli_epi64(x, 7)))
+
 // ---------------------------------------------------------------------
 
 __m128i gf_2_128_double_eight(__m128i hash, __m128i x[8]) {
@@ -69,10 +89,10 @@ __m128i gf_2_128_double_eight(__m128i hash, __m128i x[8]) {
     // ---------------------------------------------------------------------
     // sum = sum_high || sum_low
     // We have to take sum_high * 135 and XOR it to our XOR sum to have the
-    // Reduction term. The 0x01 indicates that sum_high is used.
+    // Reduction term.
     // ---------------------------------------------------------------------
 
-    __m128i mod = clmul(sum, REDUCTION_POLYNOMIAL, 0x01);
+    __m128i mod = times_135(vshift_bytes_right(sum, 8));
 
     // Move sum_low to the upper 64-bit half
     __m128i sum_low = vshift_bytes_left(sum, 8);
@@ -112,10 +132,10 @@ __m128i gf_2_128_times_four_eight(__m128i hash, __m128i x[8]) {
     // ---------------------------------------------------------------------
     // sum = sum_high || sum_low
     // We have to take sum_high * 135 and XOR it to our XOR sum to have the
-    // Reduction term. The 0x01 indicates that sum_high is used.
+    // Reduction term.
     // ---------------------------------------------------------------------
 
-    __m128i mod = clmul(sum, REDUCTION_POLYNOMIAL, 0x01);
+    __m128i mod = times_135(vshift_bytes_right(sum, 8));
 
     // Move sum_low to the upper 64-bit half
     __m128i sum_low = vshift_bytes_left(sum, 8);
@@ -135,3 +155,271 @@ __m128i gf_2_128_times_four_eight(__m128i hash, __m128i x[8]) {
     sum = vxor(sum, x[7]);
     return sum;
 }
+
+// ---------------------------------------------------------------------
+
+__m128i gf_2_128_double_sixteen(__m128i hash, __m128i x[16]) {
+    __m128i tmp[16];
+    tmp[0] = vshift_right_64(hash, 48);
+    tmp[1] = vshift_right_64(x[0], 49);
+    tmp[2] = vshift_right_64(x[1], 50);
+    tmp[3] = vshift_right_64(x[2], 51);
+    tmp[4] = vshift_right_64(x[3], 52);
+    tmp[5] = vshift_right_64(x[4], 53);
+    tmp[6] = vshift_right_64(x[5], 54);
+    tmp[7] = vshift_right_64(x[6], 55);
+    tmp[8] = vshift_right_64(x[7], 56);
+    tmp[9] = vshift_right_64(x[8], 57);
+    tmp[10] = vshift_right_64(x[9], 58);
+    tmp[11] = vshift_right_64(x[10], 59);
+    tmp[12] = vshift_right_64(x[11], 60);
+    tmp[13] = vshift_right_64(x[12], 61);
+    tmp[14] = vshift_right_64(x[13], 62);
+    tmp[15] = vshift_right_64(x[14], 63);
+
+    __m128i sum;
+    accumulate_sixteen(tmp, sum);
+
+    // The carries of the upper half wrap around times 135, those of the
+    // lower half move to the upper half
+    __m128i mod = times_135(vshift_bytes_right(sum, 8));
+    __m128i sum_low = vshift_bytes_left(sum, 8);
+
+    tmp[0] = vshift_left_64(hash, 16);
+    tmp[1] = vshift_left_64(x[0], 15);
+    tmp[2] = vshift_left_64(x[1], 14);
+    tmp[3] = vshift_left_64(x[2], 13);
+    tmp[4] = vshift_left_64(x[3], 12);
+    tmp[5] = vshift_left_64(x[4], 11);
+    tmp[6] = vshift_left_64(x[5], 10);
+    tmp[7] = vshift_left_64(x[6], 9);
+    tmp[8] = vshift_left_64(x[7], 8);
+    tmp[9] = vshift_left_64(x[8], 7);
+    tmp[10] = vshift_left_64(x[9], 6);
+    tmp[11] = vshift_left_64(x[10], 5);
+    tmp[12] = vshift_left_64(x[11], 4);
+    tmp[13] = vshift_left_64(x[12], 3);
+    tmp[14] = vshift_left_64(x[13], 2);
+    tmp[15] = vshift_left_64(x[14], 1);
+
+    accumulate_sixteen(tmp, sum);
+    sum = vxor(sum, sum_low);
+    sum = vxor(sum, mod);
+    sum = vxor(sum, x[15]);
+    return sum;
+}
+
+// ---------------------------------------------------------------------
+
+__m128i gf_2_128_times_four_sixteen(__m128i hash, __m128i x[16]) {
+    __m128i tmp[16];
+    tmp[0] = vshift_right_64(hash, 32);
+    tmp[1] = vshift_right_64(x[0], 34);
+    tmp[2] = vshift_right_64(x[1], 36);
+    tmp[3] = vshift_right_64(x[2], 38);
+    tmp[4] = vshift_right_64(x[3], 40);
+    tmp[5] = vshift_right_64(x[4], 42);
+    tmp[6] = vshift_right_64(x[5], 44);
+    tmp[7] = vshift_right_64(x[6], 46);
+    tmp[8] = vshift_right_64(x[7], 48);
+    tmp[9] = vshift_right_64(x[8], 50);
+    tmp[10] = vshift_right_64(x[9], 52);
+    tmp[11] = vshift_right_64(x[10], 54);
+    tmp[12] = vshift_right_64(x[11], 56);
+    tmp[13] = vshift_right_64(x[12], 58);
+    tmp[14] = vshift_right_64(x[13], 60);
+    tmp[15] = vshift_right_64(x[14], 62);
+
+    __m128i sum;
+    accumulate_sixteen(tmp, sum);
+
+    __m128i mod = times_135(vshift_bytes_right(sum, 8));
+    __m128i sum_low = vshift_bytes_left(sum, 8);
+
+    tmp[0] = vshift_left_64(hash, 32);
+    tmp[1] = vshift_left_64(x[0], 30);
+    tmp[2] = vshift_left_64(x[1], 28);
+    tmp[3] = vshift_left_64(x[2], 26);
+    tmp[4] = vshift_left_64(x[3], 24);
+    tmp[5] = vshift_left_64(x[4], 22);
+    tmp[6] = vshift_left_64(x[5], 20);
+    tmp[7] = vshift_left_64(x[6], 18);
+    tmp[8] = vshift_left_64(x[7], 16);
+    tmp[9] = vshift_left_64(x[8], 14);
+    tmp[10] = vshift_left_64(x[9], 12);
+    tmp[11] = vshift_left_64(x[10], 10);
+    tmp[12] = vshift_left_64(x[11], 8);
+    tmp[13] = vshift_left_64(x[12], 6);
+    tmp[14] = vshift_left_64(x[13], 4);
+    tmp[15] = vshift_left_64(x[14], 2);
+
+    accumulate_sixteen(tmp, sum);
+    sum = vxor(sum, sum_low);
+    sum = vxor(sum, mod);
+    sum = vxor(sum, x[15]);
+    return sum;
+}
+
+// ---------------------------------------------------------------------
+
+#ifdef __AVX2__
+
+/**
+ * Multiplies the lower lane of blocks by 2^d and the upper one by 4^d,
+ * split into the bits that stay in their 64-bit half and those carried out.
+ */
+#define shift_two_lanes(sum, carries, blocks, d) { \
+    carries = _mm256_srlv_epi64(blocks, \
+        avx_set64(64 - 2 * (d), 64 - 2 * (d), 64 - (d), 64 - (d))); \
+    sum = _mm256_sllv_epi64(blocks, avx_set64(2 * (d), 2 * (d), (d), (d))); \
+}
+
+#define fold_two_lanes(sum, carries, blocks, d) { \
+    __m256i shifted_sum; \
+    __m256i shifted_carries; \
+    shift_two_lanes(shifted_sum, shifted_carries, blocks, d); \
+    sum = avx_xor(sum, shifted_sum); \
+    carries = avx_xor(carries, shifted_carries); \
+}
+
+#define two_lanes(x, y, i)  _mm256_set_m128i(y[i], x[i])
+
+// ---------------------------------------------------------------------
+
+static inline __m256i reduce_two_lanes(__m256i sum, const __m256i carries) {
+    const __m256i mod = avx_times_135(avx_shift_bytes_right(carries, 8));
+    return avx_xor3(sum, avx_shift_bytes_left(carries, 8), mod);
+}
+
+// ---------------------------------------------------------------------
+
+void gf_2_128_double_and_times_four_eight(__m128i* hash_double,
+                                          __m128i* hash_times_four,
+                                          __m128i x[8],
+                                          __m128i y[8]) {
+    __m256i sum;
+    __m256i carries;
+    shift_two_lanes(sum, carries,
+                    _mm256_set_m128i(*hash_times_four, *hash_double), 8);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 0), 7);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 1), 6);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 2), 5);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 3), 4);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 4), 3);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 5), 2);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 6), 1);
+
+    sum = reduce_two_lanes(sum, carries);
+    sum = avx_xor(sum, two_lanes(x, y, 7));
+    *hash_double = vget128(sum, 0);
+    *hash_times_four = vget128(sum, 1);
+}
+
+// ---------------------------------------------------------------------
+
+void gf_2_128_double_and_times_four_sixteen(__m128i* hash_double,
+                                            __m128i* hash_times_four,
+                                            __m128i x[16],
+                                            __m128i y[16]) {
+    __m256i sum;
+    __m256i carries;
+    shift_two_lanes(sum, carries,
+                    _mm256_set_m128i(*hash_times_four, *hash_double), 16);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 0), 15);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 1), 14);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 2), 13);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 3), 12);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 4), 11);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 5), 10);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 6), 9);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 7), 8);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 8), 7);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 9), 6);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 10), 5);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 11), 4);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 12), 3);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 13), 2);
+    fold_two_lanes(sum, carries, two_lanes(x, y, 14), 1);
+
+    sum = reduce_two_lanes(sum, carries);
+    sum = avx_xor(sum, two_lanes(x, y, 15));
+    *hash_double = vget128(sum, 0);
+    *hash_times_four = vget128(sum, 1);
+}
+
+#else
+
+void gf_2_128_double_and_times_four_eight(__m128i* hash_double,
+                                          __m128i* hash_times_four,
+                                          __m128i x[8],
+                                          __m128i y[8]) {
+    *hash_double = gf_2_128_double_eight(*hash_double, x);
+    *hash_times_four = gf_2_128_times_four_eight(*hash_times_four, y);
+}
+
+// ---------------------------------------------------------------------
+
+void gf_2_128_double_and_times_four_sixteen(__m128i* hash_double,
+                                            __m128i* hash_times_four,
+                                            __m128i x[16],
+                                            __m128i y[16]) {
+    *hash_double = gf_2_128_double_sixteen(*hash_double, x);
+    *hash_times_four = gf_2_128_times_four_sixteen(*hash_times_four, y);
+}
+
+#endif  // __AVX2__
+
+// ---------------------------------------------------------------------
+
+__m128i gf_2_128_mul(__m128i x, __m128i y) {
+    // ---------------------------------------------------------------------
+    // Carry-less 256-bit product high || low
+    // ---------------------------------------------------------------------
+
+    __m128i low = clmul(x, y, 0x00);
+    __m128i high = clmul(x, y, 0x11);
+    __m128i middle = vxor(clmul(x, y, 0x01), clmul(x, y, 0x10));
+
+    low = vxor(low, vshift_bytes_left(middle, 8));
+    high = vxor(high, vshift_bytes_right(middle, 8));
+
+    // ---------------------------------------------------------------------
+    // x^{128} = x^7 + x^2 + x + 1, so high * 135 is added to low. The upper
+    // half of high overflows by up to 7 bits, which are reduced once more.
+    // ---------------------------------------------------------------------
+
+    __m128i mod = clmul(high, REDUCTION_POLYNOMIAL, 0x01);
+    low = vxor(low, clmul(high, REDUCTION_POLYNOMIAL, 0x00));
+    low = vxor(low, vshift_bytes_left(mod, 8));
+
+    mod = clmul(vshift_bytes_right(mod, 8), REDUCTION_POLYNOMIAL, 0x00);
+    return vxor(low, mod);
+}
+
+// ---------------------------------------------------------------------
+
+__m128i gf_2_128_times_two_power(__m128i x, const size_t exponent) {
+    // 2^{2^i}, squared in every step
+    __m128i power = set32(0, 0, 0, 2);
+    size_t remaining_exponent = exponent;
+
+    while (remaining_exponent > 0) {
+        if (remaining_exponent & 1) {
+            x = gf_2_128_mul(x, power);
+        }
+
+        remaining_exponent >>= 1;
+
+        if (remaining_exponent > 0) {
+            power = gf_2_128_mul(power, power);
+        }
+    }
+
+    return x;
+}
+
+// ---------------------------------------------------------------------
+
+__m128i gf_2_128_times_four_power(__m128i x, const size_t exponent) {
+    return gf_2_128_times_two_power(x, 2 * exponent);
+}
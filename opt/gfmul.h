@@ -35,6 +35,9 @@
 #include <emmintrin.h>
 #include <immintrin.h>
 #include <smmintrin.h>
+#include <stddef.h>
+
+#include "isa.h"
 
 // ---------------------------------------------------------------------
 
@@ -71,6 +74,56 @@ __m128i gf_2_128_double_eight(__m128i hash, __m128i x[8]);
  */
 __m128i gf_2_128_times_four_eight(__m128i hash, __m128i x[8]);
 
+/**
+ * Computes y = sum_{i = 0}^{16} x_i * 2^{16-i} in GF(2^{128}), with one
+ * reduction for all sixteen blocks.
+ */
+__m128i gf_2_128_double_sixteen(__m128i hash, __m128i x[16]);
+
+/**
+ * Computes y = sum_{i = 0}^{16} x_i * 4^{16-i} in GF(2^{128}), with one
+ * reduction for all sixteen blocks.
+ */
+__m128i gf_2_128_times_four_sixteen(__m128i hash, __m128i x[16]);
+
+/**
+ * Updates hash_double as gf_2_128_double_eight(hash_double, x) and
+ * hash_times_four as gf_2_128_times_four_eight(hash_times_four, y) in one
+ * pass. With AVX2, both hashes are folded side by side in the two lanes of
+ * one __m256i.
+ */
+void gf_2_128_double_and_times_four_eight(__m128i* hash_double,
+                                          __m128i* hash_times_four,
+                                          __m128i x[8],
+                                          __m128i y[8]);
+
+/**
+ * The sixteen-block counterpart of gf_2_128_double_and_times_four_eight().
+ */
+void gf_2_128_double_and_times_four_sixteen(__m128i* hash_double,
+                                            __m128i* hash_times_four,
+                                            __m128i x[16],
+                                            __m128i y[16]);
+
+/**
+ * Computes x * y in GF(2^{128}) with PCLMULQDQ, using the same reduction
+ * polynomial.
+ */
+__m128i gf_2_128_mul(__m128i x, __m128i y);
+
+/**
+ * Computes x * 2^{exponent} in GF(2^{128}). Combines Horner sums of
+ * gf_2_128_double() over neighbouring ranges: the sum over the first range
+ * is multiplied by 2 to the length of the second one.
+ */
+__m128i gf_2_128_times_two_power(__m128i x, const size_t exponent);
+
+/**
+ * Computes x * 4^{exponent} in GF(2^{128}), the counterpart of
+ * gf_2_128_times_two_power() for gf_2_128_times_four().
+ */
+__m128i gf_2_128_times_four_power(__m128i x, const size_t exponent);
+
 // ---------------------------------------------------------------------
 
 #endif  // _GFMUL_H_
@@ -0,0 +1,165 @@
+/*
+// @author anonymized
+// @last-modified 2018-08
+// Copyright 2018 anonymized
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+*/
+
+#ifndef _ISA_H_
+#define _ISA_H_
+
+// ---------------------------------------------------------------------
+// deoxysbc.c, gfmul.c, and zcz.c are compiled once per instruction set
+// (see CMakeLists.txt). Each build defines ZCZ_ISA, e.g., -DZCZ_ISA=avx2,
+// which appends _avx2 to all of their external symbols, so that the
+// variants can be linked into the same binary. zcz_keysetup() chooses one
+// of them at run time.
+// ---------------------------------------------------------------------
+
+#define ZCZ_ISA_SSE4_NAME             sse4
+#define ZCZ_ISA_AVX2_NAME             avx2
+#define ZCZ_ISA_AVX512_NAME           avx512
+#define ZCZ_ISA_SSSE3_NAME            ssse3
+#define ZCZ_ISA_AVX2_BITSLICED_NAME   avx2_bitsliced
+
+#define ISA_CONCAT_(name, isa)  name ## _ ## isa
+#define ISA_CONCAT(name, isa)   ISA_CONCAT_(name, isa)
+#define ISA_STRING_(isa)        #isa
+#define ISA_STRING(isa)         ISA_STRING_(isa)
+
+// ---------------------------------------------------------------------
+
+#ifdef ZCZ_ISA
+
+#define ISA_NAME(name)          ISA_CONCAT(name, ZCZ_ISA)
+
+#define deoxys_bc_128_384_setup_key \
+    ISA_NAME(deoxys_bc_128_384_setup_key)
+#define deoxys_bc_128_384_setup_decryption_key \
+    ISA_NAME(deoxys_bc_128_384_setup_decryption_key)
+#define deoxys_bc_128_384_setup_base_counters \
+    ISA_NAME(deoxys_bc_128_384_setup_base_counters)
+#define deoxys_bc_128_384_setup_middle_base \
+    ISA_NAME(deoxys_bc_128_384_setup_middle_base)
+#define deoxys_bc_128_384_encrypt \
+    ISA_NAME(deoxys_bc_128_384_encrypt)
+#define deoxys_bc_128_384_encrypt_batch \
+    ISA_NAME(deoxys_bc_128_384_encrypt_batch)
+#define deoxys_bc_128_384_encrypt_four \
+    ISA_NAME(deoxys_bc_128_384_encrypt_four)
+#define deoxys_bc_128_384_encrypt_eight \
+    ISA_NAME(deoxys_bc_128_384_encrypt_eight)
+#define deoxys_bc_128_384_encrypt_eight_eight \
+    ISA_NAME(deoxys_bc_128_384_encrypt_eight_eight)
+#define deoxys_bc_128_384_encrypt_four_four \
+    ISA_NAME(deoxys_bc_128_384_encrypt_four_four)
+#define deoxys_bc_128_384_encrypt_two \
+    ISA_NAME(deoxys_bc_128_384_encrypt_two)
+#define deoxys_bc_128_384_encrypt_eight_one \
+    ISA_NAME(deoxys_bc_128_384_encrypt_eight_one)
+#define deoxys_bc_128_384_decrypt \
+    ISA_NAME(deoxys_bc_128_384_decrypt)
+#define deoxys_bc_128_384_decrypt_batch \
+    ISA_NAME(deoxys_bc_128_384_decrypt_batch)
+#define deoxys_bc_128_384_decrypt_four \
+    ISA_NAME(deoxys_bc_128_384_decrypt_four)
+#define deoxys_bc_128_384_decrypt_eight \
+    ISA_NAME(deoxys_bc_128_384_decrypt_eight)
+#define deoxys_bc_128_384_decrypt_eight_eight \
+    ISA_NAME(deoxys_bc_128_384_decrypt_eight_eight)
+#define deoxys_bc_128_384_decrypt_four_four \
+    ISA_NAME(deoxys_bc_128_384_decrypt_four_four)
+#define deoxys_bc_128_384_decrypt_two \
+    ISA_NAME(deoxys_bc_128_384_decrypt_two)
+#define deoxys_bc_128_128_setup_key \
+    ISA_NAME(deoxys_bc_128_128_setup_key)
+#define deoxys_bc_128_128_setup_decryption_key \
+    ISA_NAME(deoxys_bc_128_128_setup_decryption_key)
+#define deoxys_bc_128_128_encrypt \
+    ISA_NAME(deoxys_bc_128_128_encrypt)
+#define deoxys_bc_128_128_encrypt_four \
+    ISA_NAME(deoxys_bc_128_128_encrypt_four)
+#define deoxys_bc_128_128_encrypt_eight \
+    ISA_NAME(deoxys_bc_128_128_encrypt_eight)
+#define deoxys_bc_128_128_decrypt \
+    ISA_NAME(deoxys_bc_128_128_decrypt)
+#define deoxys_bc_128_128_decrypt_four \
+    ISA_NAME(deoxys_bc_128_128_decrypt_four)
+#define deoxys_bc_128_128_decrypt_eight \
+    ISA_NAME(deoxys_bc_128_128_decrypt_eight)
+#define deoxys_bc_128_256_setup_key \
+    ISA_NAME(deoxys_bc_128_256_setup_key)
+#define deoxys_bc_128_256_setup_decryption_key \
+    ISA_NAME(deoxys_bc_128_256_setup_decryption_key)
+#define deoxys_bc_128_256_encrypt \
+    ISA_NAME(deoxys_bc_128_256_encrypt)
+#define deoxys_bc_128_256_encrypt_four \
+    ISA_NAME(deoxys_bc_128_256_encrypt_four)
+#define deoxys_bc_128_256_encrypt_eight \
+    ISA_NAME(deoxys_bc_128_256_encrypt_eight)
+#define deoxys_bc_128_256_decrypt \
+    ISA_NAME(deoxys_bc_128_256_decrypt)
+#define deoxys_bc_128_256_decrypt_four \
+    ISA_NAME(deoxys_bc_128_256_decrypt_four)
+#define deoxys_bc_128_256_decrypt_eight \
+    ISA_NAME(deoxys_bc_128_256_decrypt_eight)
+
+#define gf_2_128_double_eight \
+    ISA_NAME(gf_2_128_double_eight)
+#define gf_2_128_times_four_eight \
+    ISA_NAME(gf_2_128_times_four_eight)
+#define gf_2_128_double_sixteen \
+    ISA_NAME(gf_2_128_double_sixteen)
+#define gf_2_128_times_four_sixteen \
+    ISA_NAME(gf_2_128_times_four_sixteen)
+#define gf_2_128_double_and_times_four_eight \
+    ISA_NAME(gf_2_128_double_and_times_four_eight)
+#define gf_2_128_double_and_times_four_sixteen \
+    ISA_NAME(gf_2_128_double_and_times_four_sixteen)
+#define gf_2_128_mul \
+    ISA_NAME(gf_2_128_mul)
+#define gf_2_128_times_two_power \
+    ISA_NAME(gf_2_128_times_two_power)
+#define gf_2_128_times_four_power \
+    ISA_NAME(gf_2_128_times_four_power)
+
+#define zcz_keysetup            ISA_NAME(zcz_keysetup)
+#define zcz_basic_encrypt       ISA_NAME(zcz_basic_encrypt)
+#define zcz_basic_decrypt       ISA_NAME(zcz_basic_decrypt)
+#define zcz_encrypt             ISA_NAME(zcz_encrypt)
+#define zcz_decrypt             ISA_NAME(zcz_decrypt)
+#define zcz_encrypt_many        ISA_NAME(zcz_encrypt_many)
+#define zcz_decrypt_many        ISA_NAME(zcz_decrypt_many)
+#define zcz_encrypt_recompute   ISA_NAME(zcz_encrypt_recompute)
+#define zcz_decrypt_recompute   ISA_NAME(zcz_decrypt_recompute)
+#define zcz_encrypt_parallel    ISA_NAME(zcz_encrypt_parallel)
+#define zcz_decrypt_parallel    ISA_NAME(zcz_decrypt_parallel)
+
+#endif  // ZCZ_ISA
+
+// ---------------------------------------------------------------------
+
+#endif  // _ISA_H_
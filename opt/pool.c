@@ -0,0 +1,268 @@
+/*
+// @author anonymized
+// @last-modified 2018-08
+// Copyright 2018 anonymized
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+*/
+
+// ---------------------------------------------------------------------
+
+// For pthread_setaffinity_np() and the CPU_* macros
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "pool.h"
+
+// ---------------------------------------------------------------------
+// Types
+// ---------------------------------------------------------------------
+
+struct zcz_pool_s {
+    pthread_t workers[ZCZ_POOL_MAX_NUM_THREADS];
+    size_t num_workers;
+    uint8_t* scratch;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t work_available;
+    pthread_cond_t work_done;
+
+    // The current call of zcz_pool_run(), guarded by mutex
+    zcz_task_fn task_fn;
+    uint8_t* tasks;
+    size_t task_size;
+    size_t num_tasks;
+    size_t next_task;
+    size_t num_busy_workers;
+    size_t generation;
+    int is_stopping;
+};
+
+// ---------------------------------------------------------------------
+// Static functions
+// ---------------------------------------------------------------------
+
+/**
+ * Takes tasks until none are left. Called and returns with the mutex held,
+ * but releases it while a task runs.
+ */
+static void run_tasks(zcz_pool_t* pool) {
+    while (pool->next_task < pool->num_tasks) {
+        uint8_t* task = pool->tasks + pool->next_task * pool->task_size;
+        pool->next_task++;
+
+        pthread_mutex_unlock(&(pool->mutex));
+        pool->task_fn(task);
+        pthread_mutex_lock(&(pool->mutex));
+    }
+}
+
+// ---------------------------------------------------------------------
+
+static void* run_worker(void* argument) {
+    zcz_pool_t* pool = (zcz_pool_t*)argument;
+    size_t generation = 0;
+
+    pthread_mutex_lock(&(pool->mutex));
+
+    while (1) {
+        while ((pool->generation == generation) && !pool->is_stopping) {
+            pthread_cond_wait(&(pool->work_available), &(pool->mutex));
+        }
+
+        if (pool->is_stopping) {
+            break;
+        }
+
+        generation = pool->generation;
+        run_tasks(pool);
+
+        // zcz_pool_run() returns only after every worker has seen its call
+        pool->num_busy_workers--;
+
+        if (pool->num_busy_workers == 0) {
+            pthread_cond_signal(&(pool->work_done));
+        }
+    }
+
+    pthread_mutex_unlock(&(pool->mutex));
+    return NULL;
+}
+
+/**
+ * Pins the worker to the (i + 1)-th allowed CPU. The pool works unpinned if
+ * this fails, e.g., if there are fewer CPUs than threads.
+ */
+static void pin_worker(pthread_t worker, const size_t i) {
+    cpu_set_t allowed;
+    cpu_set_t target;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed)) {
+        return;
+    }
+
+    const size_t num_allowed = (size_t)CPU_COUNT(&allowed);
+
+    if (num_allowed < 2) {
+        return;
+    }
+
+    size_t index = (i + 1) % num_allowed;
+
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+
+        if (index == 0) {
+            CPU_ZERO(&target);
+            CPU_SET(cpu, &target);
+            pthread_setaffinity_np(worker, sizeof(target), &target);
+            return;
+        }
+
+        index--;
+    }
+}
+
+// ---------------------------------------------------------------------
+// API
+// ---------------------------------------------------------------------
+
+zcz_pool_t* zcz_pool_create(const size_t num_threads) {
+    zcz_pool_t* pool = (zcz_pool_t*)calloc(1, sizeof(zcz_pool_t));
+
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&(pool->mutex), NULL);
+    pthread_cond_init(&(pool->work_available), NULL);
+    pthread_cond_init(&(pool->work_done), NULL);
+
+    size_t num_workers = (num_threads > 0) ? (num_threads - 1) : 0;
+
+    if (num_workers > ZCZ_POOL_MAX_NUM_THREADS - 1) {
+        num_workers = ZCZ_POOL_MAX_NUM_THREADS - 1;
+    }
+
+    pool->scratch = (uint8_t*)aligned_alloc(
+        ZCZ_POOL_SCRATCH_ALIGNMENT,
+        (num_workers + 1) * ZCZ_POOL_SCRATCH_SIZE);
+
+    if (pool->scratch == NULL) {
+        zcz_pool_destroy(pool);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < num_workers; ++i) {
+        if (pthread_create(&(pool->workers[i]), NULL, run_worker, pool)) {
+            zcz_pool_destroy(pool);
+            return NULL;
+        }
+
+        pool->num_workers++;
+        pin_worker(pool->workers[i], i);
+    }
+
+    return pool;
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_pool_destroy(zcz_pool_t* pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&(pool->mutex));
+    pool->is_stopping = 1;
+    pthread_cond_broadcast(&(pool->work_available));
+    pthread_mutex_unlock(&(pool->mutex));
+
+    for (size_t i = 0; i < pool->num_workers; ++i) {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&(pool->work_done));
+    pthread_cond_destroy(&(pool->work_available));
+    pthread_mutex_destroy(&(pool->mutex));
+    free(pool->scratch);
+    free(pool);
+}
+
+// ---------------------------------------------------------------------
+
+size_t zcz_pool_num_threads(const zcz_pool_t* pool) {
+    return pool->num_workers + 1;
+}
+
+// ---------------------------------------------------------------------
+
+void* zcz_pool_scratch(zcz_pool_t* pool, const size_t i) {
+    return pool->scratch + i * ZCZ_POOL_SCRATCH_SIZE;
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_pool_run(zcz_pool_t* pool,
+                  zcz_task_fn task_fn,
+                  void* tasks,
+                  const size_t task_size,
+                  const size_t num_tasks) {
+    uint8_t* task = (uint8_t*)tasks;
+
+    // Not worth waking the workers
+    if ((pool->num_workers == 0) || (num_tasks < 2)) {
+        for (size_t i = 0; i < num_tasks; ++i) {
+            task_fn(task + i * task_size);
+        }
+
+        return;
+    }
+
+    pthread_mutex_lock(&(pool->mutex));
+
+    pool->task_fn = task_fn;
+    pool->tasks = task;
+    pool->task_size = task_size;
+    pool->num_tasks = num_tasks;
+    pool->next_task = 0;
+    pool->num_busy_workers = pool->num_workers;
+    pool->generation++;
+    pthread_cond_broadcast(&(pool->work_available));
+
+    run_tasks(pool);
+
+    while (pool->num_busy_workers > 0) {
+        pthread_cond_wait(&(pool->work_done), &(pool->mutex));
+    }
+
+    pthread_mutex_unlock(&(pool->mutex));
+}
@@ -0,0 +1,102 @@
+/*
+// @author anonymized
+// @last-modified 2018-08
+// Copyright 2018 anonymized
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+*/
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include <stddef.h>
+
+// ---------------------------------------------------------------------
+// Constants
+// ---------------------------------------------------------------------
+
+#define ZCZ_POOL_MAX_NUM_THREADS   64
+
+// Bytes of scratch memory per thread, in their own cache lines
+#define ZCZ_POOL_SCRATCH_SIZE      256
+#define ZCZ_POOL_SCRATCH_ALIGNMENT 64
+
+// ---------------------------------------------------------------------
+// Types
+// ---------------------------------------------------------------------
+
+/**
+ * A fixed set of worker threads that run the tasks of one call at a time.
+ * The thread calling zcz_pool_run() works on the tasks as well, so a pool of
+ * num_threads threads has num_threads - 1 workers. The workers live as long
+ * as the pool, and each one is pinned to its own CPU where possible.
+ */
+typedef struct zcz_pool_s zcz_pool_t;
+
+typedef void (*zcz_task_fn)(void* task);
+
+// ---------------------------------------------------------------------
+// API
+// ---------------------------------------------------------------------
+
+/**
+ * Starts a pool of num_threads threads, at most ZCZ_POOL_MAX_NUM_THREADS.
+ * Worker i is pinned to the (i + 1)-th CPU that the process may run on,
+ * modulo their number. Returns NULL if the threads cannot be created.
+ */
+zcz_pool_t* zcz_pool_create(const size_t num_threads);
+
+/**
+ * Stops and joins the workers, and frees the pool.
+ */
+void zcz_pool_destroy(zcz_pool_t* pool);
+
+/**
+ * Returns the number of threads, including the calling one.
+ */
+size_t zcz_pool_num_threads(const zcz_pool_t* pool);
+
+/**
+ * Returns the ZCZ_POOL_SCRATCH_SIZE bytes of scratch memory of thread i.
+ * Passing zcz_pool_scratch(pool, 0) and ZCZ_POOL_SCRATCH_SIZE as tasks and
+ * task_size to zcz_pool_run() keeps tasks that are written concurrently in
+ * different cache lines.
+ */
+void* zcz_pool_scratch(zcz_pool_t* pool, const size_t i);
+
+/**
+ * Runs task_fn on each of the num_tasks tasks of task_size bytes at tasks,
+ * and returns when all of them are done. Must not be called concurrently on
+ * the same pool.
+ */
+void zcz_pool_run(zcz_pool_t* pool,
+                  zcz_task_fn task_fn,
+                  void* tasks,
+                  const size_t task_size,
+                  const size_t num_tasks);
+
+// ---------------------------------------------------------------------
+
+#endif  // _POOL_H_
@@ -0,0 +1,296 @@
+/*
+// @author anonymized
+// @last-modified 2018-08
+// Copyright 2018 anonymized
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+*/
+#ifndef _SOFT_NI_H_
+#define _SOFT_NI_H_
+
+// ---------------------------------------------------------------------
+// Constant-time replacements for AES-NI and PCLMULQDQ on SSSE3, for hosts
+// that lack or mask them. Each AES instruction is computed with PSHUFB
+// lookups into 16-byte tables, so no memory access depends on secret data.
+// GF(2^8) is mapped to GF(2^4)[t] / (t^2 + t + 8), where inversion needs only
+// nibble lookups and products of nibbles, which are computed on their
+// logarithms. The tables are generated and checked against the S-boxes by
+// scripts/soft-ni-tables.py.
+// ---------------------------------------------------------------------
+
+#include <stdint.h>
+#include <tmmintrin.h>
+
+#include "utils-opt.h"
+
+// ---------------------------------------------------------------------
+// Constants
+// ---------------------------------------------------------------------
+
+#define SOFT_NI_LOG \
+    setr8(0x80, 0x00, 0x01, 0x04, 0x02, 0x08, 0x05, 0x0a, \
+          0x03, 0x0e, 0x09, 0x07, 0x06, 0x0d, 0x0b, 0x0c)
+#define SOFT_NI_EXP \
+    setr8(0x01, 0x02, 0x04, 0x08, 0x03, 0x06, 0x0c, 0x0b, \
+          0x05, 0x0a, 0x07, 0x0e, 0x0f, 0x0d, 0x09, 0x00)
+#define SOFT_NI_LOG_INVERSE \
+    setr8(0x80, 0x00, 0x0e, 0x0b, 0x0d, 0x07, 0x0a, 0x05, \
+          0x0c, 0x01, 0x06, 0x08, 0x09, 0x02, 0x04, 0x03)
+#define SOFT_NI_LAMBDA_SQUARE \
+    setr8(0x00, 0x08, 0x06, 0x0e, 0x0b, 0x03, 0x0d, 0x05, \
+          0x0a, 0x02, 0x0c, 0x04, 0x01, 0x09, 0x07, 0x0f)
+#define SOFT_NI_SQUARE \
+    setr8(0x00, 0x01, 0x04, 0x05, 0x03, 0x02, 0x07, 0x06, \
+          0x0c, 0x0d, 0x08, 0x09, 0x0f, 0x0e, 0x0b, 0x0a)
+#define SOFT_NI_ENC_A_LO \
+    setr8(0x00, 0x00, 0x02, 0x02, 0x04, 0x04, 0x06, 0x06, \
+          0x04, 0x04, 0x06, 0x06, 0x00, 0x00, 0x02, 0x02)
+#define SOFT_NI_ENC_A_HI \
+    setr8(0x00, 0x03, 0x0d, 0x0e, 0x03, 0x00, 0x0e, 0x0d, \
+          0x0e, 0x0d, 0x03, 0x00, 0x0d, 0x0e, 0x00, 0x03)
+#define SOFT_NI_ENC_B_LO \
+    setr8(0x00, 0x01, 0x00, 0x01, 0x06, 0x07, 0x06, 0x07, \
+          0x0c, 0x0d, 0x0c, 0x0d, 0x0a, 0x0b, 0x0a, 0x0b)
+#define SOFT_NI_ENC_B_HI \
+    setr8(0x00, 0x0c, 0x05, 0x09, 0x04, 0x08, 0x01, 0x0d, \
+          0x05, 0x09, 0x00, 0x0c, 0x01, 0x0d, 0x04, 0x08)
+#define SOFT_NI_DEC_A_LO \
+    setr8(0x04, 0x01, 0x0d, 0x08, 0x0d, 0x08, 0x04, 0x01, \
+          0x06, 0x03, 0x0f, 0x0a, 0x0f, 0x0a, 0x06, 0x03)
+#define SOFT_NI_DEC_A_HI \
+    setr8(0x00, 0x07, 0x07, 0x00, 0x0f, 0x08, 0x08, 0x0f, \
+          0x09, 0x0e, 0x0e, 0x09, 0x06, 0x01, 0x01, 0x06)
+#define SOFT_NI_DEC_B_LO \
+    setr8(0x07, 0x0f, 0x08, 0x00, 0x0f, 0x07, 0x00, 0x08, \
+          0x0f, 0x07, 0x00, 0x08, 0x07, 0x0f, 0x08, 0x00)
+#define SOFT_NI_DEC_B_HI \
+    setr8(0x00, 0x06, 0x09, 0x0f, 0x09, 0x0f, 0x00, 0x06, \
+          0x02, 0x04, 0x0b, 0x0d, 0x0b, 0x0d, 0x02, 0x04)
+#define SOFT_NI_SBOX_P \
+    setr8(0x00, 0x52, 0x3e, 0x6c, 0x65, 0x37, 0x5b, 0x09, \
+          0x60, 0x32, 0x5e, 0x0c, 0x05, 0x57, 0x3b, 0x69)
+#define SOFT_NI_SBOX_Q \
+    setr8(0x63, 0x7c, 0xd1, 0xce, 0xc8, 0xd7, 0x7a, 0x65, \
+          0x55, 0x4a, 0xe7, 0xf8, 0xfe, 0xe1, 0x4c, 0x53)
+#define SOFT_NI_INV_SBOX_P \
+    setr8(0x00, 0xa2, 0x02, 0xa0, 0xb8, 0x1a, 0xba, 0x18, \
+          0xdb, 0x79, 0xd9, 0x7b, 0x63, 0xc1, 0x61, 0xc3)
+#define SOFT_NI_INV_SBOX_Q \
+    setr8(0x00, 0x01, 0x5c, 0x5d, 0xe0, 0xe1, 0xbc, 0xbd, \
+          0x50, 0x51, 0x0c, 0x0d, 0xb0, 0xb1, 0xec, 0xed)
+
+#define SOFT_NI_SHIFT_ROWS \
+    setr8(0x00, 0x05, 0x0a, 0x0f, 0x04, 0x09, 0x0e, 0x03, \
+          0x08, 0x0d, 0x02, 0x07, 0x0c, 0x01, 0x06, 0x0b)
+#define SOFT_NI_INV_SHIFT_ROWS \
+    setr8(0x00, 0x0d, 0x0a, 0x07, 0x04, 0x01, 0x0e, 0x0b, \
+          0x08, 0x05, 0x02, 0x0f, 0x0c, 0x09, 0x06, 0x03)
+
+// Rotate the bytes of each column by one and two rows
+#define SOFT_NI_ROTATE_ONE \
+    setr8(0x01, 0x02, 0x03, 0x00, 0x05, 0x06, 0x07, 0x04, \
+          0x09, 0x0a, 0x0b, 0x08, 0x0d, 0x0e, 0x0f, 0x0c)
+#define SOFT_NI_ROTATE_TWO \
+    setr8(0x02, 0x03, 0x00, 0x01, 0x06, 0x07, 0x04, 0x05, \
+          0x0a, 0x0b, 0x08, 0x09, 0x0e, 0x0f, 0x0c, 0x0d)
+
+#define SOFT_NI_LOW_NIBBLES     set8(0x0f)
+
+// ---------------------------------------------------------------------
+// Macros
+// ---------------------------------------------------------------------
+
+#define lookup(table, x)        _mm_shuffle_epi8(table, x)
+
+// ---------------------------------------------------------------------
+// GF(2^8) and GF(2^4) arithmetic
+// ---------------------------------------------------------------------
+
+/**
+ * Multiplies each byte by 2 in GF(2^8) of AES.
+ */
+static inline __m128i soft_ni_xtime(const __m128i x) {
+    const __m128i msb = _mm_cmplt_epi8(x, vzero);
+    return vxor(vadd8(x, x), vand(msb, set8(0x1b)));
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Adds two nibble logarithms modulo 15. The logarithm of zero is 0x80, and
+ * any sum with it keeps the MSB set, so that the following lookup yields 0.
+ */
+static inline __m128i soft_ni_add_logs(const __m128i x, const __m128i y) {
+    const __m128i sum = _mm_adds_epu8(x, y);
+    const __m128i is_wrapped = _mm_cmpgt_epi8(sum, set8(14));
+    return _mm_sub_epi8(sum, vand(is_wrapped, set8(15)));
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Inverts a * t + b in the tower field, bytewise, and maps the result back
+ * with the table pair (table_p, table_q).
+ */
+static inline __m128i soft_ni_invert(const __m128i a,
+                                     const __m128i b,
+                                     const __m128i table_p,
+                                     const __m128i table_q) {
+    const __m128i log_a = lookup(SOFT_NI_LOG, a);
+    const __m128i log_b = lookup(SOFT_NI_LOG, b);
+    const __m128i log_sum = lookup(SOFT_NI_LOG, vxor(a, b));
+
+    // delta = lambda * a^2 + a * b + b^2
+    const __m128i delta = vxor3(lookup(SOFT_NI_LAMBDA_SQUARE, a),
+                                lookup(SOFT_NI_SQUARE, b),
+                                lookup(SOFT_NI_EXP, soft_ni_add_logs(log_a,
+                                                                   log_b)));
+    const __m128i log_delta_inverse = lookup(SOFT_NI_LOG_INVERSE, delta);
+
+    // 1 / (a * t + b) = (a * t + (a + b)) / delta
+    const __m128i p = lookup(SOFT_NI_EXP,
+                             soft_ni_add_logs(log_a, log_delta_inverse));
+    const __m128i q = lookup(SOFT_NI_EXP,
+                             soft_ni_add_logs(log_sum, log_delta_inverse));
+    return vxor(lookup(table_p, p), lookup(table_q, q));
+}
+
+// ---------------------------------------------------------------------
+// AES steps
+// ---------------------------------------------------------------------
+
+static inline __m128i soft_ni_sub_bytes(const __m128i x) {
+    const __m128i low = vand(x, SOFT_NI_LOW_NIBBLES);
+    const __m128i high = vand(vshift_right(x, 4), SOFT_NI_LOW_NIBBLES);
+    const __m128i a = vxor(lookup(SOFT_NI_ENC_A_LO, low),
+                           lookup(SOFT_NI_ENC_A_HI, high));
+    const __m128i b = vxor(lookup(SOFT_NI_ENC_B_LO, low),
+                           lookup(SOFT_NI_ENC_B_HI, high));
+    return soft_ni_invert(a, b, SOFT_NI_SBOX_P, SOFT_NI_SBOX_Q);
+}
+
+// ---------------------------------------------------------------------
+
+static inline __m128i soft_ni_inv_sub_bytes(const __m128i x) {
+    const __m128i low = vand(x, SOFT_NI_LOW_NIBBLES);
+    const __m128i high = vand(vshift_right(x, 4), SOFT_NI_LOW_NIBBLES);
+    const __m128i a = vxor(lookup(SOFT_NI_DEC_A_LO, low),
+                           lookup(SOFT_NI_DEC_A_HI, high));
+    const __m128i b = vxor(lookup(SOFT_NI_DEC_B_LO, low),
+                           lookup(SOFT_NI_DEC_B_HI, high));
+    return soft_ni_invert(a, b, SOFT_NI_INV_SBOX_P, SOFT_NI_INV_SBOX_Q);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * 2 * x_i + 3 * x_{i+1} + x_{i+2} + x_{i+3} in every column.
+ */
+static inline __m128i soft_ni_mix_columns(const __m128i x) {
+    const __m128i one = lookup(x, SOFT_NI_ROTATE_ONE);
+    const __m128i two = lookup(x, SOFT_NI_ROTATE_TWO);
+    const __m128i three = lookup(one, SOFT_NI_ROTATE_TWO);
+    return vxor3(soft_ni_xtime(vxor(x, one)), one, vxor(two, three));
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * InvMixColumns is MixColumns after multiplying every column with the
+ * circulant (5, 0, 4, 0).
+ */
+static inline __m128i soft_ni_inv_mix_columns(const __m128i x) {
+    const __m128i two = lookup(x, SOFT_NI_ROTATE_TWO);
+    const __m128i four_times = soft_ni_xtime(soft_ni_xtime(vxor(x, two)));
+    return soft_ni_mix_columns(vxor(x, four_times));
+}
+
+// ---------------------------------------------------------------------
+// Instructions
+// ---------------------------------------------------------------------
+
+static inline __m128i soft_ni_aesenc(const __m128i x, const __m128i key) {
+    const __m128i state = soft_ni_sub_bytes(lookup(x, SOFT_NI_SHIFT_ROWS));
+    return vxor(soft_ni_mix_columns(state), key);
+}
+
+// ---------------------------------------------------------------------
+
+static inline __m128i soft_ni_aesenclast(const __m128i x, const __m128i key) {
+    return vxor(soft_ni_sub_bytes(lookup(x, SOFT_NI_SHIFT_ROWS)), key);
+}
+
+// ---------------------------------------------------------------------
+
+static inline __m128i soft_ni_aesdec(const __m128i x, const __m128i key) {
+    const __m128i state =
+        soft_ni_inv_sub_bytes(lookup(x, SOFT_NI_INV_SHIFT_ROWS));
+    return vxor(soft_ni_inv_mix_columns(state), key);
+}
+
+// ---------------------------------------------------------------------
+
+static inline __m128i soft_ni_aesdeclast(const __m128i x, const __m128i key) {
+    return vxor(soft_ni_inv_sub_bytes(lookup(x, SOFT_NI_INV_SHIFT_ROWS)),
+                key);
+}
+
+// ---------------------------------------------------------------------
+
+static inline __m128i soft_ni_aesimc(const __m128i x) {
+    return soft_ni_inv_mix_columns(x);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Carry-less product of one 64-bit half of x and y each, selected by bits 0
+ * and 4 of mask as in PCLMULQDQ. Masks every partial product instead of
+ * branching on the bits of y.
+ */
+static inline __m128i soft_ni_clmul(const __m128i x,
+                                    const __m128i y,
+                                    const int mask) {
+    const uint64_t a = (uint64_t)_mm_cvtsi128_si64(
+        (mask & 0x01) ? _mm_unpackhi_epi64(x, x) : x);
+    const uint64_t b = (uint64_t)_mm_cvtsi128_si64(
+        (mask & 0x10) ? _mm_unpackhi_epi64(y, y) : y);
+    uint64_t low = a & (0 - (b & 1));
+    uint64_t high = 0;
+
+    for (unsigned int i = 1; i < 64; ++i) {
+        const uint64_t bit_mask = 0 - ((b >> i) & 1);
+        low ^= (a << i) & bit_mask;
+        high ^= (a >> (64 - i)) & bit_mask;
+    }
+
+    return _mm_set_epi64x((int64_t)high, (int64_t)low);
+}
+
+// ---------------------------------------------------------------------
+
+#undef lookup
+
+#endif  // _SOFT_NI_H_
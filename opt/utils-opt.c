@@ -99,10 +99,3 @@ void print_hex_128(const char* label, const __m128i value) {
 
 // ---------------------------------------------------------------------
 
-void print_hex_256(const char* label, const __m256i value) {
-    uint8_t array[32];
-    avx_store(array, value);
-    print_hex(label, array, 32);
-}
-
-// ---------------------------------------------------------------------
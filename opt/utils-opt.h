@@ -82,7 +82,11 @@
 #define vxor3(x, y, z)      _mm_xor_si128(x, _mm_xor_si128(y, z))
 #define set32(x3, x2, x1, x0) _mm_set_epi32(x3, x2, x1, x0)
 #define set64(hi, lo)       _mm_set_epi64((__m64)(hi), (__m64)(lo))
+#ifdef __SSE4_1__
 #define vget64(x, i)        _mm_extract_epi64(x, i)
+#else
+#define vget64(x, i)        _mm_cvtsi128_si64(_mm_srli_si128(x, 8 * (i)))
+#endif
 #define vget128(y, i)       _mm256_extracti128_si256(y, i)
 #define vset128(x1, x2)     _mm256_set_epi64x(vget64(x2, 1), \
                                               vget64(x2, 0), \
@@ -101,7 +105,12 @@
 #define vshift_right_32(x, r)        _mm_srli_epi32(x, r)
 #define vshift_left_64(x, r)         _mm_slli_epi64(x, r)
 #define vshift_right_64(x, r)        _mm_srli_epi64(x, r)
+#ifdef __SSE4_1__
 #define vcompare(x, y)              !_mm_test_all_zeros(vxor(x, y), set8(0xff))
+#else
+#define vcompare(x, y) \
+    (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF)
+#endif
 
 // ---------------------------------------------------------------------
 // AVX-specific
@@ -129,6 +138,49 @@
                      x16, x17, x18, x19, x20, x21, x22, x23, \
                      x24, x25, x26, x27, x28, x29, x30, x31)
 
+// ---------------------------------------------------------------------
+// AVX-512-specific
+// Only valid in functions compiled for AVX-512F, AVX-512BW, and VAES.
+// ---------------------------------------------------------------------
+
+#define avx512_loadu(p)              _mm512_loadu_si512((const void*)(p))
+#define avx512_storeu(p, x)          _mm512_storeu_si512((void*)(p), x)
+#define avx512_add8(x, y)            _mm512_add_epi8(x, y)
+#define avx512_and(x, y)             _mm512_and_si512(x, y)
+#define avx512_or(x, y)              _mm512_or_si512(x, y)
+#define avx512_xor(x, y)             _mm512_xor_si512(x, y)
+#define avx512_xor3(x, y, z)         _mm512_xor_si512(x, _mm512_xor_si512(y, z))
+#define avx512_shift_left(x, r)      _mm512_slli_epi16(x, r)
+#define avx512_shift_right(x, r)     _mm512_srli_epi16(x, r)
+#define avx512_zero                  _mm512_setzero_si512()
+#define avx512_set8(x)               _mm512_set1_epi8(x)
+#define avx512_set64(x7, x6, x5, x4, x3, x2, x1, x0) \
+    _mm512_set_epi64(x7, x6, x5, x4, x3, x2, x1, x0)
+#define avx512_broadcast128(x)       _mm512_broadcast_i32x4(x)
+
+#define avx512_aesenc(x, y)          _mm512_aesenc_epi128(x, y)
+#define avx512_aesenclast(x, y)      _mm512_aesenclast_epi128(x, y)
+#define avx512_aesdec(x, y)          _mm512_aesdec_epi128(x, y)
+#define avx512_aesdeclast(x, y)      _mm512_aesdeclast_epi128(x, y)
+
+// ---------------------------------------------------------------------
+
+#define avx512_load_four(p, x) { \
+    p[0] = avx512_loadu(x); \
+    p[1] = avx512_loadu(x+4); \
+    p[2] = avx512_loadu(x+8); \
+    p[3] = avx512_loadu(x+12); \
+}
+
+// ---------------------------------------------------------------------
+
+#define avx512_store_four(p, x) { \
+    avx512_storeu(p, x[0]); \
+    avx512_storeu(p+4, x[1]); \
+    avx512_storeu(p+8, x[2]); \
+    avx512_storeu(p+12, x[3]); \
+}
+
 // ---------------------------------------------------------------------
 
 #define avx_load_two(p, x) { \
@@ -228,12 +280,31 @@
 // AES
 // ---------------------------------------------------------------------
 
+// The SSSE3 variant is built without AES-NI and PCLMULQDQ and computes them
+// in constant-time software instead.
+#if !defined(__AES__) || !defined(__PCLMUL__)
+#include "soft-ni.h"
+#endif
+
+#ifdef __AES__
 #define vaesenc(x, y)       _mm_aesenc_si128(x, y)
 #define vaesenclast(x, y)   _mm_aesenclast_si128(x, y)
 #define vaesdec(x, y)       _mm_aesdec_si128(x, y)
 #define vaesdeclast(x, y)   _mm_aesdeclast_si128(x, y)
 #define vinversemc(x)       _mm_aesimc_si128(x)
+#else
+#define vaesenc(x, y)       soft_ni_aesenc(x, y)
+#define vaesenclast(x, y)   soft_ni_aesenclast(x, y)
+#define vaesdec(x, y)       soft_ni_aesdec(x, y)
+#define vaesdeclast(x, y)   soft_ni_aesdeclast(x, y)
+#define vinversemc(x)       soft_ni_aesimc(x)
+#endif
+
+#ifdef __PCLMUL__
 #define clmul(x, y, mask)   _mm_clmulepi64_si128(x, y, mask)
+#else
+#define clmul(x, y, mask)   soft_ni_clmul(x, y, mask)
+#endif
 
 // ---------------------------------------------------------------------
 // API
@@ -245,12 +316,19 @@ void store_partial(const void *p, __m128i x, size_t n);
 
 void print_hex_128(const char* label, const __m128i value);
 
-void print_hex_256(const char* label, const __m256i value);
-
 void print_hex(const char* label,
                const uint8_t* array,
                const size_t num_bytes);
 
+#ifdef __AVX2__
+// Inline, so that utils-opt.c stays within the SSSE3 baseline.
+static inline void print_hex_256(const char* label, const __m256i value) {
+    uint8_t array[32];
+    avx_store(array, value);
+    print_hex(label, array, 32);
+}
+#endif
+
 // ---------------------------------------------------------------------
 
 #endif  // _UTILS_OPT_H_
@@ -40,6 +40,77 @@
 #include "utils-opt.h"
 #include "deoxysbc.h"
 #include "zcz.h"
+#include "dispatch.h"
+
+#ifdef ZCZ_STATS
+#include <x86intrin.h>
+#endif
+
+// ---------------------------------------------------------------------
+// Types
+// ---------------------------------------------------------------------
+
+/**
+ * Intermediate values of a single encryption or decryption call. They are
+ * kept on the stack of the call, so that the context stays read-only and
+ * can be shared by concurrent calls.
+ */
+ALIGN(16)
+typedef struct {
+    __m128i s;
+    __m128i t;
+    __m128i x_l;
+    __m128i x_r;
+    __m128i y_l;
+    __m128i y_r;
+} zcz_values_t;
+
+/**
+ * One thread's share of a layer: a range of di-blocks, and the hash values
+ * over only that range.
+ */
+ALIGN(16)
+typedef struct {
+    const zcz_ctx_t* ctx;
+    const zcz_values_t* values;
+    uint8_t* target;
+    const uint8_t* source;
+    size_t first_di_block;
+    size_t num_di_blocks;
+    __m128i hash_l;
+    __m128i hash_r;
+} zcz_range_task_t;
+
+_Static_assert(sizeof(zcz_range_task_t) <= ZCZ_POOL_SCRATCH_SIZE,
+               "A range task must fit into the scratch memory of a thread");
+
+// ---------------------------------------------------------------------
+// Statistics
+// ---------------------------------------------------------------------
+
+// In ZCZ_STATS builds, stats_record() adds the cycles since t to the given
+// phase of ctx->stats and restarts t. Otherwise, all of them vanish.
+#ifdef ZCZ_STATS
+#define stats_start(t)     uint64_t t = __rdtsc()
+#define stats_restart(t)   t = __rdtsc()
+#define stats_record(ctx, phase, t) { \
+    if ((ctx)->stats != NULL) { \
+        const uint64_t now = __rdtsc(); \
+        (ctx)->stats->cycles[phase] += now - t; \
+        t = now; \
+    } \
+}
+#define stats_count(ctx) { \
+    if ((ctx)->stats != NULL) { \
+        (ctx)->stats->num_calls++; \
+    } \
+}
+#else
+#define stats_start(t)
+#define stats_restart(t)
+#define stats_record(ctx, phase, t)
+#define stats_count(ctx)
+#endif  // ZCZ_STATS
 
 // ---------------------------------------------------------------------
 // Length functions
@@ -76,15 +147,40 @@ static size_t get_num_chunks(const size_t num_di_blocks) {
         / (ZCZ_NUM_DI_BLOCKS_IN_CHUNK));
 }
 
+// ---------------------------------------------------------------------
+
+/**
+ * Returns how many of the next num_di_blocks di-blocks, starting at
+ * tweak_counter, can share one base in the multi-block kernels.
+ */
+static size_t get_num_di_blocks_until_rebase(const size_t tweak_counter,
+                                             const size_t num_di_blocks) {
+    const size_t num_until_rebase = DEOXYS_BC_NUM_COUNTERS_PER_BASE
+        - (tweak_counter % DEOXYS_BC_NUM_COUNTERS_PER_BASE);
+
+    if (num_di_blocks < num_until_rebase) {
+        return num_di_blocks;
+    }
+
+    return num_until_rebase;
+}
+
 // ---------------------------------------------------------------------
 // Scheme functions
 // ---------------------------------------------------------------------
 
 static inline void vxor_di_block(uint8_t in_out[ZCZ_NUM_BYTES_IN_DI_BLOCK],
                                  const uint8_t b[ZCZ_NUM_BYTES_IN_DI_BLOCK]) {
+#ifdef __AVX2__
     const __m256i x = avx_loadu(in_out);
     const __m256i y = avx_loadu(b);
     avx_storeu(in_out, avx_xor(x, y));
+#else
+    storeu(in_out, vxor(loadu(in_out), loadu(b)));
+    storeu((in_out + ZCZ_NUM_BYTES_IN_BLOCK),
+           vxor(loadu((in_out + ZCZ_NUM_BYTES_IN_BLOCK)),
+                loadu((b + ZCZ_NUM_BYTES_IN_BLOCK))));
+#endif
 }
 
 // ---------------------------------------------------------------------
@@ -107,34 +203,196 @@ static void pad_message(uint8_t* target,
 
 // ---------------------------------------------------------------------
 
-static void hash(zcz_ctx_t* ctx,
+static void hash(const zcz_ctx_t* ctx,
                  const uint8_t* input,
                  uint8_t* output,
                  const size_t domain) {
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
+    const deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
+
+    const __m128i u = loadu(input);
+    const __m128i v = loadu((input + ZCZ_NUM_BYTES_IN_BLOCK));
+
+    // u' = E_K^{p, domain, v}(u) and v' = E_K^{p, domain + 1, v}(u)
+    const uint8_t domains[2] = { ZCZ_DOMAIN_PARTIAL, ZCZ_DOMAIN_PARTIAL };
+    const size_t counters[2] = { domain, domain + 1 };
+    const __m128i tweaks[2] = { v, v };
+    __m128i states[2] = { u, u };
+
+    deoxys_bc_128_384_encrypt_batch(cipher_ctx,
+                                    2,
+                                    domains,
+                                    counters,
+                                    tweaks,
+                                    states);
+
+    storeu(output, states[0]);
+    storeu((output + ZCZ_NUM_BYTES_IN_BLOCK), states[1]);
+}
 
-    __m128i u = loadu(input);
-    __m128i v = loadu((input + ZCZ_NUM_BYTES_IN_BLOCK));
+// ---------------------------------------------------------------------
 
-    __m128i u_prime;
-    __m128i v_prime;
+/**
+ * Finalizes a pair of hash values: left = E_K^{left_domain, n, r}(l) and
+ * right = E_K^{right_domain, n, l}(r). Both are independent, so they run in
+ * one batch.
+ */
+static void encrypt_hash_pair(const zcz_ctx_t* ctx,
+                              const uint8_t left_domain,
+                              const uint8_t right_domain,
+                              const size_t num_di_blocks,
+                              const __m128i l,
+                              const __m128i r,
+                              __m128i* left,
+                              __m128i* right) {
+    const uint8_t domains[2] = { left_domain, right_domain };
+    const size_t counters[2] = { num_di_blocks, num_di_blocks };
+    const __m128i tweaks[2] = { r, l };
+    __m128i states[2] = { l, r };
+
+    deoxys_bc_128_384_encrypt_batch(&(ctx->cipher_ctx),
+                                    2,
+                                    domains,
+                                    counters,
+                                    tweaks,
+                                    states);
+    *left = states[0];
+    *right = states[1];
+}
 
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_PARTIAL,
-                              domain,
-                              v,
-                              u,
-                              &u_prime);
+// ---------------------------------------------------------------------
 
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_PARTIAL,
-                              domain + 1,
-                              v,
-                              u,
-                              &v_prime);
+/**
+ * Returns the base of the given domain for the window of counters that
+ * contains tweak_counter. The first window is precomputed in the context,
+ * later ones are set up in the given buffer.
+ */
+static const deoxys_bc_128_384_base_t* rebase(
+    const zcz_ctx_t* ctx,
+    const deoxys_bc_128_384_base_t* first_base,
+    deoxys_bc_128_384_base_t* buffer,
+    const uint8_t domain,
+    const size_t tweak_counter) {
+    if (tweak_counter < DEOXYS_BC_NUM_COUNTERS_PER_BASE) {
+        return first_base;
+    }
+
+    deoxys_bc_128_384_setup_base_counters(&(ctx->cipher_ctx),
+                                          buffer,
+                                          domain,
+                                          tweak_counter);
+    return buffer;
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Computes S_i = E_K^{s, 0, i}(S) for the chunks i = first_chunk + 1 ..
+ * first_chunk + num_chunks, num_chunks <= DEOXYS_BC_MAX_BATCH_SIZE, in one
+ * batch.
+ */
+static void encrypt_s_batch(const zcz_ctx_t* ctx,
+                            const __m128i s,
+                            const size_t first_chunk,
+                            const size_t num_chunks,
+                            __m128i s_i[DEOXYS_BC_MAX_BATCH_SIZE]) {
+    uint8_t domains[DEOXYS_BC_MAX_BATCH_SIZE];
+    size_t counters[DEOXYS_BC_MAX_BATCH_SIZE];
+    __m128i tweaks[DEOXYS_BC_MAX_BATCH_SIZE];
+
+    for (size_t j = 0; j < num_chunks; ++j) {
+        domains[j] = ZCZ_DOMAIN_S;
+        counters[j] = 0;
+        tweaks[j] = set64(first_chunk + j + 1, 0L);
+        s_i[j] = s;
+    }
+
+    deoxys_bc_128_384_encrypt_batch(&(ctx->cipher_ctx),
+                                    num_chunks,
+                                    domains,
+                                    counters,
+                                    tweaks,
+                                    s_i);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Encrypts num_blocks <= 8 blocks, with counters tweak_counter ..
+ * tweak_counter + num_blocks - 1, in a single call of the narrowest
+ * multi-block kernel that covers them. Unused lanes are zeroized and ignored.
+ * A single block is latency-bound anyway and takes the one-block cipher.
+ */
+static void encrypt_tail(const zcz_ctx_t* ctx,
+                         const uint8_t domain,
+                         const deoxys_bc_128_384_base_t* base,
+                         const size_t tweak_counter,
+                         const size_t num_blocks,
+                         __m128i tweaks[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE],
+                         __m128i states[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE]) {
+    for (size_t j = num_blocks; j < ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE; ++j) {
+        tweaks[j] = vzero;
+        states[j] = vzero;
+    }
+
+    if (num_blocks == 1) {
+        deoxys_bc_128_384_encrypt(&(ctx->cipher_ctx),
+                                  domain,
+                                  tweak_counter,
+                                  tweaks[0],
+                                  states[0],
+                                  states);
+    } else if (num_blocks > 4) {
+        deoxys_bc_128_384_encrypt_eight_eight(base,
+                                              tweak_counter,
+                                              tweaks,
+                                              states);
+    } else if (num_blocks > 2) {
+        deoxys_bc_128_384_encrypt_four_four(base,
+                                            tweak_counter,
+                                            tweaks,
+                                            states);
+    } else {
+        deoxys_bc_128_384_encrypt_two(base, tweak_counter, tweaks, states);
+    }
+}
+
+// ---------------------------------------------------------------------
 
-    storeu(output, u_prime);
-    storeu((output + ZCZ_NUM_BYTES_IN_BLOCK), v_prime);
+/**
+ * Decryption counterpart of encrypt_tail().
+ */
+static void decrypt_tail(const zcz_ctx_t* ctx,
+                         const uint8_t domain,
+                         const deoxys_bc_128_384_base_t* base,
+                         const size_t tweak_counter,
+                         const size_t num_blocks,
+                         __m128i tweaks[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE],
+                         __m128i states[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE]) {
+    for (size_t j = num_blocks; j < ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE; ++j) {
+        tweaks[j] = vzero;
+        states[j] = vzero;
+    }
+
+    if (num_blocks == 1) {
+        deoxys_bc_128_384_decrypt(&(ctx->cipher_ctx),
+                                  domain,
+                                  tweak_counter,
+                                  tweaks[0],
+                                  states[0],
+                                  states);
+    } else if (num_blocks > 4) {
+        deoxys_bc_128_384_decrypt_eight_eight(base,
+                                              tweak_counter,
+                                              tweaks,
+                                              states);
+    } else if (num_blocks > 2) {
+        deoxys_bc_128_384_decrypt_four_four(base,
+                                            tweak_counter,
+                                            tweaks,
+                                            states);
+    } else {
+        deoxys_bc_128_384_decrypt_two(base, tweak_counter, tweaks, states);
+    }
 }
 
 // ---------------------------------------------------------------------
@@ -204,754 +462,1371 @@ static void hash(zcz_ctx_t* ctx,
 
 // ---------------------------------------------------------------------
 
-static void encrypt_until(zcz_ctx_t* ctx,
-                          uint8_t* target,
-                          const uint8_t* source,
-                          const size_t num_di_blocks) {
-    __m128i states[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
-    __m128i tweaks[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
+#define load_sixteen_blocks(states, source) { \
+    load_eight_blocks(states, source); \
+    load_eight_blocks((states + 8), (source + 16)); \
+}
+
+// ---------------------------------------------------------------------
+
+#define store_sixteen_blocks(target, states) { \
+    store_eight_blocks(target, states); \
+    store_eight_blocks((target + 16), (states + 8)); \
+}
+
+// ---------------------------------------------------------------------
+
+#define vxor_sixteen(x, y, z) { \
+    vxor_eight(x, y, z); \
+    vxor_eight((x + 8), (y + 8), (z + 8)); \
+}
+
+// ---------------------------------------------------------------------
+
+#define vxor_sixteen_same_x(x, y, z) { \
+    vxor_eight_same_x(x, y, z); \
+    vxor_eight_same_x(x, (y + 8), (z + 8)); \
+}
+
+// ---------------------------------------------------------------------
+
+#define set_sixteen_blocks_same_x(x, y) { \
+    set_eight_blocks_same_x(x, y); \
+    set_eight_blocks_same_x(x, (y + 8)); \
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Top layer on num_di_blocks di-blocks that follow the first first_di_block
+ * ones of the message. Writes X_i || R_i to target and updates the hash
+ * values X_L and X_R.
+ */
+static void encrypt_top_di_blocks(const zcz_ctx_t* ctx,
+                                  uint8_t* target,
+                                  const uint8_t* source,
+                                  const size_t first_di_block,
+                                  const size_t num_di_blocks,
+                                  __m128i* hash_x_l,
+                                  __m128i* hash_x_r) {
+    __m128i states[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
+    __m128i tweaks[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
     __m128i* source_position = (__m128i*)source;
     __m128i* target_position = (__m128i*)target;
 
     size_t num_di_blocks_remaining = num_di_blocks;
-    size_t tweak_counter = 0;
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
-
-    // Zeroize the hash values X_L and X_R at the beginning
-    __m128i x_l = vzero;
-    __m128i x_r = vzero;
-    __m128i tmp;
+    size_t tweak_counter = first_di_block + 1;
 
-    deoxys_bc_128_384_setup_base_counters(cipher_ctx,
-                                          ZCZ_DOMAIN_TOP,
-                                          tweak_counter);
+    const deoxys_bc_128_384_base_t* base;
+    deoxys_bc_128_384_base_t rebased;
 
-    tweak_counter = 1;
+    __m128i x_l = *hash_x_l;
+    __m128i x_r = *hash_x_r;
+    __m128i tmp;
 
     // ---------------------------------------------------------------------
-    // Next 8 di-blocks
+    // One window of counters per base, so that no sequence straddles two
     // ---------------------------------------------------------------------
 
-    while (num_di_blocks_remaining > ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE) {
-        load_eight_blocks(states, source_position);        // L_1 .. L_8
-        load_eight_blocks(tweaks, (source_position + 1));  // R_1 .. R_8
-
-        // Obtain the values X_i in states
-        deoxys_bc_128_384_encrypt_eight_eight(cipher_ctx,
+    while (num_di_blocks_remaining > 0) {
+        size_t num_di_blocks_in_window =
+            get_num_di_blocks_until_rebase(tweak_counter,
+                                           num_di_blocks_remaining);
+        num_di_blocks_remaining -= num_di_blocks_in_window;
+        base = rebase(ctx,
+                      &(ctx->top_base),
+                      &rebased,
+                      ZCZ_DOMAIN_TOP,
+                      tweak_counter);
+
+        // -----------------------------------------------------------------
+        // Next 16 di-blocks, in the VAES/AVX-512 and bitsliced AVX2 builds
+        // -----------------------------------------------------------------
+
+#ifdef DEOXYS_BC_SIXTEEN_ENABLED
+        while (num_di_blocks_in_window
+            >= ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE) {
+            load_sixteen_blocks(states, source_position);        // L_1 .. L_16
+            load_sixteen_blocks(tweaks, (source_position + 1));  // R_1 .. R_16
+
+            deoxys_bc_128_384_encrypt_sixteen(base,
                                               tweak_counter,
                                               tweaks,
                                               states);
 
-        // Copy the values X_i to the buffer
-        store_eight_blocks(target_position, states);        // Copy the X_i's
-        store_eight_blocks((target_position + 1), tweaks);  // Copy the R_i's
+            store_sixteen_blocks(target_position, states);
+            store_sixteen_blocks((target_position + 1), tweaks);
+
+            vxor_sixteen(states, tweaks, tweaks);
+            gf_2_128_double_and_times_four_sixteen(&x_l, &x_r, states, tweaks);
+
+            num_di_blocks_in_window -= ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE;
+            target_position += ZCZ_NUM_BLOCKS_PER_WIDE_SEQUENCE;
+            source_position += ZCZ_NUM_BLOCKS_PER_WIDE_SEQUENCE;
+            tweak_counter += ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE;
+        }
+#endif  // DEOXYS_BC_SIXTEEN_ENABLED
+
+        // -----------------------------------------------------------------
+        // Next 8 di-blocks
+        // -----------------------------------------------------------------
+
+        while (num_di_blocks_in_window >= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE) {
+            load_eight_blocks(states, source_position);        // L_1 .. L_8
+            load_eight_blocks(tweaks, (source_position + 1));  // R_1 .. R_8
+
+            // Obtain the values X_i in states
+            deoxys_bc_128_384_encrypt_eight_eight(base,
+                                                  tweak_counter,
+                                                  tweaks,
+                                                  states);
+
+            // Copy the values X_i to the buffer
+            store_eight_blocks(target_position, states);        // The X_i's
+            store_eight_blocks((target_position + 1), tweaks);  // The R_i's
+
+            // tweaks[i] = X_i xor R_i
+            // Update X_L = X_L * 2^8 xor X_1 * 2^7 xor ... X_7 * 2 xor X_8
+            // Update X_R = X_R * (4)^8 xor X_1 * 4^7 xor ... X_7 * 4 xor X_8
+            vxor_eight(states, tweaks, tweaks);
+            gf_2_128_double_and_times_four_eight(&x_l, &x_r, states, tweaks);
+
+            num_di_blocks_in_window -= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;
+            target_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks
+            source_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks
+            tweak_counter += ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // Tweak += 8
+        }
+
+        // -----------------------------------------------------------------
+        // Tail: 0..7 di-blocks, in one padded call of a 2-, 4- or 8-block
+        // kernel
+        // -----------------------------------------------------------------
 
-        // Update X_L = X_L * 2^8 xor X_1 * 2^7 xor ... X_7 * 2 xor X_8
-        x_l = gf_2_128_double_eight(x_l, states);
+        if (num_di_blocks_in_window > 0) {
+            for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                states[j] = load(source_position);
+                tweaks[j] = load((source_position + 1));
+                source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
+            }
+
+            encrypt_tail(ctx,
+                         ZCZ_DOMAIN_TOP,
+                         base,
+                         tweak_counter,
+                         num_di_blocks_in_window,
+                         tweaks,
+                         states);
+
+            for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                // Copy X_i || R_i to the buffer
+                store(target_position, states[j]);
+                store((target_position + 1), tweaks[j]);
+
+                // Update X_L
+                gf_2_128_double(x_l, x_l, tmp);
+                x_l = vxor(x_l, states[j]);
 
-        // states[i] = X_i xor R_i
-        // Update X_R = X_R * (4)^8 xor X_1 * 4^7 xor ... X_7 * 4 xor X_8
-        vxor_eight(states, tweaks, states);
+                // Update X_R
+                gf_2_128_times_four(x_r, x_r, tmp);
+                x_r = vxor3(x_r, states[j], tweaks[j]);
 
-        x_r = gf_2_128_times_four_eight(x_r, states);
+                target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
+            }
 
-        num_di_blocks_remaining -= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // We used 8
-        target_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks further
-        source_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks further
-        tweak_counter += ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // Tweak += 8
+            tweak_counter += num_di_blocks_in_window;
+        }
     }
 
-    // ---------------------------------------------------------------------
-    // Tail: 0..7 di-blocks
-    // ---------------------------------------------------------------------
+    *hash_x_l = x_l;
+    *hash_x_r = x_r;
+}
 
-    while (num_di_blocks_remaining > 1) {
-        states[0] = load(source_position);
-        tweaks[0] = load((source_position + 1));
+// ---------------------------------------------------------------------
+// Parallel functions
+// ---------------------------------------------------------------------
 
-        deoxys_bc_128_384_encrypt(cipher_ctx,
-                                  ZCZ_DOMAIN_TOP,
-                                  tweak_counter,
-                                  tweaks[0],
-                                  states[0],
-                                  states);
+/**
+ * Returns the task of thread i, which lives in its scratch memory.
+ */
+static zcz_range_task_t* get_range_task(zcz_pool_t* pool, const size_t i) {
+    return (zcz_range_task_t*)zcz_pool_scratch(pool, i);
+}
+
+// ---------------------------------------------------------------------
 
-        // Copy X_i || R_i to the buffer
-        store(target_position, states[0]);
-        store((target_position + 1), tweaks[0]);
+/**
+ * Splits the first num_di_blocks di-blocks into at most one range per thread
+ * of the pool, and at least ZCZ_PARALLEL_MIN_NUM_CHUNKS_PER_THREAD chunks per
+ * range. Ranges start at chunk boundaries, and their hash values start at
+ * zero. Returns the number of ranges.
+ */
+static size_t split_into_range_tasks(const zcz_ctx_t* ctx,
+                                     zcz_pool_t* pool,
+                                     const zcz_values_t* values,
+                                     uint8_t* target,
+                                     const uint8_t* source,
+                                     const size_t num_di_blocks) {
+    const size_t num_chunks = get_num_chunks(num_di_blocks);
+    size_t num_tasks = zcz_pool_num_threads(pool);
+    size_t first_chunk = 0;
+
+    if (num_tasks > num_chunks / ZCZ_PARALLEL_MIN_NUM_CHUNKS_PER_THREAD) {
+        num_tasks = num_chunks / ZCZ_PARALLEL_MIN_NUM_CHUNKS_PER_THREAD;
+    }
 
-        // Update X_L
-        gf_2_128_double(x_l, x_l, tmp);
-        x_l = vxor(x_l, states[0]);
+    if ((num_tasks == 0) && (num_chunks > 0)) {
+        num_tasks = 1;
+    }
 
-        // Update X_R
-        gf_2_128_times_four(x_r, x_r, tmp);
+    for (size_t i = 0; i < num_tasks; ++i) {
+        const size_t end_chunk = ((i + 1) * num_chunks) / num_tasks;
+        const size_t first_di_block = first_chunk * ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
+        size_t end_di_block = end_chunk * ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
 
-        x_r = vxor3(x_r, states[0], tweaks[0]);
+        if (end_di_block > num_di_blocks) {
+            end_di_block = num_di_blocks;
+        }
 
-        num_di_blocks_remaining -= 1;  // We used 32 bytes
-        target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;  // 2 blocks further
-        source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;  // 2 blocks further
-        tweak_counter += 1;
+        zcz_range_task_t* task = get_range_task(pool, i);
+
+        task->ctx = ctx;
+        task->values = values;
+        task->target = target + first_di_block * ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        task->source = source + first_di_block * ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        task->first_di_block = first_di_block;
+        task->num_di_blocks = end_di_block - first_di_block;
+        task->hash_l = vzero;
+        task->hash_r = vzero;
+        first_chunk = end_chunk;
     }
 
-    // ---------------------------------------------------------------------
-    // Process X_L and X_R.
-    // Note: This destroys the previous round tweaks
-    // ---------------------------------------------------------------------
+    return num_tasks;
+}
 
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_XL,
-                              num_di_blocks,
-                              x_r,
-                              x_l,
-                              &(ctx->x_l));
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_XR,
-                              num_di_blocks,
-                              x_l,
-                              x_r,
-                              &(ctx->x_r));
+// ---------------------------------------------------------------------
+
+/**
+ * Combines the hash values of the ranges in order. For a range of k
+ * di-blocks with the sums H_L' and H_R', H_L = H_L * 2^{k} xor H_L' if the
+ * left hash doubles per di-block, and H_L = H_L * 4^{k} xor H_L' if it
+ * multiplies by four; the right hash always uses the other one.
+ */
+static void combine_range_hashes(zcz_pool_t* pool,
+                                 const size_t num_tasks,
+                                 const int is_left_doubled,
+                                 __m128i* hash_l,
+                                 __m128i* hash_r) {
+    __m128i h_l = *hash_l;
+    __m128i h_r = *hash_r;
+
+    for (size_t i = 0; i < num_tasks; ++i) {
+        const zcz_range_task_t* task = get_range_task(pool, i);
+        const size_t k = task->num_di_blocks;
+
+        if (is_left_doubled) {
+            h_l = gf_2_128_times_two_power(h_l, k);
+            h_r = gf_2_128_times_four_power(h_r, k);
+        } else {
+            h_l = gf_2_128_times_four_power(h_l, k);
+            h_r = gf_2_128_times_two_power(h_r, k);
+        }
+
+        h_l = vxor(h_l, task->hash_l);
+        h_r = vxor(h_r, task->hash_r);
+    }
+
+    *hash_l = h_l;
+    *hash_r = h_r;
+}
+
+// ---------------------------------------------------------------------
+
+static void encrypt_top_task(void* argument) {
+    zcz_range_task_t* task = (zcz_range_task_t*)argument;
+    encrypt_top_di_blocks(task->ctx,
+                          task->target,
+                          task->source,
+                          task->first_di_block,
+                          task->num_di_blocks,
+                          &(task->hash_l),
+                          &(task->hash_r));
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * encrypt_top_di_blocks() on the first num_di_blocks di-blocks, split across
+ * the threads of the pool. Each range is hashed from zero, and the Horner
+ * sums of the ranges are combined afterwards.
+ */
+static void encrypt_top_di_blocks_parallel(const zcz_ctx_t* ctx,
+                                           zcz_pool_t* pool,
+                                           uint8_t* target,
+                                           const uint8_t* source,
+                                           const size_t num_di_blocks,
+                                           __m128i* hash_x_l,
+                                           __m128i* hash_x_r) {
+    const size_t num_tasks = split_into_range_tasks(ctx,
+                                                    pool,
+                                                    NULL,
+                                                    target,
+                                                    source,
+                                                    num_di_blocks);
+
+    zcz_pool_run(pool,
+                 encrypt_top_task,
+                 zcz_pool_scratch(pool, 0),
+                 ZCZ_POOL_SCRATCH_SIZE,
+                 num_tasks);
+    combine_range_hashes(pool, num_tasks, 1, hash_x_l, hash_x_r);
 }
 
 // ---------------------------------------------------------------------
 // Encryption component functions
 // ---------------------------------------------------------------------
 
-static void encrypt_top_layer(zcz_ctx_t* ctx,
+/**
+ * Runs on the threads of the pool, or on the calling one if pool is NULL.
+ */
+static void encrypt_top_layer(const zcz_ctx_t* ctx,
+                              zcz_pool_t* pool,
+                              zcz_values_t* values,
                               uint8_t* state,
                               const uint8_t* plaintext,
                               const size_t num_di_blocks) {
-    deoxys_bc_128_384_setup_base_counters(&(ctx->cipher_ctx),
-                                          ZCZ_DOMAIN_TOP,
-                                          0);
-    encrypt_until(ctx, state, plaintext, num_di_blocks);
+    // Zeroize the hash values X_L and X_R at the beginning
+    __m128i x_l = vzero;
+    __m128i x_r = vzero;
+
+    // The final di-block is processed separately
+    if (pool != NULL) {
+        encrypt_top_di_blocks_parallel(ctx,
+                                       pool,
+                                       state,
+                                       plaintext,
+                                       num_di_blocks - 1,
+                                       &x_l,
+                                       &x_r);
+    } else {
+        encrypt_top_di_blocks(ctx,
+                              state,
+                              plaintext,
+                              0,
+                              num_di_blocks - 1,
+                              &x_l,
+                              &x_r);
+    }
+
+    // ---------------------------------------------------------------------
+    // Process X_L and X_R.
+    // ---------------------------------------------------------------------
+
+    encrypt_hash_pair(ctx,
+                      ZCZ_DOMAIN_XL,
+                      ZCZ_DOMAIN_XR,
+                      num_di_blocks,
+                      x_l,
+                      x_r,
+                      &(values->x_l),
+                      &(values->x_r));
 }
 
 // ---------------------------------------------------------------------
 
-static void encrypt_middle_layer(zcz_ctx_t* ctx,
-                                 uint8_t* state,
-                                 const size_t num_di_blocks) {
-    __m128i tweak;
+/**
+ * Middle and bottom layers on num_di_blocks di-blocks X_i || R_i in state,
+ * which follow the first first_di_block ones of the message, a multiple of
+ * ZCZ_NUM_DI_BLOCKS_IN_CHUNK. Updates the hash values Y_L and Y_R.
+ */
+static void encrypt_middle_and_bottom_di_blocks(const zcz_ctx_t* ctx,
+                                                const zcz_values_t* values,
+                                                uint8_t* state,
+                                                const size_t first_di_block,
+                                                const size_t num_di_blocks,
+                                                __m128i* hash_y_l,
+                                                __m128i* hash_y_r) {
     __m128i* source_position = (__m128i*)state;
     __m128i* target_position = (__m128i*)state;
 
-    size_t num_di_blocks_without_final = num_di_blocks;
-
-    if (num_di_blocks > 0) {
-        num_di_blocks_without_final--;
-    }
-
-    const size_t num_chunks = get_num_chunks(num_di_blocks_without_final);
-    size_t k = 1;
-    size_t tweak_counter = 0;
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
-
-    // ---------------------------------------------------------------------
-    // Zeroize the hash values Y_L and Y_R at the beginning
-    // ---------------------------------------------------------------------
+    const size_t first_chunk = first_di_block / ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
+    const size_t end_chunk = first_chunk + get_num_chunks(num_di_blocks);
+    size_t k = first_di_block + 1;
 
     __m128i s_i;
-    __m128i l_i;
+    __m128i s_batch[DEOXYS_BC_MAX_BATCH_SIZE];
     __m128i r_i;
 
-    __m128i x_i[8];
-    __m128i y_i[8];
-    __m128i z_i_j[8];
+    __m128i x_i[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
+    __m128i y_i[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
+    __m128i z_i_j[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
+    __m128i t_blocks[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
 
-    __m128i y_l = vzero;
-    __m128i y_r = vzero;
+    __m128i y_l = *hash_y_l;
+    __m128i y_r = *hash_y_r;
     __m128i tmp;
 
+    deoxys_bc_128_384_base_t rebased_center;
+    deoxys_bc_128_384_base_t rebased_bottom;
+    deoxys_bc_128_384_base_t middle_base;
+
+    const deoxys_bc_128_384_base_t* center_base = rebase(ctx,
+                                                         &(ctx->center_base),
+                                                         &rebased_center,
+                                                         ZCZ_DOMAIN_CENTER,
+                                                         k);
+    const deoxys_bc_128_384_base_t* bottom_base = rebase(ctx,
+                                                         &(ctx->bottom_base),
+                                                         &rebased_bottom,
+                                                         ZCZ_DOMAIN_BOT,
+                                                         k);
+
     // ---------------------------------------------------------------------
-    // Init domain and base counter
+    // Add T to the precomputed base of the center domain. T is the same for
+    // all chunks, so this is needed only once per window of counters.
     // ---------------------------------------------------------------------
 
-    deoxys_bc_128_384_setup_base_counters(&(ctx->cipher_ctx), ZCZ_DOMAIN_S, 0);
+    deoxys_bc_128_384_setup_middle_base(&middle_base,
+                                        center_base,
+                                        values->t);
 
     // ---------------------------------------------------------------------
     // Compute S_i
     // ---------------------------------------------------------------------
 
-    for (size_t i = 0; i < num_chunks; ++i) {
-        tweak = set64(i+1, 0L);
-
+    for (size_t i = first_chunk; i < end_chunk; ++i) {
         // ---------------------------------------------------------------------
-        // Compute S_i = E_K^{s, 0, i}(S)
+        // Compute S_i = E_K^{s, 0, i}(S) for the next up to 8 chunks at once
         // ---------------------------------------------------------------------
 
-        deoxys_bc_128_384_encrypt(cipher_ctx,
-                                  ZCZ_DOMAIN_S,
-                                  tweak_counter,
-                                  tweak,
-                                  ctx->s,
-                                  &s_i);
+        const size_t batch_index = i % DEOXYS_BC_MAX_BATCH_SIZE;
+
+        if ((i == first_chunk) || (batch_index == 0)) {
+            size_t num_batch_chunks = DEOXYS_BC_MAX_BATCH_SIZE - batch_index;
+
+            if (num_batch_chunks > (end_chunk - i)) {
+                num_batch_chunks = end_chunk - i;
+            }
+
+            encrypt_s_batch(ctx,
+                            values->s,
+                            i,
+                            num_batch_chunks,
+                            (s_batch + batch_index));
+        }
+
+        s_i = s_batch[batch_index];
 
         size_t num_di_blocks_in_chunk = ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
 
-        if ((i + 1) == num_chunks) {
+        if ((i + 1) == end_chunk) {
             num_di_blocks_in_chunk =
-                (num_di_blocks_without_final % (ZCZ_NUM_DI_BLOCKS_IN_CHUNK));
+                (num_di_blocks % (ZCZ_NUM_DI_BLOCKS_IN_CHUNK));
 
             if (num_di_blocks_in_chunk == 0) {
                 num_di_blocks_in_chunk = ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
             }
         }
 
-        deoxys_bc_128_384_setup_middle_base(&(ctx->cipher_ctx),
-                                            ZCZ_DOMAIN_CENTER,
-                                            tweak_counter,
-                                            ctx->t);
         // For each chunk, we have j = 1..128 di-blocks.
         // The j variable is also named that way in the paper.
-        // size_t j = 0;
-
-        while (num_di_blocks_in_chunk >= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE) {
-            // Compute Z_{i,j} = E_K^{c, k, T}(S_i)
-            set_eight_blocks_same_x(s_i, z_i_j);
-            deoxys_bc_128_384_encrypt_eight_one(cipher_ctx, k, z_i_j);
-
-            load_eight_blocks(x_i, source_position);      // Load the X_i's
-            load_eight_blocks(y_i, (source_position+1));  // Load the R_i's
-
-            vxor_eight(z_i_j, x_i, x_i);  // L'_i = X_i xor Z_{i,j}
-            vxor_eight(z_i_j, y_i, y_i);
-            vxor_eight_same_x(s_i, y_i, y_i);  // Y_i = R_i xor S_i xor Z_{i,j}
-
-            // Copy the values X_i to the buffer
-            store_eight_blocks(target_position, x_i);        // Copy the X_i's
-            store_eight_blocks((target_position + 1), y_i);  // Copy the Y_i's
-
-            // Update Y_R
-            y_r = gf_2_128_double_eight(y_r, y_i);
-
-            // Update Y_L = Y_i xor L'_i
-            vxor_eight(x_i, y_i, y_i);
-            y_l = gf_2_128_times_four_eight(y_l, y_i);
-
-            k += ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;
-            num_di_blocks_in_chunk -= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // Used 8
-            target_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks fur.
-            source_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks fur.
-        }
+        // The bottom layer uses the same counter k as the middle layer, so
+        // each group of 8 (or 16) di-blocks goes through both while in
+        // registers. Chunks hold a multiple of 16 di-blocks, so the wide
+        // sequences never cross a chunk boundary. A chunk is split where its
+        // counters enter the next window of the bases.
+
+        while (num_di_blocks_in_chunk > 0) {
+            // -------------------------------------------------------------
+            // Rebase at each window of counters, so that no sequence
+            // straddles two
+            // -------------------------------------------------------------
+
+            if ((k % DEOXYS_BC_NUM_COUNTERS_PER_BASE) == 0) {
+                center_base = rebase(ctx,
+                                     &(ctx->center_base),
+                                     &rebased_center,
+                                     ZCZ_DOMAIN_CENTER,
+                                     k);
+                bottom_base = rebase(ctx,
+                                     &(ctx->bottom_base),
+                                     &rebased_bottom,
+                                     ZCZ_DOMAIN_BOT,
+                                     k);
+                deoxys_bc_128_384_setup_middle_base(&middle_base,
+                                                    center_base,
+                                                    values->t);
+            }
 
-        while (num_di_blocks_in_chunk >= 1) {
-            // -----------------------------------------------------------------
-            // Compute Z_{i,j} = E_K^{c, 0, k}(S_i)
-            // k = (i - 1) * n + j
-            // -----------------------------------------------------------------
+            size_t num_di_blocks_in_window =
+                get_num_di_blocks_until_rebase(k, num_di_blocks_in_chunk);
+            num_di_blocks_in_chunk -= num_di_blocks_in_window;
 
-            deoxys_bc_128_384_encrypt(cipher_ctx,
-                                      ZCZ_DOMAIN_CENTER,
-                                      k,
-                                      ctx->t,
-                                      s_i,
-                                      z_i_j);
+#ifdef DEOXYS_BC_SIXTEEN_ENABLED
+            while (num_di_blocks_in_window
+                >= ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE) {
+                set_sixteen_blocks_same_x(s_i, z_i_j);
+                deoxys_bc_128_384_encrypt_sixteen_one(&middle_base,
+                                                      k,
+                                                      z_i_j);
 
-            // -----------------------------------------------------------------
-            // Source is at X_i, target is at X_i
-            // -----------------------------------------------------------------
+                load_sixteen_blocks(x_i, source_position);
+                load_sixteen_blocks(y_i, (source_position+1));
 
-            x_i[0] = load(source_position);
-            r_i = load((source_position) + 1);
+                vxor_sixteen(z_i_j, x_i, x_i);
+                vxor_sixteen(z_i_j, y_i, y_i);
+                vxor_sixteen_same_x(s_i, y_i, y_i);
 
-            l_i = vxor(z_i_j[0], x_i[0]);
-            y_i[0] = vxor3(r_i, z_i_j[0], s_i);
+                vxor_sixteen(x_i, y_i, z_i_j);
+                gf_2_128_double_and_times_four_sixteen(&y_r, &y_l, y_i, z_i_j);
 
-            store(target_position, l_i);
-            store((target_position + 1), y_i[0]);
+                deoxys_bc_128_384_encrypt_sixteen(bottom_base,
+                                                  k,
+                                                  x_i,
+                                                  y_i);
 
-            // Update Y_L
-            gf_2_128_times_four(y_l, y_l, tmp);
-            y_l = vxor3(y_l, y_i[0], l_i);
+                store_sixteen_blocks(target_position, x_i);
+                store_sixteen_blocks((target_position + 1), y_i);
 
-            // Update Y_R
-            gf_2_128_double(y_r, y_r, tmp);
-            y_r = vxor(y_r, y_i[0]);
+                k += ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE;
+                num_di_blocks_in_window -= ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE;
+                target_position += ZCZ_NUM_BLOCKS_PER_WIDE_SEQUENCE;
+                source_position += ZCZ_NUM_BLOCKS_PER_WIDE_SEQUENCE;
+            }
+#endif  // DEOXYS_BC_SIXTEEN_ENABLED
+
+            while (num_di_blocks_in_window >= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE) {
+                // Compute Z_{i,j} = E_K^{c, k, T}(S_i)
+                set_eight_blocks_same_x(s_i, z_i_j);
+                deoxys_bc_128_384_encrypt_eight_one(&middle_base,
+                                                    k,
+                                                    z_i_j);
+
+                load_eight_blocks(x_i, source_position);      // Load the X_i's
+                load_eight_blocks(y_i, (source_position+1));  // Load the R_i's
+
+                vxor_eight(z_i_j, x_i, x_i);  // L'_i = X_i xor Z_{i,j}
+                vxor_eight(z_i_j, y_i, y_i);
+                // Y_i = R_i xor S_i xor Z_{i,j}
+                vxor_eight_same_x(s_i, y_i, y_i);
+
+                // Update Y_R, and Y_L over Y_i xor L'_i
+                vxor_eight(x_i, y_i, z_i_j);
+                gf_2_128_double_and_times_four_eight(&y_r, &y_l, y_i, z_i_j);
+
+                // Bottom layer: R'_i = E_K^{b, k, L'_i}(Y_i)
+                deoxys_bc_128_384_encrypt_eight_eight(bottom_base,
+                                                      k,
+                                                      x_i,
+                                                      y_i);
+
+                // Copy both L'_i's and R'_i's to the ciphertext
+                store_eight_blocks(target_position, x_i);
+                store_eight_blocks((target_position + 1), y_i);
+
+                k += ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;
+                num_di_blocks_in_window -= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;
+                target_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;
+                source_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;
+            }
 
-            source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
-            target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
-            num_di_blocks_in_chunk--;
-            k++;
+            // Tail: 1..7 di-blocks, with one padded kernel call per layer
+            if (num_di_blocks_in_window >= 1) {
+                // -------------------------------------------------------------
+                // Compute Z_{i,j} = E_K^{c, k, T}(S_i)
+                // k = (i - 1) * n + j
+                // -------------------------------------------------------------
+
+                for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                    t_blocks[j] = values->t;
+                    z_i_j[j] = s_i;
+                }
+
+                encrypt_tail(ctx,
+                             ZCZ_DOMAIN_CENTER,
+                             center_base,
+                             k,
+                             num_di_blocks_in_window,
+                             t_blocks,
+                             z_i_j);
+
+                for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                    x_i[j] = load(source_position);
+                    r_i = load((source_position + 1));
+
+                    x_i[j] = vxor(z_i_j[j], x_i[j]);  // L'_i
+                    y_i[j] = vxor3(r_i, z_i_j[j], s_i);
+
+                    // Update Y_L
+                    gf_2_128_times_four(y_l, y_l, tmp);
+                    y_l = vxor3(y_l, y_i[j], x_i[j]);
+
+                    // Update Y_R
+                    gf_2_128_double(y_r, y_r, tmp);
+                    y_r = vxor(y_r, y_i[j]);
+
+                    source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
+                }
+
+                encrypt_tail(ctx,
+                             ZCZ_DOMAIN_BOT,
+                             bottom_base,
+                             k,
+                             num_di_blocks_in_window,
+                             x_i,
+                             y_i);
+
+                for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                    store(target_position, x_i[j]);
+                    store((target_position + 1), y_i[j]);
+                    target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
+                }
+
+                k += num_di_blocks_in_window;
+            }
         }
     }
 
-    // ---------------------------------------------------------------------
-    // Process Y_L and Y_R.
-    // Note: This destroys the previous round tweaks
-    // ---------------------------------------------------------------------
-
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_YL,
-                              num_di_blocks,
-                              y_r,
-                              y_l,
-                              &(ctx->y_l));
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_YR,
-                              num_di_blocks,
-                              y_l,
-                              y_r,
-                              &(ctx->y_r));
+    *hash_y_l = y_l;
+    *hash_y_r = y_r;
 }
 
 // ---------------------------------------------------------------------
 
-static void encrypt_bottom_layer(zcz_ctx_t* ctx,
-                                 const uint8_t* state,
-                                 uint8_t* ciphertext,
-                                 const size_t num_di_blocks) {
-    __m128i states[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
-    __m128i tweaks[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
-    __m128i* source_position = (__m128i*)state;
-    __m128i* target_position = (__m128i*)ciphertext;
-
-    size_t num_di_blocks_remaining = num_di_blocks;
-    size_t tweak_counter = 0;
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
-    deoxys_bc_128_384_setup_base_counters(cipher_ctx,
-                                          ZCZ_DOMAIN_BOT,
-                                          tweak_counter);
-
-    tweak_counter = 1;
+static void encrypt_middle_and_bottom_task(void* argument) {
+    zcz_range_task_t* task = (zcz_range_task_t*)argument;
+    encrypt_middle_and_bottom_di_blocks(task->ctx,
+                                        task->values,
+                                        task->target,
+                                        task->first_di_block,
+                                        task->num_di_blocks,
+                                        &(task->hash_l),
+                                        &(task->hash_r));
+}
 
-    // ---------------------------------------------------------------------
-    // Next 8 di-blocks
-    // ---------------------------------------------------------------------
+// ---------------------------------------------------------------------
 
-    while (num_di_blocks_remaining > ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE) {
-        load_eight_blocks(states, (source_position + 1));  // Y_1 .. Y_8
-        load_eight_blocks(tweaks, source_position);        // L'_1  .. L'_8
+/**
+ * encrypt_middle_and_bottom_di_blocks() on the first num_di_blocks
+ * di-blocks, whole chunks split across the threads of the pool. Each chunk
+ * needs only S_i and its own counters, so only Y_L and Y_R are combined.
+ */
+static void encrypt_middle_and_bottom_di_blocks_parallel(
+    const zcz_ctx_t* ctx,
+    zcz_pool_t* pool,
+    const zcz_values_t* values,
+    uint8_t* state,
+    const size_t num_di_blocks,
+    __m128i* hash_y_l,
+    __m128i* hash_y_r) {
+    const size_t num_tasks = split_into_range_tasks(ctx,
+                                                    pool,
+                                                    values,
+                                                    state,
+                                                    state,
+                                                    num_di_blocks);
+
+    zcz_pool_run(pool,
+                 encrypt_middle_and_bottom_task,
+                 zcz_pool_scratch(pool, 0),
+                 ZCZ_POOL_SCRATCH_SIZE,
+                 num_tasks);
+    combine_range_hashes(pool, num_tasks, 0, hash_y_l, hash_y_r);
+}
 
-        // Obtain the values X_i in states
-        deoxys_bc_128_384_encrypt_eight_eight(cipher_ctx,
-                                              tweak_counter,
-                                              tweaks,
-                                              states);
+// ---------------------------------------------------------------------
 
-        // Copy both L'_i's and R'_i's to the ciphertext
-        store_eight_blocks(target_position, tweaks);
-        store_eight_blocks((target_position + 1), states);  // Copy the R'_i's
+/**
+ * Runs on the threads of the pool, or on the calling one if pool is NULL.
+ */
+static void encrypt_middle_and_bottom_layers(const zcz_ctx_t* ctx,
+                                             zcz_pool_t* pool,
+                                             zcz_values_t* values,
+                                             uint8_t* state,
+                                             const size_t num_di_blocks) {
+    // Zeroize the hash values Y_L and Y_R at the beginning
+    __m128i y_l = vzero;
+    __m128i y_r = vzero;
 
-        num_di_blocks_remaining -= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // We used 8
-        target_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks further
-        source_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks further
-        tweak_counter += ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // Tweak += 8
+    // The final di-block is processed separately
+    if (pool != NULL) {
+        encrypt_middle_and_bottom_di_blocks_parallel(ctx,
+                                                     pool,
+                                                     values,
+                                                     state,
+                                                     num_di_blocks - 1,
+                                                     &y_l,
+                                                     &y_r);
+    } else {
+        encrypt_middle_and_bottom_di_blocks(ctx,
+                                            values,
+                                            state,
+                                            0,
+                                            num_di_blocks - 1,
+                                            &y_l,
+                                            &y_r);
     }
 
     // ---------------------------------------------------------------------
-    // Tail: 0..7 di-blocks
+    // Process Y_L and Y_R.
     // ---------------------------------------------------------------------
 
-    while (num_di_blocks_remaining > 1) {
-        states[0] = load((source_position + 1));
-        tweaks[0] = load(source_position);
-
-        deoxys_bc_128_384_encrypt(cipher_ctx,
-                                  ZCZ_DOMAIN_BOT,
-                                  tweak_counter,
-                                  tweaks[0],
-                                  states[0],
-                                  states);
-
-        // Copy both L'_i and R'_i to the buffer
-        store(target_position, tweaks[0]);
-        store((target_position + 1), states[0]);
-
-        num_di_blocks_remaining -= 1;  // We used 32 bytes
-        target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;  // 2 blocks further
-        source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;  // 2 blocks further
-        tweak_counter += 1;
-    }
+    encrypt_hash_pair(ctx,
+                      ZCZ_DOMAIN_YL,
+                      ZCZ_DOMAIN_YR,
+                      num_di_blocks,
+                      y_l,
+                      y_r,
+                      &(values->y_l),
+                      &(values->y_r));
 }
 
 // ---------------------------------------------------------------------
 
-static void encrypt_last_di_block_top(zcz_ctx_t* ctx,
+static void encrypt_last_di_block_top(const zcz_ctx_t* ctx,
+                                      zcz_values_t* values,
                                       const uint8_t* final_full_di_block,
                                       const size_t num_di_blocks) {
     __m128i left_input_block = load(final_full_di_block);
     __m128i right_input_block =
         load((final_full_di_block + ZCZ_NUM_BYTES_IN_BLOCK));
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
+    const deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
 
-    __m128i left_output_block = vxor(left_input_block, ctx->x_l);
-    __m128i right_output_block = vxor(right_input_block, ctx->x_r);
+    __m128i left_output_block = vxor(left_input_block, values->x_l);
+    __m128i right_output_block = vxor(right_input_block, values->x_r);
 
     deoxys_bc_128_384_encrypt(cipher_ctx,
                           ZCZ_DOMAIN_TOP_LAST,
                           num_di_blocks,
                           right_output_block,
                           left_output_block,
-                          &(ctx->s));
+                          &(values->s));
 
     deoxys_bc_128_384_encrypt(cipher_ctx,
                           ZCZ_DOMAIN_S_LAST,
                           num_di_blocks,
-                          ctx->s,
+                          values->s,
                           right_output_block,
-                          &(ctx->t));
+                          &(values->t));
 }
 
 // ---------------------------------------------------------------------
 
-static void encrypt_last_di_block_bottom(zcz_ctx_t* ctx,
-                                         const uint8_t* ciphertext,
+static void encrypt_last_di_block_bottom(const zcz_ctx_t* ctx,
+                                         zcz_values_t* values,
+                                         uint8_t* final_full_di_block,
                                          const size_t num_di_blocks) {
     __m128i left_output_block;
     __m128i right_output_block;
 
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
+    const deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
     deoxys_bc_128_384_encrypt(cipher_ctx,
                               ZCZ_DOMAIN_CENTER_LAST,
                               num_di_blocks,
-                              ctx->t,
-                              ctx->s,
+                              values->t,
+                              values->s,
                               &left_output_block);
 
     deoxys_bc_128_384_encrypt(cipher_ctx,
                               ZCZ_DOMAIN_BOT_LAST,
                               num_di_blocks,
                               left_output_block,
-                              ctx->t,
+                              values->t,
                               &right_output_block);
 
-    left_output_block = vxor(left_output_block, ctx->y_l);
-    right_output_block = vxor(right_output_block, ctx->y_r);
+    left_output_block = vxor(left_output_block, values->y_l);
+    right_output_block = vxor(right_output_block, values->y_r);
 
-    const uint8_t* left_ciphertext_block =
-            ciphertext + (num_di_blocks - 1) * ZCZ_NUM_BYTES_IN_DI_BLOCK;
-    const uint8_t* right_ciphertext_block =
-            left_ciphertext_block + ZCZ_NUM_BYTES_IN_BLOCK;
-
-    storeu(left_ciphertext_block, left_output_block);
-    storeu(right_ciphertext_block, right_output_block);
+    storeu(final_full_di_block, left_output_block);
+    storeu((final_full_di_block + ZCZ_NUM_BYTES_IN_BLOCK), right_output_block);
 }
 
 // ---------------------------------------------------------------------
 // Decryption component functions
 // ---------------------------------------------------------------------
 
-static void decrypt_top_layer(zcz_ctx_t* ctx,
-                              const uint8_t* state,
-                              uint8_t* plaintext,
-                              const size_t num_di_blocks) {
-    __m128i states[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
-    __m128i tweaks[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
+/**
+ * Decryption counterpart of encrypt_middle_and_bottom_di_blocks(). Updates
+ * the hash values X_L and X_R.
+ */
+static void decrypt_middle_and_top_di_blocks(const zcz_ctx_t* ctx,
+                                             const zcz_values_t* values,
+                                             uint8_t* state,
+                                             const size_t first_di_block,
+                                             const size_t num_di_blocks,
+                                             __m128i* hash_x_l,
+                                             __m128i* hash_x_r) {
     __m128i* source_position = (__m128i*)state;
-    __m128i* target_position = (__m128i*)plaintext;
+    __m128i* target_position = (__m128i*)state;
 
-    size_t num_di_blocks_remaining = num_di_blocks;
-    size_t tweak_counter = 0;
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
+    const size_t first_chunk = first_di_block / ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
+    const size_t end_chunk = first_chunk + get_num_chunks(num_di_blocks);
+    size_t k = first_di_block + 1;
 
-    deoxys_bc_128_384_setup_base_counters(cipher_ctx,
-                                          ZCZ_DOMAIN_TOP,
-                                          tweak_counter);
+    __m128i s_i;
+    __m128i s_batch[DEOXYS_BC_MAX_BATCH_SIZE];
+    __m128i y_i;
+    __m128i l_i;
+
+    __m128i x_i[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
+    __m128i r_i[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
+    __m128i z_i_j[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
+    __m128i t_blocks[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
 
-    tweak_counter = 1;
+    __m128i x_l = *hash_x_l;
+    __m128i x_r = *hash_x_r;
+    __m128i tmp;
+
+    deoxys_bc_128_384_base_t rebased_center;
+    deoxys_bc_128_384_base_t rebased_top;
+    deoxys_bc_128_384_base_t middle_base;
+
+    const deoxys_bc_128_384_base_t* center_base = rebase(ctx,
+                                                         &(ctx->center_base),
+                                                         &rebased_center,
+                                                         ZCZ_DOMAIN_CENTER,
+                                                         k);
+    const deoxys_bc_128_384_base_t* top_base = rebase(ctx,
+                                                      &(ctx->top_base),
+                                                      &rebased_top,
+                                                      ZCZ_DOMAIN_TOP,
+                                                      k);
 
     // ---------------------------------------------------------------------
-    // Next 8 di-blocks
+    // Add T to the precomputed base of the center domain. T is the same for
+    // all chunks, so this is needed only once per window of counters.
     // ---------------------------------------------------------------------
 
-    while (num_di_blocks_remaining > ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE) {
-        load_eight_blocks(states, source_position);        // L_1 .. L_8
-        load_eight_blocks(tweaks, (source_position + 1));  // R_1 .. R_8
-
-        deoxys_bc_128_384_decrypt_eight_eight(cipher_ctx,
-                                              tweak_counter,
-                                              tweaks,
-                                              states);
-
-        // Copy the values X_i to the buffer
-        store_eight_blocks(target_position, states);       // Copy the L_i's
-        store_eight_blocks((target_position + 1), tweaks);  // Copy the R_i's
-
-        num_di_blocks_remaining -= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // We used 8
-        target_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks further
-        source_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks further
-        tweak_counter += ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // Tweak += 8
-    }
+    deoxys_bc_128_384_setup_middle_base(&middle_base,
+                                        center_base,
+                                        values->t);
 
     // ---------------------------------------------------------------------
-    // Tail: 0..7 di-blocks
+    // Compute S_i
     // ---------------------------------------------------------------------
 
-    while (num_di_blocks_remaining > 1) {
-        states[0] = load(source_position);
-        tweaks[0] = load((source_position + 1));
-
-        deoxys_bc_128_384_decrypt(cipher_ctx,
-                                  ZCZ_DOMAIN_TOP,
-                                  tweak_counter,
-                                  tweaks[0],
-                                  states[0],
-                                  states);
-
-        // Copy X_i || R_i to the buffer
-        store(target_position, states[0]);
-        store((target_position + 1), tweaks[0]);
+    for (size_t i = first_chunk; i < end_chunk; ++i) {
+        // ---------------------------------------------------------------------
+        // Compute S_i = E_K^{s, 0, i}(S) for the next up to 8 chunks at once
+        // ---------------------------------------------------------------------
 
-        num_di_blocks_remaining -= 1;  // We used 32 bytes
-        target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;  // 2 blocks further
-        source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;  // 2 blocks further
-        tweak_counter += 1;
-    }
-}
+        const size_t batch_index = i % DEOXYS_BC_MAX_BATCH_SIZE;
 
-// ---------------------------------------------------------------------
+        if ((i == first_chunk) || (batch_index == 0)) {
+            size_t num_batch_chunks = DEOXYS_BC_MAX_BATCH_SIZE - batch_index;
 
-static void decrypt_middle_layer(zcz_ctx_t* ctx,
-                                 uint8_t* state,
-                                 const size_t num_di_blocks) {
-    __m128i tweaks[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
-    __m128i* source_position = (__m128i*)state;
-    __m128i* target_position = (__m128i*)state;
+            if (num_batch_chunks > (end_chunk - i)) {
+                num_batch_chunks = end_chunk - i;
+            }
 
-    size_t num_di_blocks_without_final = num_di_blocks;
+            encrypt_s_batch(ctx,
+                            values->s,
+                            i,
+                            num_batch_chunks,
+                            (s_batch + batch_index));
+        }
 
-    if (num_di_blocks > 0) {
-        num_di_blocks_without_final--;
-    }
+        s_i = s_batch[batch_index];
 
-    const size_t num_chunks = get_num_chunks(num_di_blocks_without_final);
-    size_t k;
-    size_t tweak_counter = 0;
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
+        size_t num_di_blocks_in_chunk = ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
 
-    // ---------------------------------------------------------------------
-    // Zeroize the hash values Y_L and Y_R at the beginning
-    // ---------------------------------------------------------------------
+        if ((i + 1) == end_chunk) {
+            num_di_blocks_in_chunk =
+                (num_di_blocks % (ZCZ_NUM_DI_BLOCKS_IN_CHUNK));
 
-    __m128i s_i;
-    __m128i z_i_j;
-    __m128i y_i;
-    __m128i l_i;
-    __m128i r_i;
-    __m128i x_i;
+            if (num_di_blocks_in_chunk == 0) {
+                num_di_blocks_in_chunk = ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
+            }
+        }
 
-    __m128i x_l = vzero;
-    __m128i x_r = vzero;
-    __m128i tmp;
+        // The top layer uses the same counter k as the middle layer, so
+        // each group of 8 (or 16) di-blocks goes through both while in
+        // registers. A chunk is split where its counters enter the next
+        // window of the bases.
+
+        while (num_di_blocks_in_chunk > 0) {
+            // -------------------------------------------------------------
+            // Rebase at each window of counters, so that no sequence
+            // straddles two
+            // -------------------------------------------------------------
+
+            if ((k % DEOXYS_BC_NUM_COUNTERS_PER_BASE) == 0) {
+                center_base = rebase(ctx,
+                                     &(ctx->center_base),
+                                     &rebased_center,
+                                     ZCZ_DOMAIN_CENTER,
+                                     k);
+                top_base = rebase(ctx,
+                                  &(ctx->top_base),
+                                  &rebased_top,
+                                  ZCZ_DOMAIN_TOP,
+                                  k);
+                deoxys_bc_128_384_setup_middle_base(&middle_base,
+                                                    center_base,
+                                                    values->t);
+            }
 
-    // ---------------------------------------------------------------------
-    // Init domain and base counter
-    // ---------------------------------------------------------------------
+            size_t num_di_blocks_in_window =
+                get_num_di_blocks_until_rebase(k, num_di_blocks_in_chunk);
+            num_di_blocks_in_chunk -= num_di_blocks_in_window;
 
-    deoxys_bc_128_384_setup_base_counters(&(ctx->cipher_ctx), ZCZ_DOMAIN_S, 0);
+#ifdef DEOXYS_BC_SIXTEEN_ENABLED
+            while (num_di_blocks_in_window
+                >= ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE) {
+                set_sixteen_blocks_same_x(s_i, z_i_j);
+                deoxys_bc_128_384_encrypt_sixteen_one(&middle_base,
+                                                      k,
+                                                      z_i_j);
 
-    // ---------------------------------------------------------------------
-    // Compute S_i
-    // ---------------------------------------------------------------------
+                load_sixteen_blocks(x_i, source_position);
+                load_sixteen_blocks(r_i, (source_position+1));
 
-    for (size_t i = 0; i < num_chunks; ++i) {
-        tweaks[0] = set64(i+1, 0L);
-        tweak_counter = 0;
+                vxor_sixteen(z_i_j, x_i, x_i);
+                vxor_sixteen(z_i_j, r_i, r_i);
+                vxor_sixteen_same_x(s_i, r_i, r_i);
 
-        // ---------------------------------------------------------------------
-        // Compute S_i = E_K^{s, 0, i}(S)
-        // ---------------------------------------------------------------------
+                vxor_sixteen(x_i, r_i, z_i_j);
+                gf_2_128_double_and_times_four_sixteen(&x_l, &x_r, x_i, z_i_j);
 
-        deoxys_bc_128_384_encrypt(cipher_ctx,
-                                  ZCZ_DOMAIN_S,
-                                  tweak_counter,
-                                  tweaks[0],
-                                  ctx->s,
-                                  &s_i);
+                deoxys_bc_128_384_decrypt_sixteen(top_base,
+                                                  k,
+                                                  r_i,
+                                                  x_i);
 
-        size_t num_di_blocks_in_chunk = ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
+                store_sixteen_blocks(target_position, x_i);
+                store_sixteen_blocks((target_position + 1), r_i);
 
-        if ((i + 1) == num_chunks) {
-            num_di_blocks_in_chunk =
-                (num_di_blocks_without_final % (ZCZ_NUM_DI_BLOCKS_IN_CHUNK));
+                k += ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE;
+                num_di_blocks_in_window -= ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE;
+                target_position += ZCZ_NUM_BLOCKS_PER_WIDE_SEQUENCE;
+                source_position += ZCZ_NUM_BLOCKS_PER_WIDE_SEQUENCE;
+            }
+#endif  // DEOXYS_BC_SIXTEEN_ENABLED
+
+            while (num_di_blocks_in_window >= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE) {
+                // Compute Z_{i,j} = E_K^{c, k, T}(S_i)
+                set_eight_blocks_same_x(s_i, z_i_j);
+                deoxys_bc_128_384_encrypt_eight_one(&middle_base,
+                                                    k,
+                                                    z_i_j);
+
+                load_eight_blocks(x_i, source_position);      // Load the L'_i's
+                load_eight_blocks(r_i, (source_position+1));  // Load the Y_i's
+
+                vxor_eight(z_i_j, x_i, x_i);  // X_i = L'_i xor Z_{i,j}
+                vxor_eight(z_i_j, r_i, r_i);
+                // R_i = Y_i xor S_i xor Z_{i,j}
+                vxor_eight_same_x(s_i, r_i, r_i);
+
+                // Update X_L, and X_R over X_i xor R_i
+                vxor_eight(x_i, r_i, z_i_j);
+                gf_2_128_double_and_times_four_eight(&x_l, &x_r, x_i, z_i_j);
+
+                // Top layer: L_i = D_K^{t, k, R_i}(X_i)
+                deoxys_bc_128_384_decrypt_eight_eight(top_base,
+                                                      k,
+                                                      r_i,
+                                                      x_i);
+
+                store_eight_blocks(target_position, x_i);        // The L_i's
+                store_eight_blocks((target_position + 1), r_i);  // The R_i's
+
+                k += ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;
+                num_di_blocks_in_window -= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;
+                target_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;
+                source_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;
+            }
 
-            if (num_di_blocks_in_chunk == 0) {
-                num_di_blocks_in_chunk = ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
+            // Tail: 1..7 di-blocks, with one padded kernel call per layer
+            if (num_di_blocks_in_window >= 1) {
+                // -------------------------------------------------------------
+                // Compute Z_{i,j} = E_K^{c, k, T}(S_i)
+                // k = (i - 1) * n + j
+                // -------------------------------------------------------------
+
+                for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                    t_blocks[j] = values->t;
+                    z_i_j[j] = s_i;
+                }
+
+                encrypt_tail(ctx,
+                             ZCZ_DOMAIN_CENTER,
+                             center_base,
+                             k,
+                             num_di_blocks_in_window,
+                             t_blocks,
+                             z_i_j);
+
+                for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                    l_i = load(source_position);
+                    y_i = load((source_position + 1));
+
+                    x_i[j] = vxor(z_i_j[j], l_i);
+                    r_i[j] = vxor3(y_i, z_i_j[j], s_i);
+
+                    // Update X_R
+                    gf_2_128_times_four(x_r, x_r, tmp);
+                    x_r = vxor3(x_r, x_i[j], r_i[j]);
+
+                    // Update X_L
+                    gf_2_128_double(x_l, x_l, tmp);
+                    x_l = vxor(x_l, x_i[j]);
+
+                    source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
+                }
+
+                decrypt_tail(ctx,
+                             ZCZ_DOMAIN_TOP,
+                             top_base,
+                             k,
+                             num_di_blocks_in_window,
+                             r_i,
+                             x_i);
+
+                for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                    store(target_position, x_i[j]);
+                    store((target_position + 1), r_i[j]);
+                    target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
+                }
+
+                k += num_di_blocks_in_window;
             }
         }
+    }
 
-        for (size_t j = 0; j < num_di_blocks_in_chunk; ++j) {
-            // -----------------------------------------------------------------
-            // Compute Z_{i,j} = E_K^{c, 0, k}(S_i)
-            // k = (i - 1) * n + j
-            // -----------------------------------------------------------------
-
-            k = i * ZCZ_NUM_DI_BLOCKS_IN_CHUNK + (j+1);
-            deoxys_bc_128_384_encrypt(cipher_ctx,
-                                      ZCZ_DOMAIN_CENTER,
-                                      k,
-                                      ctx->t,
-                                      s_i,
-                                      &z_i_j);
+    *hash_x_l = x_l;
+    *hash_x_r = x_r;
+}
 
-            // -----------------------------------------------------------------
-            // Source is at L'_i, target is at L'_i
-            // -----------------------------------------------------------------
+// ---------------------------------------------------------------------
 
-            l_i = load(source_position);
-            y_i = load((source_position) + 1);
+static void decrypt_middle_and_top_task(void* argument) {
+    zcz_range_task_t* task = (zcz_range_task_t*)argument;
+    decrypt_middle_and_top_di_blocks(task->ctx,
+                                     task->values,
+                                     task->target,
+                                     task->first_di_block,
+                                     task->num_di_blocks,
+                                     &(task->hash_l),
+                                     &(task->hash_r));
+}
 
-            x_i = vxor(z_i_j, l_i);
-            r_i = vxor3(y_i, z_i_j, s_i);
+// ---------------------------------------------------------------------
 
-            store(target_position, x_i);
-            store((target_position + 1), r_i);
+/**
+ * Decryption counterpart of encrypt_middle_and_bottom_di_blocks_parallel().
+ */
+static void decrypt_middle_and_top_di_blocks_parallel(
+    const zcz_ctx_t* ctx,
+    zcz_pool_t* pool,
+    const zcz_values_t* values,
+    uint8_t* state,
+    const size_t num_di_blocks,
+    __m128i* hash_x_l,
+    __m128i* hash_x_r) {
+    const size_t num_tasks = split_into_range_tasks(ctx,
+                                                    pool,
+                                                    values,
+                                                    state,
+                                                    state,
+                                                    num_di_blocks);
+
+    zcz_pool_run(pool,
+                 decrypt_middle_and_top_task,
+                 zcz_pool_scratch(pool, 0),
+                 ZCZ_POOL_SCRATCH_SIZE,
+                 num_tasks);
+    combine_range_hashes(pool, num_tasks, 1, hash_x_l, hash_x_r);
+}
 
-            // Update X_R
-            gf_2_128_times_four(x_r, x_r, tmp);
-            x_r = vxor3(x_r, x_i, r_i);
+// ---------------------------------------------------------------------
 
-            // Update X_L
-            gf_2_128_double(x_l, x_l, tmp);
-            x_l = vxor(x_l, x_i);
+/**
+ * Runs on the threads of the pool, or on the calling one if pool is NULL.
+ */
+static void decrypt_middle_and_top_layers(const zcz_ctx_t* ctx,
+                                          zcz_pool_t* pool,
+                                          zcz_values_t* values,
+                                          uint8_t* state,
+                                          const size_t num_di_blocks) {
+    // Zeroize the hash values X_L and X_R at the beginning
+    __m128i x_l = vzero;
+    __m128i x_r = vzero;
 
-            source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
-            target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
-        }
+    // The final di-block is processed separately
+    if (pool != NULL) {
+        decrypt_middle_and_top_di_blocks_parallel(ctx,
+                                                  pool,
+                                                  values,
+                                                  state,
+                                                  num_di_blocks - 1,
+                                                  &x_l,
+                                                  &x_r);
+    } else {
+        decrypt_middle_and_top_di_blocks(ctx,
+                                         values,
+                                         state,
+                                         0,
+                                         num_di_blocks - 1,
+                                         &x_l,
+                                         &x_r);
     }
 
     // ---------------------------------------------------------------------
     // Process X_L and X_R.
-    // Note: This destroys the previous round tweaks
     // ---------------------------------------------------------------------
 
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_XL,
-                              num_di_blocks,
-                              x_r,
-                              x_l,
-                              &(ctx->x_l));
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_XR,
-                              num_di_blocks,
-                              x_l,
-                              x_r,
-                              &(ctx->x_r));
+    encrypt_hash_pair(ctx,
+                      ZCZ_DOMAIN_XL,
+                      ZCZ_DOMAIN_XR,
+                      num_di_blocks,
+                      x_l,
+                      x_r,
+                      &(values->x_l),
+                      &(values->x_r));
 }
 
 // ---------------------------------------------------------------------
 
-static void decrypt_bottom_layer(zcz_ctx_t* ctx,
-                                 uint8_t* state,
-                                 const uint8_t* ciphertext,
-                                 const size_t num_di_blocks) {
-    deoxys_bc_128_384_setup_base_counters(&(ctx->cipher_ctx),
-                                          ZCZ_DOMAIN_BOT,
-                                          0);
-
-    __m128i states[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
-    __m128i tweaks[ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE];
-    __m128i* source_position = (__m128i*)ciphertext;
-    __m128i* target_position = (__m128i*)state;
+/**
+ * Decryption counterpart of encrypt_top_di_blocks() for the bottom layer.
+ * Writes L'_i || Y_i to target and updates the hash values Y_L and Y_R.
+ */
+static void decrypt_bottom_di_blocks(const zcz_ctx_t* ctx,
+                                     uint8_t* target,
+                                     const uint8_t* source,
+                                     const size_t first_di_block,
+                                     const size_t num_di_blocks,
+                                     __m128i* hash_y_l,
+                                     __m128i* hash_y_r) {
+    __m128i states[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
+    __m128i tweaks[ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE];
+    __m128i* source_position = (__m128i*)source;
+    __m128i* target_position = (__m128i*)target;
 
     size_t num_di_blocks_remaining = num_di_blocks;
-    size_t tweak_counter = 0;
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
-
-    // Zeroize the hash values X_L and X_R at the beginning
-    __m128i y_l = vzero;
-    __m128i y_r = vzero;
-    __m128i tmp;
+    size_t tweak_counter = first_di_block + 1;
 
-    deoxys_bc_128_384_setup_base_counters(cipher_ctx,
-                                          ZCZ_DOMAIN_BOT,
-                                          tweak_counter);
+    const deoxys_bc_128_384_base_t* base;
+    deoxys_bc_128_384_base_t rebased;
 
-    tweak_counter = 1;
+    __m128i y_l = *hash_y_l;
+    __m128i y_r = *hash_y_r;
+    __m128i tmp;
 
     // ---------------------------------------------------------------------
-    // Next 8 di-blocks
+    // One window of counters per base, so that no sequence straddles two
     // ---------------------------------------------------------------------
 
-    while (num_di_blocks_remaining > ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE) {
-        load_eight_blocks(states, (source_position + 1));  // R'_1 .. R'_8
-        load_eight_blocks(tweaks, source_position);        // L'_1 .. L'_8
-
-        // Obtain the values Y_i in states
-        deoxys_bc_128_384_decrypt_eight_eight(cipher_ctx,
+    while (num_di_blocks_remaining > 0) {
+        size_t num_di_blocks_in_window =
+            get_num_di_blocks_until_rebase(tweak_counter,
+                                           num_di_blocks_remaining);
+        num_di_blocks_remaining -= num_di_blocks_in_window;
+        base = rebase(ctx,
+                      &(ctx->bottom_base),
+                      &rebased,
+                      ZCZ_DOMAIN_BOT,
+                      tweak_counter);
+
+        // -----------------------------------------------------------------
+        // Next 16 di-blocks, in the VAES/AVX-512 and bitsliced AVX2 builds
+        // -----------------------------------------------------------------
+
+#ifdef DEOXYS_BC_SIXTEEN_ENABLED
+        while (num_di_blocks_in_window
+            >= ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE) {
+            load_sixteen_blocks(states, (source_position + 1));  // R'_1..R'_16
+            load_sixteen_blocks(tweaks, source_position);        // L'_1..L'_16
+
+            deoxys_bc_128_384_decrypt_sixteen(base,
                                               tweak_counter,
                                               tweaks,
                                               states);
 
-        // Copy the values X_i to the buffer
-        store_eight_blocks((target_position + 1), states);  // Copy the R'_i's
-        store_eight_blocks(target_position, tweaks);        // Copy the L'_i's
+            store_sixteen_blocks((target_position + 1), states);
+            store_sixteen_blocks(target_position, tweaks);
+
+            vxor_sixteen(states, tweaks, tweaks);
+            gf_2_128_double_and_times_four_sixteen(&y_r, &y_l, states, tweaks);
+
+            num_di_blocks_in_window -= ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE;
+            target_position += ZCZ_NUM_BLOCKS_PER_WIDE_SEQUENCE;
+            source_position += ZCZ_NUM_BLOCKS_PER_WIDE_SEQUENCE;
+            tweak_counter += ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE;
+        }
+#endif  // DEOXYS_BC_SIXTEEN_ENABLED
+
+        // -----------------------------------------------------------------
+        // Next 8 di-blocks
+        // -----------------------------------------------------------------
+
+        while (num_di_blocks_in_window >= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE) {
+            load_eight_blocks(states, (source_position + 1));  // R'_1 .. R'_8
+            load_eight_blocks(tweaks, source_position);        // L'_1 .. L'_8
+
+            // Obtain the values Y_i in states
+            deoxys_bc_128_384_decrypt_eight_eight(base,
+                                                  tweak_counter,
+                                                  tweaks,
+                                                  states);
+
+            // Store L'_i || Y_i in place of L'_i || R'_i
+            store_eight_blocks((target_position + 1), states);  // The Y_i's
+            store_eight_blocks(target_position, tweaks);        // The L'_i's
+
+            // tweaks[i] = Y_i xor L'_i
+            vxor_eight(states, tweaks, tweaks);
+
+            // Update Y_R = Y_R * 2^8 xor Y_1 * 2^7 xor ... Y_7 * 2 xor Y_8
+            // and Y_L = Y_L * (4)^8 xor (Y_1 xor L'_1) * 4^7 xor ...
+            gf_2_128_double_and_times_four_eight(&y_r, &y_l, states, tweaks);
+
+            num_di_blocks_in_window -= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;
+            target_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks
+            source_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks
+            tweak_counter += ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // Tweak += 8
+        }
+
+        // -----------------------------------------------------------------
+        // Tail: 0..7 di-blocks, in one padded call of a 2-, 4- or 8-block
+        // kernel
+        // -----------------------------------------------------------------
 
-        // Update Y_R = Y_R * 2^8 xor Y_1 * 2^7 xor ... Y_7 * 2 xor Y_8
-        y_r = gf_2_128_double_eight(y_r, states);
+        if (num_di_blocks_in_window > 0) {
+            for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                states[j] = load((source_position + 1));
+                tweaks[j] = load(source_position);
+                source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
+            }
+
+            decrypt_tail(ctx,
+                         ZCZ_DOMAIN_BOT,
+                         base,
+                         tweak_counter,
+                         num_di_blocks_in_window,
+                         tweaks,
+                         states);
+
+            for (size_t j = 0; j < num_di_blocks_in_window; ++j) {
+                // Copy L'_i || Y_i to the buffer
+                store(target_position, tweaks[j]);
+                store((target_position + 1), states[j]);
+
+                // Update Y_R
+                gf_2_128_double(y_r, y_r, tmp);
+                y_r = vxor(y_r, states[j]);
 
-        // states[i] = Y_i xor L'_i
-        // Update Y_L = Y_L * (4)^8 xor Y_1 * 4^7 xor ... Y_7 * 4 xor Y_8
-        vxor_eight(states, tweaks, states);
+                // Update Y_L
+                gf_2_128_times_four(y_l, y_l, tmp);
+                y_l = vxor3(y_l, states[j], tweaks[j]);
 
-        y_l = gf_2_128_times_four_eight(y_l, states);
+                target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;
+            }
 
-        num_di_blocks_remaining -= ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // We used 8
-        target_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks further
-        source_position += ZCZ_NUM_BLOCKS_PER_SEQUENCE;   // 16 blocks further
-        tweak_counter += ZCZ_NUM_DI_BLOCKS_PER_SEQUENCE;  // Tweak += 8
+            tweak_counter += num_di_blocks_in_window;
+        }
     }
 
-    // ---------------------------------------------------------------------
-    // Tail: 0..7 di-blocks
-    // ---------------------------------------------------------------------
+    *hash_y_l = y_l;
+    *hash_y_r = y_r;
+}
 
-    while (num_di_blocks_remaining > 1) {
-        states[0] = load((source_position + 1));
-        tweaks[0] = load(source_position);
+// ---------------------------------------------------------------------
 
-        deoxys_bc_128_384_decrypt(cipher_ctx,
-                                  ZCZ_DOMAIN_BOT,
-                                  tweak_counter,
-                                  tweaks[0],
-                                  states[0],
-                                  states);
+static void decrypt_bottom_task(void* argument) {
+    zcz_range_task_t* task = (zcz_range_task_t*)argument;
+    decrypt_bottom_di_blocks(task->ctx,
+                             task->target,
+                             task->source,
+                             task->first_di_block,
+                             task->num_di_blocks,
+                             &(task->hash_l),
+                             &(task->hash_r));
+}
+
+// ---------------------------------------------------------------------
 
-        // Copy L'_i || Y_i to the buffer
-        store(target_position, tweaks[0]);
-        store((target_position + 1), states[0]);
+/**
+ * Decryption counterpart of encrypt_top_di_blocks_parallel(), where Y_L is
+ * the sum over powers of four and Y_R the one over powers of two.
+ */
+static void decrypt_bottom_di_blocks_parallel(const zcz_ctx_t* ctx,
+                                              zcz_pool_t* pool,
+                                              uint8_t* target,
+                                              const uint8_t* source,
+                                              const size_t num_di_blocks,
+                                              __m128i* hash_y_l,
+                                              __m128i* hash_y_r) {
+    const size_t num_tasks = split_into_range_tasks(ctx,
+                                                    pool,
+                                                    NULL,
+                                                    target,
+                                                    source,
+                                                    num_di_blocks);
+
+    zcz_pool_run(pool,
+                 decrypt_bottom_task,
+                 zcz_pool_scratch(pool, 0),
+                 ZCZ_POOL_SCRATCH_SIZE,
+                 num_tasks);
+    combine_range_hashes(pool, num_tasks, 0, hash_y_l, hash_y_r);
+}
 
-        // Update Y_R
-        gf_2_128_double(y_r, y_r, tmp);
-        y_r = vxor(y_r, states[0]);
+// ---------------------------------------------------------------------
 
-        // Update Y_L
-        gf_2_128_times_four(y_l, y_l, tmp);
-        y_l = vxor3(y_l, states[0], tweaks[0]);
+/**
+ * Runs on the threads of the pool, or on the calling one if pool is NULL.
+ */
+static void decrypt_bottom_layer(const zcz_ctx_t* ctx,
+                                 zcz_pool_t* pool,
+                                 zcz_values_t* values,
+                                 uint8_t* state,
+                                 const uint8_t* ciphertext,
+                                 const size_t num_di_blocks) {
+    // Zeroize the hash values Y_L and Y_R at the beginning
+    __m128i y_l = vzero;
+    __m128i y_r = vzero;
 
-        num_di_blocks_remaining -= 1;  // We used 32 bytes
-        target_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;  // 2 blocks further
-        source_position += ZCZ_NUM_BLOCKS_IN_DI_BLOCK;  // 2 blocks further
-        tweak_counter += 1;
+    // The final di-block is processed separately
+    if (pool != NULL) {
+        decrypt_bottom_di_blocks_parallel(ctx,
+                                          pool,
+                                          state,
+                                          ciphertext,
+                                          num_di_blocks - 1,
+                                          &y_l,
+                                          &y_r);
+    } else {
+        decrypt_bottom_di_blocks(ctx,
+                                 state,
+                                 ciphertext,
+                                 0,
+                                 num_di_blocks - 1,
+                                 &y_l,
+                                 &y_r);
     }
 
     // ---------------------------------------------------------------------
     // Process Y_L and Y_R.
-    // Note: This destroys the previous round tweaks
     // ---------------------------------------------------------------------
 
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_YL,
-                              num_di_blocks,
-                              y_r,
-                              y_l,
-                              &(ctx->y_l));
-    deoxys_bc_128_384_encrypt(cipher_ctx,
-                              ZCZ_DOMAIN_YR,
-                              num_di_blocks,
-                              y_l,
-                              y_r,
-                              &(ctx->y_r));
+    encrypt_hash_pair(ctx,
+                      ZCZ_DOMAIN_YL,
+                      ZCZ_DOMAIN_YR,
+                      num_di_blocks,
+                      y_l,
+                      y_r,
+                      &(values->y_l),
+                      &(values->y_r));
 }
 
 // ---------------------------------------------------------------------
 
-static void decrypt_last_di_block_top(zcz_ctx_t* ctx,
-                                      uint8_t* plaintext,
+static void decrypt_last_di_block_top(const zcz_ctx_t* ctx,
+                                      zcz_values_t* values,
+                                      uint8_t* final_full_di_block,
                                       const size_t num_di_blocks) {
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
+    const deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
 
     __m128i left_output_block;
     __m128i right_output_block;
@@ -959,62 +1834,58 @@ static void decrypt_last_di_block_top(zcz_ctx_t* ctx,
     deoxys_bc_128_384_decrypt(cipher_ctx,
                               ZCZ_DOMAIN_S_LAST,
                               num_di_blocks,
-                              ctx->s,
-                              ctx->t,
+                              values->s,
+                              values->t,
                               &right_output_block);
 
     deoxys_bc_128_384_decrypt(cipher_ctx,
                               ZCZ_DOMAIN_TOP_LAST,
                               num_di_blocks,
                               right_output_block,
-                              ctx->s,
+                              values->s,
                               &left_output_block);
 
-    left_output_block = vxor(left_output_block, ctx->x_l);
-    right_output_block = vxor(right_output_block, ctx->x_r);
-
-    uint8_t* left_plaintext_block =
-            plaintext + (num_di_blocks - 1) * ZCZ_NUM_BYTES_IN_DI_BLOCK;
-    uint8_t* right_plaintext_block =
-            left_plaintext_block + ZCZ_NUM_BYTES_IN_BLOCK;
+    left_output_block = vxor(left_output_block, values->x_l);
+    right_output_block = vxor(right_output_block, values->x_r);
 
-    storeu(left_plaintext_block, left_output_block);
-    storeu(right_plaintext_block, right_output_block);
+    storeu(final_full_di_block, left_output_block);
+    storeu((final_full_di_block + ZCZ_NUM_BYTES_IN_BLOCK), right_output_block);
 }
 
 // ---------------------------------------------------------------------
 
-static void decrypt_last_di_block_bottom(zcz_ctx_t* ctx,
+static void decrypt_last_di_block_bottom(const zcz_ctx_t* ctx,
+                                         zcz_values_t* values,
                                          const uint8_t* final_full_di_block,
                                          const size_t num_di_blocks) {
     __m128i left_input_block = load(final_full_di_block);
     __m128i right_input_block =
         load((final_full_di_block + ZCZ_NUM_BYTES_IN_BLOCK));
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
+    const deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
 
-    __m128i left_output_block = vxor(left_input_block, ctx->y_l);
-    __m128i right_output_block = vxor(right_input_block, ctx->y_r);
+    __m128i left_output_block = vxor(left_input_block, values->y_l);
+    __m128i right_output_block = vxor(right_input_block, values->y_r);
 
     deoxys_bc_128_384_decrypt(cipher_ctx,
                               ZCZ_DOMAIN_BOT_LAST,
                               num_di_blocks,
                               left_output_block,
                               right_output_block,
-                              &(ctx->t));
+                              &(values->t));
 
     deoxys_bc_128_384_decrypt(cipher_ctx,
                               ZCZ_DOMAIN_CENTER_LAST,
                               num_di_blocks,
-                              ctx->t,
+                              values->t,
                               left_output_block,
-                              &(ctx->s));
+                              &(values->s));
 }
 
 // ---------------------------------------------------------------------
 // Partial APIs
 // ---------------------------------------------------------------------
 
-static void encrypt_partial_top_layer(zcz_ctx_t* ctx,
+static void encrypt_partial_top_layer(const zcz_ctx_t* ctx,
                                       uint8_t* final_full_di_block,
                                       const uint8_t* hash_input,
                                       uint8_t* hash_output) {
@@ -1024,7 +1895,7 @@ static void encrypt_partial_top_layer(zcz_ctx_t* ctx,
 
 // ---------------------------------------------------------------------
 
-static void encrypt_partial_middle_layer(zcz_ctx_t* ctx,
+static void encrypt_partial_middle_layer(const zcz_ctx_t* ctx,
                                          uint8_t* hash_input,
                                          uint8_t* hash_output) {
     hash(ctx, hash_input, hash_output, ZCZ_COUNTER_PARTIAL_CENTER);
@@ -1032,7 +1903,7 @@ static void encrypt_partial_middle_layer(zcz_ctx_t* ctx,
 
 // ---------------------------------------------------------------------
 
-static void encrypt_partial_bottom_layer(zcz_ctx_t* ctx,
+static void encrypt_partial_bottom_layer(const zcz_ctx_t* ctx,
                                          uint8_t* final_full_di_block,
                                          const uint8_t* hash_input,
                                          uint8_t* hash_output) {
@@ -1044,45 +1915,93 @@ static void encrypt_partial_bottom_layer(zcz_ctx_t* ctx,
 // Internal APIs
 // ---------------------------------------------------------------------
 
-static void internal_zcz_basic_encrypt(zcz_ctx_t* ctx,
+static void internal_zcz_basic_encrypt(const zcz_ctx_t* ctx,
+                                       zcz_pool_t* pool,
                                        const uint8_t* plaintext,
                                        const uint8_t* final_full_di_block,
                                        const size_t num_plaintext_bytes,
                                        uint8_t* ciphertext) {
     const size_t num_di_blocks = get_num_full_di_blocks(num_plaintext_bytes);
-    uint8_t* state = (uint8_t*)malloc(num_plaintext_bytes);
+    zcz_values_t values;
 
-    encrypt_top_layer(ctx, state, plaintext, num_di_blocks);
-    encrypt_last_di_block_top(ctx, final_full_di_block, num_di_blocks);
-    encrypt_middle_layer(ctx, state, num_di_blocks);
-    encrypt_bottom_layer(ctx, state, ciphertext, num_di_blocks);
-    encrypt_last_di_block_bottom(ctx, ciphertext, num_di_blocks);
+    // ---------------------------------------------------------------------
+    // The top layer writes X_i || R_i directly to the ciphertext; the fused
+    // middle and bottom pass then works in place there. Each pass reads a
+    // sequence before it writes it, so plaintext may be equal to ciphertext.
+    // The last di-block is read before the final layer overwrites it.
+    // ---------------------------------------------------------------------
 
-    free(state);
+    stats_start(t);
+    encrypt_top_layer(ctx,
+                      pool,
+                      &values,
+                      ciphertext,
+                      plaintext,
+                      num_di_blocks);
+    stats_record(ctx, ZCZ_STATS_FIRST_PASS, t);
+    encrypt_last_di_block_top(ctx,
+                              &values,
+                              final_full_di_block,
+                              num_di_blocks);
+    stats_record(ctx, ZCZ_STATS_FIRST_LAST_DI_BLOCK, t);
+    encrypt_middle_and_bottom_layers(ctx,
+                                     pool,
+                                     &values,
+                                     ciphertext,
+                                     num_di_blocks);
+    stats_record(ctx, ZCZ_STATS_SECOND_PASS, t);
+    encrypt_last_di_block_bottom(ctx,
+                                 &values,
+                                 (ciphertext + (num_di_blocks - 1)
+                                     * ZCZ_NUM_BYTES_IN_DI_BLOCK),
+                                 num_di_blocks);
+    stats_record(ctx, ZCZ_STATS_SECOND_LAST_DI_BLOCK, t);
+    stats_count(ctx);
 }
 
 // ---------------------------------------------------------------------
 
-static void internal_zcz_basic_decrypt(zcz_ctx_t* ctx,
+static void internal_zcz_basic_decrypt(const zcz_ctx_t* ctx,
+                                       zcz_pool_t* pool,
                                        const uint8_t* ciphertext,
                                        const uint8_t* final_full_di_block,
                                        const size_t num_ciphertext_bytes,
                                        uint8_t* plaintext) {
     const size_t num_di_blocks = get_num_full_di_blocks(num_ciphertext_bytes);
-    uint8_t* state = (uint8_t*)malloc(num_ciphertext_bytes);
-
-    decrypt_bottom_layer(ctx, state, ciphertext, num_di_blocks);
-    decrypt_last_di_block_bottom(ctx, final_full_di_block, num_di_blocks);
-    decrypt_middle_layer(ctx, state, num_di_blocks);
-    decrypt_top_layer(ctx, state, plaintext, num_di_blocks);
-    decrypt_last_di_block_top(ctx, plaintext, num_di_blocks);
-
-    free(state);
+    zcz_values_t values;
+
+    stats_start(t);
+    decrypt_bottom_layer(ctx,
+                         pool,
+                         &values,
+                         plaintext,
+                         ciphertext,
+                         num_di_blocks);
+    stats_record(ctx, ZCZ_STATS_FIRST_PASS, t);
+    decrypt_last_di_block_bottom(ctx,
+                                 &values,
+                                 final_full_di_block,
+                                 num_di_blocks);
+    stats_record(ctx, ZCZ_STATS_FIRST_LAST_DI_BLOCK, t);
+    decrypt_middle_and_top_layers(ctx,
+                                  pool,
+                                  &values,
+                                  plaintext,
+                                  num_di_blocks);
+    stats_record(ctx, ZCZ_STATS_SECOND_PASS, t);
+    decrypt_last_di_block_top(ctx,
+                              &values,
+                              (plaintext + (num_di_blocks - 1)
+                                  * ZCZ_NUM_BYTES_IN_DI_BLOCK),
+                              num_di_blocks);
+    stats_record(ctx, ZCZ_STATS_SECOND_LAST_DI_BLOCK, t);
+    stats_count(ctx);
 }
 
 // ---------------------------------------------------------------------
 
-static void internal_zcz_encrypt(zcz_ctx_t* ctx,
+static void internal_zcz_encrypt(const zcz_ctx_t* ctx,
+                                 zcz_pool_t* pool,
                                  const uint8_t* plaintext,
                                  const size_t num_plaintext_bytes,
                                  uint8_t* ciphertext) {
@@ -1102,6 +2021,7 @@ static void internal_zcz_encrypt(zcz_ctx_t* ctx,
     // Copy and pad the partial di-block
     // ---------------------------------------------------------------------
 
+    stats_start(t);
     uint8_t padded_final_di_block[ZCZ_NUM_BYTES_IN_DI_BLOCK];
     memcpy(padded_final_di_block,
            plaintext + num_bytes_in_full_di_blocks,
@@ -1129,16 +2049,19 @@ static void internal_zcz_encrypt(zcz_ctx_t* ctx,
 
     // We stored M_l xor H[E,0] in top_hash_output since we need it later
     memcpy(top_hash_output, final_full_di_block, ZCZ_NUM_BYTES_IN_DI_BLOCK);
+    stats_record(ctx, ZCZ_STATS_PARTIAL_DI_BLOCK, t);
 
     // ---------------------------------------------------------------------
     // Perform ZCZ basic encryption on the full di-blocks
     // ---------------------------------------------------------------------
 
     internal_zcz_basic_encrypt(ctx,
+                               pool,
                                plaintext,
                                final_full_di_block,
                                num_bytes_in_full_di_blocks,
                                ciphertext);
+    stats_restart(t);
 
     // ---------------------------------------------------------------------
     // Middle layer
@@ -1191,11 +2114,13 @@ static void internal_zcz_encrypt(zcz_ctx_t* ctx,
     memcpy(ciphertext + num_bytes_in_full_di_blocks,
            padded_final_di_block,
            num_remaining_bytes);
+    stats_record(ctx, ZCZ_STATS_PARTIAL_DI_BLOCK, t);
 }
 
 // ---------------------------------------------------------------------
 
-static void internal_zcz_decrypt(zcz_ctx_t* ctx,
+static void internal_zcz_decrypt(const zcz_ctx_t* ctx,
+                                 zcz_pool_t* pool,
                                  const uint8_t* ciphertext,
                                  const size_t num_ciphertext_bytes,
                                  uint8_t* plaintext) {
@@ -1215,6 +2140,7 @@ static void internal_zcz_decrypt(zcz_ctx_t* ctx,
     // Copy and pad the partial di-block
     // ---------------------------------------------------------------------
 
+    stats_start(t);
     uint8_t padded_final_di_block[ZCZ_NUM_BYTES_IN_DI_BLOCK];
     memcpy(padded_final_di_block,
            ciphertext + num_bytes_in_full_di_blocks,
@@ -1241,16 +2167,19 @@ static void internal_zcz_decrypt(zcz_ctx_t* ctx,
 
     // Copy the final di-block to XOR it later on
     memcpy(bottom_hash_output, final_full_di_block, ZCZ_NUM_BYTES_IN_DI_BLOCK);
+    stats_record(ctx, ZCZ_STATS_PARTIAL_DI_BLOCK, t);
 
     // ---------------------------------------------------------------------
     // Perform ZCZ basic encryption on the full di-blocks
     // ---------------------------------------------------------------------
 
     internal_zcz_basic_decrypt(ctx,
+                               pool,
                                ciphertext,
                                final_full_di_block,
                                num_bytes_in_full_di_blocks,
                                plaintext);
+    stats_restart(t);
 
     // ---------------------------------------------------------------------
     // Middle layer
@@ -1302,108 +2231,1434 @@ static void internal_zcz_decrypt(zcz_ctx_t* ctx,
     memcpy(plaintext + num_bytes_in_full_di_blocks,
            padded_final_di_block,
            num_remaining_bytes);
+    stats_record(ctx, ZCZ_STATS_PARTIAL_DI_BLOCK, t);
 }
 
 // ---------------------------------------------------------------------
-// Public API
+// Recompute functions
 // ---------------------------------------------------------------------
 
-void zcz_keysetup(zcz_ctx_t* ctx, const zcz_key_t key) {
-    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
-    deoxys_bc_128_384_setup_key(cipher_ctx, loadu(key));
-    deoxys_bc_128_384_setup_decryption_key(cipher_ctx);
+/**
+ * Returns how many of the num_di_blocks di-blocks from first_di_block on
+ * fit into the chunk-sized buffer of the recompute functions.
+ */
+static size_t get_num_di_blocks_in_buffer(const size_t first_di_block,
+                                          const size_t num_di_blocks) {
+    const size_t num_remaining_di_blocks = num_di_blocks - first_di_block;
+
+    if (num_remaining_di_blocks < ZCZ_NUM_DI_BLOCKS_IN_CHUNK) {
+        return num_remaining_di_blocks;
+    }
+
+    return ZCZ_NUM_DI_BLOCKS_IN_CHUNK;
 }
 
 // ---------------------------------------------------------------------
 
-void zcz_basic_encrypt(zcz_ctx_t* ctx,
-                       const uint8_t* plaintext,
-                       const size_t num_plaintext_bytes,
-                       uint8_t* ciphertext) {
-    if (is_length_ok_for_zcz_basic(num_plaintext_bytes)) {
-        const size_t start_of_last_full_di_block = num_plaintext_bytes
-            - ZCZ_NUM_BYTES_IN_DI_BLOCK;
-        const uint8_t* final_full_di_block = plaintext
-            + start_of_last_full_di_block;
+/**
+ * Like internal_zcz_encrypt(), but with one chunk of memory. The first pass
+ * over the plaintext only hashes the top layer to obtain S and T. The second
+ * pass recomputes the top layer chunk by chunk, and hands each chunk of
+ * ciphertext to the output after the middle and bottom layers.
+ */
+static void internal_zcz_encrypt_recompute(const zcz_ctx_t* ctx,
+                                           const uint8_t* plaintext,
+                                           const size_t num_plaintext_bytes,
+                                           zcz_output_fn output,
+                                           void* output_context) {
+    const size_t num_full_di_blocks =
+        get_num_full_di_blocks(num_plaintext_bytes);
 
-        internal_zcz_basic_encrypt(ctx,
-                                   plaintext,
-                                   final_full_di_block,
-                                   num_plaintext_bytes,
-                                   ciphertext);
-    }
-}
+    const size_t num_bytes_in_full_di_blocks =
+        num_full_di_blocks * ZCZ_NUM_BYTES_IN_DI_BLOCK;
 
-// ---------------------------------------------------------------------
+    const size_t num_remaining_bytes =
+        num_plaintext_bytes % ZCZ_NUM_BYTES_IN_DI_BLOCK;
 
-void zcz_basic_decrypt(zcz_ctx_t* ctx,
-                       const uint8_t* ciphertext,
-                       const size_t num_ciphertext_bytes,
-                       uint8_t* plaintext) {
-    if (is_length_ok_for_zcz_basic(num_ciphertext_bytes)) {
-        const size_t start_of_last_full_di_block = num_ciphertext_bytes
-          - ZCZ_NUM_BYTES_IN_DI_BLOCK;
-        const uint8_t* final_full_di_block = ciphertext
-          + start_of_last_full_di_block;
+    const size_t start_of_last_full_di_block =
+        num_bytes_in_full_di_blocks - ZCZ_NUM_BYTES_IN_DI_BLOCK;
 
-        internal_zcz_basic_decrypt(ctx,
-                                   ciphertext,
-                                   final_full_di_block,
-                                   num_ciphertext_bytes,
-                                   plaintext);
-    }
-}
+    // Lengths of ZCZ basic are encrypted without the partial layers
+    const int has_partial_layers =
+        !is_length_ok_for_zcz_basic(num_plaintext_bytes);
 
-// ---------------------------------------------------------------------
+    // The final di-block is processed separately
+    const size_t num_di_blocks = num_full_di_blocks - 1;
 
-void zcz_encrypt(zcz_ctx_t* ctx,
-                 const uint8_t* plaintext,
-                 const size_t num_plaintext_bytes,
-                 uint8_t* ciphertext) {
-    if (is_length_ok_for_zcz_basic(num_plaintext_bytes)) {
-        const size_t start_of_last_full_di_block = num_plaintext_bytes
-          - ZCZ_NUM_BYTES_IN_DI_BLOCK;
-        const uint8_t* final_full_di_block = plaintext
-          + start_of_last_full_di_block;
+    ALIGN(32) uint8_t buffer[ZCZ_NUM_BYTES_IN_CHUNK];
+    uint8_t padded_final_di_block[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t final_full_di_block[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t top_hash_output[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t middle_hash_output[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t bottom_hash_output[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    zcz_values_t values;
 
-        internal_zcz_basic_encrypt(ctx,
-                                   plaintext,
-                                   final_full_di_block,
-                                   num_plaintext_bytes,
-                                   ciphertext);
-        return;
-    }
+    __m128i x_l = vzero;
+    __m128i x_r = vzero;
+    __m128i y_l = vzero;
+    __m128i y_r = vzero;
 
-    if (!is_length_ok_for_zcz(num_plaintext_bytes)) {
-        return;
+    memcpy(final_full_di_block,
+           plaintext + start_of_last_full_di_block,
+           ZCZ_NUM_BYTES_IN_DI_BLOCK);
+
+    if (has_partial_layers) {
+        memcpy(padded_final_di_block,
+               plaintext + num_bytes_in_full_di_blocks,
+               num_remaining_bytes);
+        pad_message(padded_final_di_block,
+                    num_remaining_bytes,
+                    ZCZ_NUM_BYTES_IN_DI_BLOCK);
+
+        encrypt_partial_top_layer(ctx,
+                                  final_full_di_block,
+                                  padded_final_di_block,
+                                  top_hash_output);
+
+        // We need M_l xor H[E,0] later for the middle hash
+        memcpy(top_hash_output,
+               final_full_di_block,
+               ZCZ_NUM_BYTES_IN_DI_BLOCK);
     }
 
-    internal_zcz_encrypt(ctx, plaintext, num_plaintext_bytes, ciphertext);
-}
+    // ---------------------------------------------------------------------
+    // First pass: X_L and X_R, and from them S and T
+    // ---------------------------------------------------------------------
 
-// ---------------------------------------------------------------------
+    for (size_t i = 0; i < num_di_blocks; i += ZCZ_NUM_DI_BLOCKS_IN_CHUNK) {
+        encrypt_top_di_blocks(ctx,
+                              buffer,
+                              plaintext + i * ZCZ_NUM_BYTES_IN_DI_BLOCK,
+                              i,
+                              get_num_di_blocks_in_buffer(i, num_di_blocks),
+                              &x_l,
+                              &x_r);
+    }
 
-void zcz_decrypt(zcz_ctx_t* ctx,
-                 const uint8_t* ciphertext,
-                 const size_t num_ciphertext_bytes,
-                 uint8_t* plaintext) {
-    if (is_length_ok_for_zcz_basic(num_ciphertext_bytes)) {
-        const size_t start_of_last_full_di_block = num_ciphertext_bytes
-          - ZCZ_NUM_BYTES_IN_DI_BLOCK;
-        const uint8_t* final_full_di_block = ciphertext
-          + start_of_last_full_di_block;
+    encrypt_hash_pair(ctx,
+                      ZCZ_DOMAIN_XL,
+                      ZCZ_DOMAIN_XR,
+                      num_full_di_blocks,
+                      x_l,
+                      x_r,
+                      &(values.x_l),
+                      &(values.x_r));
+    encrypt_last_di_block_top(ctx,
+                              &values,
+                              final_full_di_block,
+                              num_full_di_blocks);
 
-        internal_zcz_basic_decrypt(ctx,
-                                   ciphertext,
-                                   final_full_di_block,
-                                   num_ciphertext_bytes,
-                                   plaintext);
-        return;
+    // ---------------------------------------------------------------------
+    // Second pass: all layers, chunk by chunk. X_L and X_R are recomputed,
+    // but not needed anymore.
+    // ---------------------------------------------------------------------
+
+    for (size_t i = 0; i < num_di_blocks; i += ZCZ_NUM_DI_BLOCKS_IN_CHUNK) {
+        const size_t num_buffer_di_blocks =
+            get_num_di_blocks_in_buffer(i, num_di_blocks);
+
+        encrypt_top_di_blocks(ctx,
+                              buffer,
+                              plaintext + i * ZCZ_NUM_BYTES_IN_DI_BLOCK,
+                              i,
+                              num_buffer_di_blocks,
+                              &x_l,
+                              &x_r);
+        encrypt_middle_and_bottom_di_blocks(ctx,
+                                            &values,
+                                            buffer,
+                                            i,
+                                            num_buffer_di_blocks,
+                                            &y_l,
+                                            &y_r);
+        output(output_context,
+               buffer,
+               num_buffer_di_blocks * ZCZ_NUM_BYTES_IN_DI_BLOCK);
     }
 
-    if (!is_length_ok_for_zcz(num_ciphertext_bytes)) {
-        return;
+    encrypt_hash_pair(ctx,
+                      ZCZ_DOMAIN_YL,
+                      ZCZ_DOMAIN_YR,
+                      num_full_di_blocks,
+                      y_l,
+                      y_r,
+                      &(values.y_l),
+                      &(values.y_r));
+    encrypt_last_di_block_bottom(ctx,
+                                 &values,
+                                 final_full_di_block,
+                                 num_full_di_blocks);
+
+    if (has_partial_layers) {
+        vxor_di_block(top_hash_output, final_full_di_block);
+        encrypt_partial_middle_layer(ctx,
+                                     top_hash_output,
+                                     middle_hash_output);
+        vxor_di_block(padded_final_di_block, middle_hash_output);
+
+        pad_message(padded_final_di_block,
+                    num_remaining_bytes,
+                    ZCZ_NUM_BYTES_IN_DI_BLOCK);
+        encrypt_partial_bottom_layer(ctx,
+                                     final_full_di_block,
+                                     padded_final_di_block,
+                                     bottom_hash_output);
     }
 
-    internal_zcz_decrypt(ctx, ciphertext, num_ciphertext_bytes, plaintext);
-}
+    output(output_context, final_full_di_block, ZCZ_NUM_BYTES_IN_DI_BLOCK);
+
+    if (num_remaining_bytes > 0) {
+        output(output_context, padded_final_di_block, num_remaining_bytes);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Decryption counterpart of internal_zcz_encrypt_recompute(). The first pass
+ * over the ciphertext only hashes the bottom layer.
+ */
+static void internal_zcz_decrypt_recompute(const zcz_ctx_t* ctx,
+                                           const uint8_t* ciphertext,
+                                           const size_t num_ciphertext_bytes,
+                                           zcz_output_fn output,
+                                           void* output_context) {
+    const size_t num_full_di_blocks =
+        get_num_full_di_blocks(num_ciphertext_bytes);
+
+    const size_t num_bytes_in_full_di_blocks =
+        num_full_di_blocks * ZCZ_NUM_BYTES_IN_DI_BLOCK;
+
+    const size_t num_remaining_bytes =
+        num_ciphertext_bytes % ZCZ_NUM_BYTES_IN_DI_BLOCK;
+
+    const size_t start_of_last_full_di_block =
+        num_bytes_in_full_di_blocks - ZCZ_NUM_BYTES_IN_DI_BLOCK;
+
+    // Lengths of ZCZ basic are decrypted without the partial layers
+    const int has_partial_layers =
+        !is_length_ok_for_zcz_basic(num_ciphertext_bytes);
+
+    // The final di-block is processed separately
+    const size_t num_di_blocks = num_full_di_blocks - 1;
+
+    ALIGN(32) uint8_t buffer[ZCZ_NUM_BYTES_IN_CHUNK];
+    uint8_t padded_final_di_block[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t final_full_di_block[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t top_hash_output[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t middle_hash_output[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t bottom_hash_output[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    zcz_values_t values;
+
+    __m128i x_l = vzero;
+    __m128i x_r = vzero;
+    __m128i y_l = vzero;
+    __m128i y_r = vzero;
+
+    memcpy(final_full_di_block,
+           ciphertext + start_of_last_full_di_block,
+           ZCZ_NUM_BYTES_IN_DI_BLOCK);
+
+    if (has_partial_layers) {
+        memcpy(padded_final_di_block,
+               ciphertext + num_bytes_in_full_di_blocks,
+               num_remaining_bytes);
+        pad_message(padded_final_di_block,
+                    num_remaining_bytes,
+                    ZCZ_NUM_BYTES_IN_DI_BLOCK);
+
+        encrypt_partial_bottom_layer(ctx,
+                                     final_full_di_block,
+                                     padded_final_di_block,
+                                     bottom_hash_output);
+
+        // We need C_l xor H[E,2] later for the middle hash
+        memcpy(bottom_hash_output,
+               final_full_di_block,
+               ZCZ_NUM_BYTES_IN_DI_BLOCK);
+    }
+
+    // ---------------------------------------------------------------------
+    // First pass: Y_L and Y_R, and from them S and T
+    // ---------------------------------------------------------------------
+
+    for (size_t i = 0; i < num_di_blocks; i += ZCZ_NUM_DI_BLOCKS_IN_CHUNK) {
+        decrypt_bottom_di_blocks(ctx,
+                                 buffer,
+                                 ciphertext + i * ZCZ_NUM_BYTES_IN_DI_BLOCK,
+                                 i,
+                                 get_num_di_blocks_in_buffer(i,
+                                                             num_di_blocks),
+                                 &y_l,
+                                 &y_r);
+    }
+
+    encrypt_hash_pair(ctx,
+                      ZCZ_DOMAIN_YL,
+                      ZCZ_DOMAIN_YR,
+                      num_full_di_blocks,
+                      y_l,
+                      y_r,
+                      &(values.y_l),
+                      &(values.y_r));
+    decrypt_last_di_block_bottom(ctx,
+                                 &values,
+                                 final_full_di_block,
+                                 num_full_di_blocks);
+
+    // ---------------------------------------------------------------------
+    // Second pass: all layers, chunk by chunk. Y_L and Y_R are recomputed,
+    // but not needed anymore.
+    // ---------------------------------------------------------------------
+
+    for (size_t i = 0; i < num_di_blocks; i += ZCZ_NUM_DI_BLOCKS_IN_CHUNK) {
+        const size_t num_buffer_di_blocks =
+            get_num_di_blocks_in_buffer(i, num_di_blocks);
+
+        decrypt_bottom_di_blocks(ctx,
+                                 buffer,
+                                 ciphertext + i * ZCZ_NUM_BYTES_IN_DI_BLOCK,
+                                 i,
+                                 num_buffer_di_blocks,
+                                 &y_l,
+                                 &y_r);
+        decrypt_middle_and_top_di_blocks(ctx,
+                                         &values,
+                                         buffer,
+                                         i,
+                                         num_buffer_di_blocks,
+                                         &x_l,
+                                         &x_r);
+        output(output_context,
+               buffer,
+               num_buffer_di_blocks * ZCZ_NUM_BYTES_IN_DI_BLOCK);
+    }
+
+    encrypt_hash_pair(ctx,
+                      ZCZ_DOMAIN_XL,
+                      ZCZ_DOMAIN_XR,
+                      num_full_di_blocks,
+                      x_l,
+                      x_r,
+                      &(values.x_l),
+                      &(values.x_r));
+    decrypt_last_di_block_top(ctx,
+                              &values,
+                              final_full_di_block,
+                              num_full_di_blocks);
+
+    if (has_partial_layers) {
+        vxor_di_block(bottom_hash_output, final_full_di_block);
+        encrypt_partial_middle_layer(ctx,
+                                     bottom_hash_output,
+                                     middle_hash_output);
+        vxor_di_block(padded_final_di_block, middle_hash_output);
+
+        pad_message(padded_final_di_block,
+                    num_remaining_bytes,
+                    ZCZ_NUM_BYTES_IN_DI_BLOCK);
+        encrypt_partial_top_layer(ctx,
+                                  final_full_di_block,
+                                  padded_final_di_block,
+                                  top_hash_output);
+    }
+
+    output(output_context, final_full_di_block, ZCZ_NUM_BYTES_IN_DI_BLOCK);
+
+    if (num_remaining_bytes > 0) {
+        output(output_context, padded_final_di_block, num_remaining_bytes);
+    }
+}
+
+// ---------------------------------------------------------------------
+// Multi-message functions
+// ---------------------------------------------------------------------
+
+#define ZCZ_MANY_NUM_MESSAGES    DEOXYS_BC_MAX_BATCH_SIZE
+#define ZCZ_MANY_MAX_NUM_LANES \
+    (ZCZ_MANY_NUM_MESSAGES * ZCZ_MANY_MAX_NUM_DI_BLOCKS)
+
+/**
+ * Independent block-cipher calls of several messages. They are collected
+ * for one step of all messages of a group, and then run in batches of
+ * DEOXYS_BC_MAX_BATCH_SIZE lanes.
+ */
+typedef struct {
+    __m128i tweaks[ZCZ_MANY_MAX_NUM_LANES];
+    __m128i states[ZCZ_MANY_MAX_NUM_LANES];
+    size_t counters[ZCZ_MANY_MAX_NUM_LANES];
+    uint8_t domains[ZCZ_MANY_MAX_NUM_LANES];
+    size_t num_lanes;
+} zcz_lanes_t;
+
+/**
+ * Per-message state of zcz_encrypt_many() and zcz_decrypt_many().
+ */
+typedef struct {
+    zcz_values_t values;
+    const uint8_t* in;
+    uint8_t* out;
+    size_t num_di_blocks;
+    size_t num_remaining_bytes;
+    size_t first_lane;
+    uint8_t final_full_di_block[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t padded_final_di_block[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    uint8_t hash_output[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+} zcz_message_state_t;
+
+// ---------------------------------------------------------------------
+
+static void set_lane(zcz_lanes_t* lanes,
+                     const size_t index,
+                     const uint8_t domain,
+                     const size_t counter,
+                     const __m128i tweak,
+                     const __m128i state) {
+    lanes->domains[index] = domain;
+    lanes->counters[index] = counter;
+    lanes->tweaks[index] = tweak;
+    lanes->states[index] = state;
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Appends a lane and returns its index.
+ */
+static size_t add_lane(zcz_lanes_t* lanes,
+                       const uint8_t domain,
+                       const size_t counter,
+                       const __m128i tweak,
+                       const __m128i state) {
+    const size_t index = lanes->num_lanes;
+    set_lane(lanes, index, domain, counter, tweak, state);
+    lanes->num_lanes++;
+    return index;
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Appends the two lanes of hash() and returns the index of the first.
+ */
+static size_t add_hash_lanes(zcz_lanes_t* lanes,
+                             const uint8_t* input,
+                             const size_t domain) {
+    const __m128i u = loadu(input);
+    const __m128i v = loadu((input + ZCZ_NUM_BYTES_IN_BLOCK));
+    const size_t index = add_lane(lanes, ZCZ_DOMAIN_PARTIAL, domain, v, u);
+    add_lane(lanes, ZCZ_DOMAIN_PARTIAL, domain + 1, v, u);
+    return index;
+}
+
+// ---------------------------------------------------------------------
+
+static void store_hash_lanes(const zcz_lanes_t* lanes,
+                             const size_t index,
+                             uint8_t* output) {
+    storeu(output, lanes->states[index]);
+    storeu((output + ZCZ_NUM_BYTES_IN_BLOCK), lanes->states[index + 1]);
+}
+
+// ---------------------------------------------------------------------
+
+static void encrypt_lanes(const zcz_ctx_t* ctx, zcz_lanes_t* lanes) {
+    for (size_t i = 0; i < lanes->num_lanes; i += DEOXYS_BC_MAX_BATCH_SIZE) {
+        size_t num_batch_lanes = lanes->num_lanes - i;
+
+        if (num_batch_lanes > DEOXYS_BC_MAX_BATCH_SIZE) {
+            num_batch_lanes = DEOXYS_BC_MAX_BATCH_SIZE;
+        }
+
+        deoxys_bc_128_384_encrypt_batch(&(ctx->cipher_ctx),
+                                        num_batch_lanes,
+                                        (lanes->domains + i),
+                                        (lanes->counters + i),
+                                        (lanes->tweaks + i),
+                                        (lanes->states + i));
+    }
+}
+
+// ---------------------------------------------------------------------
+
+static void decrypt_lanes(const zcz_ctx_t* ctx, zcz_lanes_t* lanes) {
+    for (size_t i = 0; i < lanes->num_lanes; i += DEOXYS_BC_MAX_BATCH_SIZE) {
+        size_t num_batch_lanes = lanes->num_lanes - i;
+
+        if (num_batch_lanes > DEOXYS_BC_MAX_BATCH_SIZE) {
+            num_batch_lanes = DEOXYS_BC_MAX_BATCH_SIZE;
+        }
+
+        deoxys_bc_128_384_decrypt_batch(&(ctx->cipher_ctx),
+                                        num_batch_lanes,
+                                        (lanes->domains + i),
+                                        (lanes->counters + i),
+                                        (lanes->tweaks + i),
+                                        (lanes->states + i));
+    }
+}
+
+// ---------------------------------------------------------------------
+
+static int is_length_ok_for_many(const size_t num_bytes) {
+    return is_length_ok_for_zcz(num_bytes)
+        && (get_num_full_di_blocks(num_bytes) <= ZCZ_MANY_MAX_NUM_DI_BLOCKS);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Copies the last full and the padded partial di-block of each message,
+ * like internal_zcz_encrypt() and internal_zcz_decrypt() do.
+ */
+static void init_message_states(zcz_message_state_t* states,
+                                const zcz_message_t* group[],
+                                const size_t num_messages) {
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_message_state_t* state = states + m;
+        const size_t num_bytes = group[m]->num_bytes;
+
+        state->in = group[m]->in;
+        state->out = group[m]->out;
+        state->num_di_blocks = get_num_full_di_blocks(num_bytes);
+        state->num_remaining_bytes = num_bytes % ZCZ_NUM_BYTES_IN_DI_BLOCK;
+
+        memcpy(state->final_full_di_block,
+               state->in
+               + (state->num_di_blocks - 1) * ZCZ_NUM_BYTES_IN_DI_BLOCK,
+               ZCZ_NUM_BYTES_IN_DI_BLOCK);
+
+        if (state->num_remaining_bytes > 0) {
+            memcpy(state->padded_final_di_block,
+                   state->in
+                   + state->num_di_blocks * ZCZ_NUM_BYTES_IN_DI_BLOCK,
+                   state->num_remaining_bytes);
+            pad_message(state->padded_final_di_block,
+                        state->num_remaining_bytes,
+                        ZCZ_NUM_BYTES_IN_DI_BLOCK);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Hashes the padded partial di-block of all messages that have one, and
+ * XORs the result to their last full di-block. If keep_output is set, the
+ * result is also kept in hash_output, for the middle hash later on.
+ */
+static void hash_partial_di_blocks(const zcz_ctx_t* ctx,
+                                   zcz_message_state_t* states,
+                                   const size_t num_messages,
+                                   zcz_lanes_t* lanes,
+                                   const size_t domain,
+                                   const int keep_output) {
+    uint8_t hash_output[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    lanes->num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        if (states[m].num_remaining_bytes > 0) {
+            states[m].first_lane =
+                add_hash_lanes(lanes, states[m].padded_final_di_block, domain);
+        }
+    }
+
+    encrypt_lanes(ctx, lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_message_state_t* state = states + m;
+
+        if (state->num_remaining_bytes > 0) {
+            store_hash_lanes(lanes, state->first_lane, hash_output);
+            vxor_di_block(state->final_full_di_block, hash_output);
+
+            if (keep_output) {
+                memcpy(state->hash_output,
+                       state->final_full_di_block,
+                       ZCZ_NUM_BYTES_IN_DI_BLOCK);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Finishes the partial di-blocks after the basic encryption or decryption:
+ * the middle hash of the last full di-block of the output, then the outer
+ * hash with the given domain, as in internal_zcz_encrypt().
+ */
+static void finalize_partial_di_blocks(const zcz_ctx_t* ctx,
+                                       zcz_message_state_t* states,
+                                       const size_t num_messages,
+                                       zcz_lanes_t* lanes,
+                                       const size_t domain) {
+    uint8_t middle_hash_output[ZCZ_NUM_BYTES_IN_DI_BLOCK];
+    lanes->num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_message_state_t* state = states + m;
+
+        if (state->num_remaining_bytes > 0) {
+            memcpy(state->final_full_di_block,
+                   state->out
+                   + (state->num_di_blocks - 1) * ZCZ_NUM_BYTES_IN_DI_BLOCK,
+                   ZCZ_NUM_BYTES_IN_DI_BLOCK);
+            vxor_di_block(state->hash_output, state->final_full_di_block);
+            state->first_lane = add_hash_lanes(lanes,
+                                               state->hash_output,
+                                               ZCZ_COUNTER_PARTIAL_CENTER);
+        }
+    }
+
+    encrypt_lanes(ctx, lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_message_state_t* state = states + m;
+
+        if (state->num_remaining_bytes > 0) {
+            store_hash_lanes(lanes, state->first_lane, middle_hash_output);
+            vxor_di_block(state->padded_final_di_block, middle_hash_output);
+            pad_message(state->padded_final_di_block,
+                        state->num_remaining_bytes,
+                        ZCZ_NUM_BYTES_IN_DI_BLOCK);
+        }
+    }
+
+    hash_partial_di_blocks(ctx, states, num_messages, lanes, domain, 0);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_message_state_t* state = states + m;
+        const size_t num_bytes_in_full_di_blocks =
+            state->num_di_blocks * ZCZ_NUM_BYTES_IN_DI_BLOCK;
+
+        if (state->num_remaining_bytes > 0) {
+            memcpy(state->out
+                   + num_bytes_in_full_di_blocks - ZCZ_NUM_BYTES_IN_DI_BLOCK,
+                   state->final_full_di_block,
+                   ZCZ_NUM_BYTES_IN_DI_BLOCK);
+            memcpy(state->out + num_bytes_in_full_di_blocks,
+                   state->padded_final_di_block,
+                   state->num_remaining_bytes);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Finalizes the hash pairs (left, right) = (X_L, X_R) or (Y_L, Y_R) of all
+ * messages, like encrypt_hash_pair(). The inputs are passed in and returned
+ * in the same fields of the values.
+ */
+static void encrypt_hash_pairs(const zcz_ctx_t* ctx,
+                               zcz_message_state_t* states,
+                               const size_t num_messages,
+                               zcz_lanes_t* lanes,
+                               const uint8_t left_domain,
+                               const uint8_t right_domain,
+                               const int is_top) {
+    lanes->num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_values_t* values = &(states[m].values);
+        const size_t n = states[m].num_di_blocks;
+        const __m128i l = is_top ? values->x_l : values->y_l;
+        const __m128i r = is_top ? values->x_r : values->y_r;
+
+        states[m].first_lane = add_lane(lanes, left_domain, n, r, l);
+        add_lane(lanes, right_domain, n, l, r);
+    }
+
+    encrypt_lanes(ctx, lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_values_t* values = &(states[m].values);
+        const size_t i = states[m].first_lane;
+
+        if (is_top) {
+            values->x_l = lanes->states[i];
+            values->x_r = lanes->states[i + 1];
+        } else {
+            values->y_l = lanes->states[i];
+            values->y_r = lanes->states[i + 1];
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Computes S_1 = E_K^{s, 0, 1}(S) of all messages. Their middle layer fits
+ * into a single chunk, so S_1 is the only S_i they need.
+ */
+static void encrypt_s_lanes(const zcz_ctx_t* ctx,
+                            zcz_message_state_t* states,
+                            const size_t num_messages,
+                            zcz_lanes_t* lanes,
+                            __m128i s_1[ZCZ_MANY_NUM_MESSAGES]) {
+    lanes->num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        states[m].first_lane = add_lane(lanes,
+                                        ZCZ_DOMAIN_S,
+                                        0,
+                                        set64(1L, 0L),
+                                        states[m].values.s);
+    }
+
+    encrypt_lanes(ctx, lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        s_1[m] = lanes->states[states[m].first_lane];
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Adds the lanes of Z_{1,j} = E_K^{c, j, T}(S_1) for j = 1 .. n - 1 of all
+ * messages.
+ */
+static void add_center_lanes(zcz_message_state_t* states,
+                             const size_t num_messages,
+                             zcz_lanes_t* lanes,
+                             const __m128i s_1[ZCZ_MANY_NUM_MESSAGES]) {
+    lanes->num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        states[m].first_lane = lanes->num_lanes;
+
+        for (size_t k = 1; k < states[m].num_di_blocks; ++k) {
+            add_lane(lanes, ZCZ_DOMAIN_CENTER, k, states[m].values.t, s_1[m]);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+static void encrypt_group(const zcz_ctx_t* ctx,
+                          const zcz_message_t* group[],
+                          const size_t num_messages) {
+    zcz_message_state_t states[ZCZ_MANY_NUM_MESSAGES];
+    zcz_lanes_t lanes;
+    __m128i s_1[ZCZ_MANY_NUM_MESSAGES];
+    __m128i tmp;
+
+    init_message_states(states, group, num_messages);
+    hash_partial_di_blocks(ctx,
+                           states,
+                           num_messages,
+                           &lanes,
+                           ZCZ_COUNTER_PARTIAL_TOP,
+                           1);
+
+    // ---------------------------------------------------------------------
+    // Top layer: X_i = E_K^{t, i, R_i}(L_i), written as X_i || R_i
+    // ---------------------------------------------------------------------
+
+    lanes.num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const uint8_t* source = states[m].in;
+        states[m].first_lane = lanes.num_lanes;
+
+        for (size_t i = 1; i < states[m].num_di_blocks; ++i) {
+            add_lane(&lanes,
+                     ZCZ_DOMAIN_TOP,
+                     i,
+                     loadu((source + ZCZ_NUM_BYTES_IN_BLOCK)),
+                     loadu(source));
+            source += ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        }
+    }
+
+    encrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_values_t* values = &(states[m].values);
+        uint8_t* target = states[m].out;
+        __m128i x_l = vzero;
+        __m128i x_r = vzero;
+
+        for (size_t i = 0; i + 1 < states[m].num_di_blocks; ++i) {
+            const __m128i x_i = lanes.states[states[m].first_lane + i];
+            const __m128i r_i = lanes.tweaks[states[m].first_lane + i];
+
+            storeu(target, x_i);
+            storeu((target + ZCZ_NUM_BYTES_IN_BLOCK), r_i);
+
+            gf_2_128_double(x_l, x_l, tmp);
+            x_l = vxor(x_l, x_i);
+
+            gf_2_128_times_four(x_r, x_r, tmp);
+            x_r = vxor3(x_r, x_i, r_i);
+
+            target += ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        }
+
+        values->x_l = x_l;
+        values->x_r = x_r;
+    }
+
+    encrypt_hash_pairs(ctx,
+                       states,
+                       num_messages,
+                       &lanes,
+                       ZCZ_DOMAIN_XL,
+                       ZCZ_DOMAIN_XR,
+                       1);
+
+    // ---------------------------------------------------------------------
+    // Last di-block of the top layer: S, then T
+    // ---------------------------------------------------------------------
+
+    lanes.num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const uint8_t* block = states[m].final_full_di_block;
+        const zcz_values_t* values = &(states[m].values);
+        const __m128i left = vxor(loadu(block), values->x_l);
+        const __m128i right =
+            vxor(loadu((block + ZCZ_NUM_BYTES_IN_BLOCK)), values->x_r);
+
+        states[m].first_lane = add_lane(&lanes,
+                                        ZCZ_DOMAIN_TOP_LAST,
+                                        states[m].num_di_blocks,
+                                        right,
+                                        left);
+    }
+
+    encrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const uint8_t* block = states[m].final_full_di_block;
+        zcz_values_t* values = &(states[m].values);
+        const __m128i right =
+            vxor(loadu((block + ZCZ_NUM_BYTES_IN_BLOCK)), values->x_r);
+
+        values->s = lanes.states[states[m].first_lane];
+        set_lane(&lanes,
+                 states[m].first_lane,
+                 ZCZ_DOMAIN_S_LAST,
+                 states[m].num_di_blocks,
+                 values->s,
+                 right);
+    }
+
+    encrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        states[m].values.t = lanes.states[states[m].first_lane];
+    }
+
+    // ---------------------------------------------------------------------
+    // Middle and bottom layers. The bottom lanes replace the center lanes
+    // one by one, in the same order.
+    // ---------------------------------------------------------------------
+
+    encrypt_s_lanes(ctx, states, num_messages, &lanes, s_1);
+    add_center_lanes(states, num_messages, &lanes, s_1);
+    encrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_values_t* values = &(states[m].values);
+        const uint8_t* source = states[m].out;
+        __m128i y_l = vzero;
+        __m128i y_r = vzero;
+
+        for (size_t k = 1; k < states[m].num_di_blocks; ++k) {
+            const size_t lane = states[m].first_lane + k - 1;
+            const __m128i z_i_j = lanes.states[lane];
+            const __m128i l_i = vxor(z_i_j, loadu(source));
+            const __m128i y_i = vxor3(loadu((source + ZCZ_NUM_BYTES_IN_BLOCK)),
+                                      z_i_j,
+                                      s_1[m]);
+
+            gf_2_128_times_four(y_l, y_l, tmp);
+            y_l = vxor3(y_l, y_i, l_i);
+
+            gf_2_128_double(y_r, y_r, tmp);
+            y_r = vxor(y_r, y_i);
+
+            set_lane(&lanes, lane, ZCZ_DOMAIN_BOT, k, l_i, y_i);
+            source += ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        }
+
+        values->y_l = y_l;
+        values->y_r = y_r;
+    }
+
+    encrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        uint8_t* target = states[m].out;
+
+        for (size_t k = 1; k < states[m].num_di_blocks; ++k) {
+            const size_t lane = states[m].first_lane + k - 1;
+            storeu(target, lanes.tweaks[lane]);
+            storeu((target + ZCZ_NUM_BYTES_IN_BLOCK), lanes.states[lane]);
+            target += ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        }
+    }
+
+    encrypt_hash_pairs(ctx,
+                       states,
+                       num_messages,
+                       &lanes,
+                       ZCZ_DOMAIN_YL,
+                       ZCZ_DOMAIN_YR,
+                       0);
+
+    // ---------------------------------------------------------------------
+    // Last di-block of the bottom layer
+    // ---------------------------------------------------------------------
+
+    lanes.num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const zcz_values_t* values = &(states[m].values);
+        states[m].first_lane = add_lane(&lanes,
+                                        ZCZ_DOMAIN_CENTER_LAST,
+                                        states[m].num_di_blocks,
+                                        values->t,
+                                        values->s);
+    }
+
+    encrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const size_t lane = states[m].first_lane;
+        set_lane(&lanes,
+                 lane,
+                 ZCZ_DOMAIN_BOT_LAST,
+                 states[m].num_di_blocks,
+                 lanes.states[lane],
+                 states[m].values.t);
+    }
+
+    encrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const zcz_values_t* values = &(states[m].values);
+        const size_t lane = states[m].first_lane;
+        uint8_t* target = states[m].out
+            + (states[m].num_di_blocks - 1) * ZCZ_NUM_BYTES_IN_DI_BLOCK;
+
+        storeu(target, vxor(lanes.tweaks[lane], values->y_l));
+        storeu((target + ZCZ_NUM_BYTES_IN_BLOCK),
+               vxor(lanes.states[lane], values->y_r));
+    }
+
+    finalize_partial_di_blocks(ctx,
+                               states,
+                               num_messages,
+                               &lanes,
+                               ZCZ_COUNTER_PARTIAL_BOTTOM);
+}
+
+// ---------------------------------------------------------------------
+
+static void decrypt_group(const zcz_ctx_t* ctx,
+                          const zcz_message_t* group[],
+                          const size_t num_messages) {
+    zcz_message_state_t states[ZCZ_MANY_NUM_MESSAGES];
+    zcz_lanes_t lanes;
+    __m128i s_1[ZCZ_MANY_NUM_MESSAGES];
+    __m128i tmp;
+
+    init_message_states(states, group, num_messages);
+    hash_partial_di_blocks(ctx,
+                           states,
+                           num_messages,
+                           &lanes,
+                           ZCZ_COUNTER_PARTIAL_BOTTOM,
+                           1);
+
+    // ---------------------------------------------------------------------
+    // Bottom layer: Y_i = D_K^{b, i, L'_i}(R'_i), written as L'_i || Y_i
+    // ---------------------------------------------------------------------
+
+    lanes.num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const uint8_t* source = states[m].in;
+        states[m].first_lane = lanes.num_lanes;
+
+        for (size_t i = 1; i < states[m].num_di_blocks; ++i) {
+            add_lane(&lanes,
+                     ZCZ_DOMAIN_BOT,
+                     i,
+                     loadu(source),
+                     loadu((source + ZCZ_NUM_BYTES_IN_BLOCK)));
+            source += ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        }
+    }
+
+    decrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_values_t* values = &(states[m].values);
+        uint8_t* target = states[m].out;
+        __m128i y_l = vzero;
+        __m128i y_r = vzero;
+
+        for (size_t i = 0; i + 1 < states[m].num_di_blocks; ++i) {
+            const __m128i l_i = lanes.tweaks[states[m].first_lane + i];
+            const __m128i y_i = lanes.states[states[m].first_lane + i];
+
+            storeu(target, l_i);
+            storeu((target + ZCZ_NUM_BYTES_IN_BLOCK), y_i);
+
+            gf_2_128_double(y_r, y_r, tmp);
+            y_r = vxor(y_r, y_i);
+
+            gf_2_128_times_four(y_l, y_l, tmp);
+            y_l = vxor3(y_l, y_i, l_i);
+
+            target += ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        }
+
+        values->y_l = y_l;
+        values->y_r = y_r;
+    }
+
+    encrypt_hash_pairs(ctx,
+                       states,
+                       num_messages,
+                       &lanes,
+                       ZCZ_DOMAIN_YL,
+                       ZCZ_DOMAIN_YR,
+                       0);
+
+    // ---------------------------------------------------------------------
+    // Last di-block of the bottom layer: T, then S
+    // ---------------------------------------------------------------------
+
+    lanes.num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const uint8_t* block = states[m].final_full_di_block;
+        const zcz_values_t* values = &(states[m].values);
+        const __m128i left = vxor(loadu(block), values->y_l);
+        const __m128i right =
+            vxor(loadu((block + ZCZ_NUM_BYTES_IN_BLOCK)), values->y_r);
+
+        states[m].first_lane = add_lane(&lanes,
+                                        ZCZ_DOMAIN_BOT_LAST,
+                                        states[m].num_di_blocks,
+                                        left,
+                                        right);
+    }
+
+    decrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const uint8_t* block = states[m].final_full_di_block;
+        zcz_values_t* values = &(states[m].values);
+        const __m128i left = vxor(loadu(block), values->y_l);
+
+        values->t = lanes.states[states[m].first_lane];
+        set_lane(&lanes,
+                 states[m].first_lane,
+                 ZCZ_DOMAIN_CENTER_LAST,
+                 states[m].num_di_blocks,
+                 values->t,
+                 left);
+    }
+
+    decrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        states[m].values.s = lanes.states[states[m].first_lane];
+    }
+
+    // ---------------------------------------------------------------------
+    // Middle and top layers. The top lanes replace the center lanes one by
+    // one, in the same order.
+    // ---------------------------------------------------------------------
+
+    encrypt_s_lanes(ctx, states, num_messages, &lanes, s_1);
+    add_center_lanes(states, num_messages, &lanes, s_1);
+    encrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        zcz_values_t* values = &(states[m].values);
+        const uint8_t* source = states[m].out;
+        __m128i x_l = vzero;
+        __m128i x_r = vzero;
+
+        for (size_t k = 1; k < states[m].num_di_blocks; ++k) {
+            const size_t lane = states[m].first_lane + k - 1;
+            const __m128i z_i_j = lanes.states[lane];
+            const __m128i x_i = vxor(z_i_j, loadu(source));
+            const __m128i r_i = vxor3(loadu((source + ZCZ_NUM_BYTES_IN_BLOCK)),
+                                      z_i_j,
+                                      s_1[m]);
+
+            gf_2_128_times_four(x_r, x_r, tmp);
+            x_r = vxor3(x_r, x_i, r_i);
+
+            gf_2_128_double(x_l, x_l, tmp);
+            x_l = vxor(x_l, x_i);
+
+            set_lane(&lanes, lane, ZCZ_DOMAIN_TOP, k, r_i, x_i);
+            source += ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        }
+
+        values->x_l = x_l;
+        values->x_r = x_r;
+    }
+
+    decrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        uint8_t* target = states[m].out;
+
+        for (size_t k = 1; k < states[m].num_di_blocks; ++k) {
+            const size_t lane = states[m].first_lane + k - 1;
+            storeu(target, lanes.states[lane]);
+            storeu((target + ZCZ_NUM_BYTES_IN_BLOCK), lanes.tweaks[lane]);
+            target += ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        }
+    }
+
+    encrypt_hash_pairs(ctx,
+                       states,
+                       num_messages,
+                       &lanes,
+                       ZCZ_DOMAIN_XL,
+                       ZCZ_DOMAIN_XR,
+                       1);
+
+    // ---------------------------------------------------------------------
+    // Last di-block of the top layer
+    // ---------------------------------------------------------------------
+
+    lanes.num_lanes = 0;
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const zcz_values_t* values = &(states[m].values);
+        states[m].first_lane = add_lane(&lanes,
+                                        ZCZ_DOMAIN_S_LAST,
+                                        states[m].num_di_blocks,
+                                        values->s,
+                                        values->t);
+    }
+
+    decrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const size_t lane = states[m].first_lane;
+        set_lane(&lanes,
+                 lane,
+                 ZCZ_DOMAIN_TOP_LAST,
+                 states[m].num_di_blocks,
+                 lanes.states[lane],
+                 states[m].values.s);
+    }
+
+    decrypt_lanes(ctx, &lanes);
+
+    for (size_t m = 0; m < num_messages; ++m) {
+        const zcz_values_t* values = &(states[m].values);
+        const size_t lane = states[m].first_lane;
+        uint8_t* target = states[m].out
+            + (states[m].num_di_blocks - 1) * ZCZ_NUM_BYTES_IN_DI_BLOCK;
+
+        storeu(target, vxor(lanes.states[lane], values->x_l));
+        storeu((target + ZCZ_NUM_BYTES_IN_BLOCK),
+               vxor(lanes.tweaks[lane], values->x_r));
+    }
+
+    finalize_partial_di_blocks(ctx,
+                               states,
+                               num_messages,
+                               &lanes,
+                               ZCZ_COUNTER_PARTIAL_TOP);
+}
+
+// ---------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------
+
+void zcz_keysetup(zcz_ctx_t* ctx, const zcz_key_t key) {
+    deoxys_bc_128_384_ctx_t* cipher_ctx = &(ctx->cipher_ctx);
+    deoxys_bc_128_384_setup_key(cipher_ctx, loadu(key));
+    deoxys_bc_128_384_setup_decryption_key(cipher_ctx);
+
+    // ---------------------------------------------------------------------
+    // The bases depend only on the key and the domain, since all layers
+    // start from counter 0. So, we compute them once per key.
+    // ---------------------------------------------------------------------
+
+    deoxys_bc_128_384_setup_base_counters(cipher_ctx,
+                                          &(ctx->top_base),
+                                          ZCZ_DOMAIN_TOP,
+                                          0);
+    deoxys_bc_128_384_setup_base_counters(cipher_ctx,
+                                          &(ctx->bottom_base),
+                                          ZCZ_DOMAIN_BOT,
+                                          0);
+    deoxys_bc_128_384_setup_base_counters(cipher_ctx,
+                                          &(ctx->center_base),
+                                          ZCZ_DOMAIN_CENTER,
+                                          0);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_basic_encrypt(const zcz_ctx_t* ctx,
+                       const uint8_t* plaintext,
+                       const size_t num_plaintext_bytes,
+                       uint8_t* ciphertext) {
+    if (is_length_ok_for_zcz_basic(num_plaintext_bytes)) {
+        const size_t start_of_last_full_di_block = num_plaintext_bytes
+            - ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        const uint8_t* final_full_di_block = plaintext
+            + start_of_last_full_di_block;
+
+        internal_zcz_basic_encrypt(ctx,
+                                   NULL,
+                                   plaintext,
+                                   final_full_di_block,
+                                   num_plaintext_bytes,
+                                   ciphertext);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_basic_decrypt(const zcz_ctx_t* ctx,
+                       const uint8_t* ciphertext,
+                       const size_t num_ciphertext_bytes,
+                       uint8_t* plaintext) {
+    if (is_length_ok_for_zcz_basic(num_ciphertext_bytes)) {
+        const size_t start_of_last_full_di_block = num_ciphertext_bytes
+          - ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        const uint8_t* final_full_di_block = ciphertext
+          + start_of_last_full_di_block;
+
+        internal_zcz_basic_decrypt(ctx,
+                                   NULL,
+                                   ciphertext,
+                                   final_full_di_block,
+                                   num_ciphertext_bytes,
+                                   plaintext);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_encrypt(const zcz_ctx_t* ctx,
+                 const uint8_t* plaintext,
+                 const size_t num_plaintext_bytes,
+                 uint8_t* ciphertext) {
+    zcz_encrypt_parallel(ctx,
+                         NULL,
+                         plaintext,
+                         num_plaintext_bytes,
+                         ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_decrypt(const zcz_ctx_t* ctx,
+                 const uint8_t* ciphertext,
+                 const size_t num_ciphertext_bytes,
+                 uint8_t* plaintext) {
+    zcz_decrypt_parallel(ctx,
+                         NULL,
+                         ciphertext,
+                         num_ciphertext_bytes,
+                         plaintext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_encrypt_parallel(const zcz_ctx_t* ctx,
+                          zcz_pool_t* pool,
+                          const uint8_t* plaintext,
+                          const size_t num_plaintext_bytes,
+                          uint8_t* ciphertext) {
+    if ((pool != NULL) && (num_plaintext_bytes < ZCZ_PARALLEL_MIN_NUM_BYTES)) {
+        pool = NULL;
+    }
+
+    if (is_length_ok_for_zcz_basic(num_plaintext_bytes)) {
+        const size_t start_of_last_full_di_block = num_plaintext_bytes
+          - ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        const uint8_t* final_full_di_block = plaintext
+          + start_of_last_full_di_block;
+
+        internal_zcz_basic_encrypt(ctx,
+                                   pool,
+                                   plaintext,
+                                   final_full_di_block,
+                                   num_plaintext_bytes,
+                                   ciphertext);
+        return;
+    }
+
+    if (!is_length_ok_for_zcz(num_plaintext_bytes)) {
+        return;
+    }
+
+    internal_zcz_encrypt(ctx,
+                         pool,
+                         plaintext,
+                         num_plaintext_bytes,
+                         ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_decrypt_parallel(const zcz_ctx_t* ctx,
+                          zcz_pool_t* pool,
+                          const uint8_t* ciphertext,
+                          const size_t num_ciphertext_bytes,
+                          uint8_t* plaintext) {
+    if ((pool != NULL) && (num_ciphertext_bytes < ZCZ_PARALLEL_MIN_NUM_BYTES)) {
+        pool = NULL;
+    }
+
+    if (is_length_ok_for_zcz_basic(num_ciphertext_bytes)) {
+        const size_t start_of_last_full_di_block = num_ciphertext_bytes
+          - ZCZ_NUM_BYTES_IN_DI_BLOCK;
+        const uint8_t* final_full_di_block = ciphertext
+          + start_of_last_full_di_block;
+
+        internal_zcz_basic_decrypt(ctx,
+                                   pool,
+                                   ciphertext,
+                                   final_full_di_block,
+                                   num_ciphertext_bytes,
+                                   plaintext);
+        return;
+    }
+
+    if (!is_length_ok_for_zcz(num_ciphertext_bytes)) {
+        return;
+    }
+
+    internal_zcz_decrypt(ctx,
+                         pool,
+                         ciphertext,
+                         num_ciphertext_bytes,
+                         plaintext);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_encrypt_many(const zcz_ctx_t* ctx,
+                      const zcz_message_t* messages,
+                      const size_t num_messages) {
+    const zcz_message_t* group[ZCZ_MANY_NUM_MESSAGES];
+    size_t num_group_messages = 0;
+
+    for (size_t i = 0; i < num_messages; ++i) {
+        const zcz_message_t* message = messages + i;
+
+        if (!is_length_ok_for_many(message->num_bytes)) {
+            zcz_encrypt(ctx, message->in, message->num_bytes, message->out);
+            continue;
+        }
+
+        group[num_group_messages++] = message;
+
+        if (num_group_messages == ZCZ_MANY_NUM_MESSAGES) {
+            encrypt_group(ctx, group, num_group_messages);
+            num_group_messages = 0;
+        }
+    }
+
+    if (num_group_messages == 1) {
+        zcz_encrypt(ctx, group[0]->in, group[0]->num_bytes, group[0]->out);
+    } else if (num_group_messages > 1) {
+        encrypt_group(ctx, group, num_group_messages);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_decrypt_many(const zcz_ctx_t* ctx,
+                      const zcz_message_t* messages,
+                      const size_t num_messages) {
+    const zcz_message_t* group[ZCZ_MANY_NUM_MESSAGES];
+    size_t num_group_messages = 0;
+
+    for (size_t i = 0; i < num_messages; ++i) {
+        const zcz_message_t* message = messages + i;
+
+        if (!is_length_ok_for_many(message->num_bytes)) {
+            zcz_decrypt(ctx, message->in, message->num_bytes, message->out);
+            continue;
+        }
+
+        group[num_group_messages++] = message;
+
+        if (num_group_messages == ZCZ_MANY_NUM_MESSAGES) {
+            decrypt_group(ctx, group, num_group_messages);
+            num_group_messages = 0;
+        }
+    }
+
+    if (num_group_messages == 1) {
+        zcz_decrypt(ctx, group[0]->in, group[0]->num_bytes, group[0]->out);
+    } else if (num_group_messages > 1) {
+        decrypt_group(ctx, group, num_group_messages);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_encrypt_recompute(const zcz_ctx_t* ctx,
+                           const uint8_t* plaintext,
+                           const size_t num_plaintext_bytes,
+                           zcz_output_fn output,
+                           void* output_context) {
+    if (!is_length_ok_for_zcz(num_plaintext_bytes)) {
+        return;
+    }
+
+    internal_zcz_encrypt_recompute(ctx,
+                                   plaintext,
+                                   num_plaintext_bytes,
+                                   output,
+                                   output_context);
+}
+
+// ---------------------------------------------------------------------
+
+void zcz_decrypt_recompute(const zcz_ctx_t* ctx,
+                           const uint8_t* ciphertext,
+                           const size_t num_ciphertext_bytes,
+                           zcz_output_fn output,
+                           void* output_context) {
+    if (!is_length_ok_for_zcz(num_ciphertext_bytes)) {
+        return;
+    }
+
+    internal_zcz_decrypt_recompute(ctx,
+                                   ciphertext,
+                                   num_ciphertext_bytes,
+                                   output,
+                                   output_context);
+}
+
+// ---------------------------------------------------------------------
+
+const zcz_impl_t ISA_NAME(zcz_impl) = {
+    ISA_STRING(ZCZ_ISA),
+    zcz_keysetup,
+    zcz_basic_encrypt,
+    zcz_basic_decrypt,
+    zcz_encrypt,
+    zcz_decrypt,
+    zcz_encrypt_many,
+    zcz_decrypt_many,
+    zcz_encrypt_recompute,
+    zcz_decrypt_recompute,
+    zcz_encrypt_parallel,
+    zcz_decrypt_parallel
+};
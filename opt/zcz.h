@@ -32,6 +32,16 @@
 
 #include <stdint.h>
 #include "deoxysbc.h"
+#include "pool.h"
+
+// ---------------------------------------------------------------------
+// Tweakable Block Cipher
+// ---------------------------------------------------------------------
+
+// ZCZ is fixed to Deoxys-BC-128-384. Every call is tweaked with a 128-bit
+// block and a domain and counter, which needs its 256-bit tweak. The 128-bit
+// tweak of Deoxys-BC-128-256 has no room for the block, so its kernels in
+// deoxysbc.h stand alone and cannot instantiate ZCZ.
 
 // ---------------------------------------------------------------------
 // Domain Constants
@@ -74,6 +84,24 @@
 #define ZCZ_NUM_BLOCKS_PER_SEQUENCE      16
 #define ZCZ_NUM_BYTES_PER_SEQUENCE       256
 
+#define ZCZ_NUM_DI_BLOCKS_PER_WIDE_SEQUENCE   16
+#define ZCZ_NUM_BLOCKS_PER_WIDE_SEQUENCE      32
+#define ZCZ_NUM_BYTES_PER_WIDE_SEQUENCE       512
+
+#define ZCZ_WORKSPACE_ALIGNMENT          ZCZ_NUM_BYTES_IN_DI_BLOCK
+
+// Longest message, in full di-blocks, that zcz_encrypt_many() and
+// zcz_decrypt_many() interleave with others. Longer messages are faster
+// through the fixed-domain multi-block kernels of zcz_encrypt().
+#define ZCZ_MANY_MAX_NUM_DI_BLOCKS       4
+
+// Each thread of zcz_encrypt_parallel() and zcz_decrypt_parallel() takes at
+// least this many chunks. Shorter messages than two such shares run on the
+// calling thread alone, since waking the workers would cost more.
+#define ZCZ_PARALLEL_MIN_NUM_CHUNKS_PER_THREAD   4
+#define ZCZ_PARALLEL_MIN_NUM_BYTES \
+    (2 * ZCZ_PARALLEL_MIN_NUM_CHUNKS_PER_THREAD * ZCZ_NUM_BYTES_IN_CHUNK)
+
 // ---------------------------------------------------------------------
 // Types
 // ---------------------------------------------------------------------
@@ -82,51 +110,266 @@ typedef deoxys_bc_block_t zcz_block_t;
 typedef deoxys_bc_block_t zcz_tweak_t;
 typedef uint8_t zcz_key_t[DEOXYS_BC_128_KEYLEN];
 
+/**
+ * Instruction sets that the implementation is built for. ZCZ_ISA_AUTO picks
+ * the widest one that the CPU supports.
+ */
+typedef enum {
+    ZCZ_ISA_AUTO = 0,
+    ZCZ_ISA_SSE4,    // AES-NI, PCLMULQDQ, and SSE4.1
+    ZCZ_ISA_AVX2,    // AES-NI, PCLMULQDQ, and AVX2
+    ZCZ_ISA_AVX512,  // VAES, VPCLMULQDQ, and AVX-512F/BW
+    ZCZ_ISA_SSSE3,   // SSSE3 only, constant-time AES and CLMUL in software
+    ZCZ_ISA_AVX2_BITSLICED  // AVX2 without AES-NI, bitsliced Deoxys-BC
+} zcz_isa_t;
+
+struct zcz_impl_s;
+
+/**
+ * One message of zcz_encrypt_many() or zcz_decrypt_many().
+ */
+typedef struct {
+    const uint8_t* in;
+    size_t num_bytes;
+    uint8_t* out;
+} zcz_message_t;
+
+/**
+ * Receives the output of zcz_encrypt_recompute() and
+ * zcz_decrypt_recompute() in order, in pieces of at most
+ * ZCZ_NUM_BYTES_IN_CHUNK bytes.
+ */
+typedef void (*zcz_output_fn)(void* output_context,
+                              const uint8_t* bytes,
+                              const size_t num_bytes);
+
+#ifdef ZCZ_STATS
+/**
+ * Phases of zcz_encrypt() and zcz_decrypt() that ZCZ_STATS builds time. The
+ * decryption runs the layers in the opposite order: its first pass is the
+ * bottom layer, and its second one the fused middle and top layers.
+ */
+typedef enum {
+    ZCZ_STATS_FIRST_PASS = 0,        // Top layer
+    ZCZ_STATS_FIRST_LAST_DI_BLOCK,   // encrypt_last_di_block_top()
+    ZCZ_STATS_SECOND_PASS,           // Fused middle and bottom layers
+    ZCZ_STATS_SECOND_LAST_DI_BLOCK,  // encrypt_last_di_block_bottom()
+    ZCZ_STATS_PARTIAL_DI_BLOCK,      // hash() of a partial final di-block
+    ZCZ_STATS_NUM_PHASES
+} zcz_stats_phase_t;
+
+/**
+ * Sums of rdtsc deltas per phase over num_calls messages.
+ */
+typedef struct {
+    uint64_t cycles[ZCZ_STATS_NUM_PHASES];
+    uint64_t num_calls;
+} zcz_stats_t;
+#endif  // ZCZ_STATS
+
+/**
+ * Holds only key-dependent precomputations. It is written by zcz_keysetup()
+ * and read-only afterwards, so one context can be used by multiple threads
+ * at the same time without locking.
+ */
 ALIGN(16)
 typedef struct {
     deoxys_bc_128_384_ctx_t cipher_ctx;
-    __m128i s;
-    __m128i t;
-    __m128i x_l;
-    __m128i x_r;
-    __m128i y_l;
-    __m128i y_r;
+    deoxys_bc_128_384_base_t top_base;
+    deoxys_bc_128_384_base_t bottom_base;
+    deoxys_bc_128_384_base_t center_base;
+    const struct zcz_impl_s* impl;  // Chosen by zcz_keysetup()
+#ifdef ZCZ_STATS
+    zcz_stats_t* stats;  // Set by zcz_set_stats(), NULL after zcz_keysetup()
+#endif
 } zcz_ctx_t;
 
 // ---------------------------------------------------------------------
 // API
 // ---------------------------------------------------------------------
 
+/**
+ * Detects the CPU features once and binds the context to the widest
+ * supported implementation.
+ */
 void zcz_keysetup(zcz_ctx_t* ctx, const zcz_key_t key);
 
 // ---------------------------------------------------------------------
 
-void zcz_basic_encrypt(zcz_ctx_t* ctx,
+/**
+ * Like zcz_keysetup(), but binds the context to the given implementation.
+ * Returns 0 on success, or -1 if the CPU does not support it; the context
+ * is left untouched in that case.
+ */
+int zcz_keysetup_isa(zcz_ctx_t* ctx,
+                     const zcz_key_t key,
+                     const zcz_isa_t isa);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Returns the name of the implementation that the context is bound to,
+ * e.g., "avx2".
+ */
+const char* zcz_isa_name(const zcz_ctx_t* ctx);
+
+#ifdef ZCZ_STATS
+// ---------------------------------------------------------------------
+
+/**
+ * Adds the cycles of each phase of later calls with this context to stats,
+ * or stops if stats is NULL. Only the calling thread is timed, and the sums
+ * are not atomic, so a context with stats must not be shared by threads.
+ * zcz_encrypt_many() and the recompute functions are not timed.
+ */
+void zcz_set_stats(zcz_ctx_t* ctx, zcz_stats_t* stats);
+#endif  // ZCZ_STATS
+
+// ---------------------------------------------------------------------
+
+void zcz_basic_encrypt(const zcz_ctx_t* ctx,
                        const uint8_t* plaintext,
                        const size_t num_plaintext_bytes,
                        uint8_t* ciphertext);
 
 // ---------------------------------------------------------------------
 
-void zcz_basic_decrypt(zcz_ctx_t* ctx,
+void zcz_basic_decrypt(const zcz_ctx_t* ctx,
                        const uint8_t* ciphertext,
                        const size_t num_ciphertext_bytes,
                        uint8_t* plaintext);
 
 // ---------------------------------------------------------------------
 
-void zcz_encrypt(zcz_ctx_t* ctx,
+/**
+ * Plaintext and ciphertext may be the same buffer.
+ */
+void zcz_encrypt(const zcz_ctx_t* ctx,
                  const uint8_t* plaintext,
                  const size_t num_plaintext_bytes,
                  uint8_t* ciphertext);
 
 // ---------------------------------------------------------------------
 
-void zcz_decrypt(zcz_ctx_t* ctx,
+/**
+ * Ciphertext and plaintext may be the same buffer.
+ */
+void zcz_decrypt(const zcz_ctx_t* ctx,
                  const uint8_t* ciphertext,
                  const size_t num_ciphertext_bytes,
                  uint8_t* plaintext);
 
 // ---------------------------------------------------------------------
 
+/**
+ * Returns the number of workspace bytes that zcz_encrypt_ws() and
+ * zcz_decrypt_ws() need for a message of the given length. All layers work
+ * in place in the output, so this is always 0.
+ */
+size_t zcz_workspace_size(const size_t num_bytes);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Like zcz_encrypt(), with a workspace of zcz_workspace_size() bytes aligned
+ * to ZCZ_WORKSPACE_ALIGNMENT. Since that is 0, the workspace is unused and
+ * may be NULL.
+ */
+void zcz_encrypt_ws(const zcz_ctx_t* ctx,
+                    const uint8_t* plaintext,
+                    const size_t num_plaintext_bytes,
+                    uint8_t* ciphertext,
+                    uint8_t* workspace);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Like zcz_decrypt(), with a workspace of zcz_workspace_size() bytes aligned
+ * to ZCZ_WORKSPACE_ALIGNMENT. Since that is 0, the workspace is unused and
+ * may be NULL.
+ */
+void zcz_decrypt_ws(const zcz_ctx_t* ctx,
+                    const uint8_t* ciphertext,
+                    const size_t num_ciphertext_bytes,
+                    uint8_t* plaintext,
+                    uint8_t* workspace);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Encrypts num_messages independent messages under the same key, as if by
+ * calling zcz_encrypt() for each. Messages of at most
+ * ZCZ_MANY_MAX_NUM_DI_BLOCKS full di-blocks are processed in groups of
+ * eight, whose block-cipher calls share the same multi-block kernels layer
+ * by layer; longer ones are encrypted one by one. Each message may be in
+ * place, but messages must not overlap each other.
+ */
+void zcz_encrypt_many(const zcz_ctx_t* ctx,
+                      const zcz_message_t* messages,
+                      const size_t num_messages);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Decryption counterpart of zcz_encrypt_many().
+ */
+void zcz_decrypt_many(const zcz_ctx_t* ctx,
+                      const zcz_message_t* messages,
+                      const size_t num_messages);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Like zcz_encrypt(), but needs no memory besides one chunk on the stack,
+ * and never writes to the plaintext. It reads the plaintext twice: once to
+ * hash the top layer, and once to recompute the top layer chunk by chunk
+ * and pass it through the middle and bottom layers. The ciphertext is handed
+ * to output in order. This costs about a third more block-cipher calls than
+ * zcz_encrypt().
+ */
+void zcz_encrypt_recompute(const zcz_ctx_t* ctx,
+                           const uint8_t* plaintext,
+                           const size_t num_plaintext_bytes,
+                           zcz_output_fn output,
+                           void* output_context);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Decryption counterpart of zcz_encrypt_recompute().
+ */
+void zcz_decrypt_recompute(const zcz_ctx_t* ctx,
+                           const uint8_t* ciphertext,
+                           const size_t num_ciphertext_bytes,
+                           zcz_output_fn output,
+                           void* output_context);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Like zcz_encrypt(), but runs the top layer, and then the middle and bottom
+ * layers, on the threads of the pool. Each thread takes its own range of
+ * chunks, and the partial hashes are combined afterwards. With pool NULL, or
+ * for messages shorter than ZCZ_PARALLEL_MIN_NUM_BYTES, this is
+ * zcz_encrypt(). A pool must not be used by two calls at the same time.
+ */
+void zcz_encrypt_parallel(const zcz_ctx_t* ctx,
+                          zcz_pool_t* pool,
+                          const uint8_t* plaintext,
+                          const size_t num_plaintext_bytes,
+                          uint8_t* ciphertext);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Decryption counterpart of zcz_encrypt_parallel().
+ */
+void zcz_decrypt_parallel(const zcz_ctx_t* ctx,
+                          zcz_pool_t* pool,
+                          const uint8_t* ciphertext,
+                          const size_t num_ciphertext_bytes,
+                          uint8_t* plaintext);
+
+// ---------------------------------------------------------------------
+
 #endif  // _ZCZ_H_
@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+
+"""
+Generates the S-box circuits of opt/bitsliced.h, the bitsliced AES round for
+AVX2 hosts without AES-NI.
+
+The forward S-box is the circuit of Boyar and Peralta (32 AND, 79 XOR, and 4
+XNOR gates), given below as one gate per line on the bits x0 (MSB) .. x7 (LSB)
+of the input and s0 (MSB) .. s7 (LSB) of the output. The inverse S-box reuses
+it as B(S(B(y ^ 0x63)) ^ 0x63), where B is the inverse of the linear part of
+the affine map, since inversion in GF(2^8) is an involution. The script
+evaluates both on all 256 inputs, checks them against their definition, and
+prints them as functions on bit planes.
+"""
+
+from typing import Dict, List, Tuple
+
+# ----------------------------------------------------------
+
+AES_POLYNOMIAL = 0x11B
+AFFINE_CONSTANT = 0x63
+
+SBOX_CIRCUIT = """
+y14 = x3 ^ x5
+y13 = x0 ^ x6
+y9 = x0 ^ x3
+y8 = x0 ^ x5
+t0 = x1 ^ x2
+y1 = t0 ^ x7
+y4 = y1 ^ x3
+y12 = y13 ^ y14
+y2 = y1 ^ x0
+y5 = y1 ^ x6
+y3 = y5 ^ y8
+t1 = x4 ^ y12
+y15 = t1 ^ x5
+y20 = t1 ^ x1
+y6 = y15 ^ x7
+y10 = y15 ^ t0
+y11 = y20 ^ y9
+y7 = x7 ^ y11
+y17 = y10 ^ y11
+y19 = y10 ^ y8
+y16 = t0 ^ y11
+y21 = y13 ^ y16
+y18 = x0 ^ y16
+t2 = y12 & y15
+t3 = y3 & y6
+t4 = t3 ^ t2
+t5 = y4 & x7
+t6 = t5 ^ t2
+t7 = y13 & y16
+t8 = y5 & y1
+t9 = t8 ^ t7
+t10 = y2 & y7
+t11 = t10 ^ t7
+t12 = y9 & y11
+t13 = y14 & y17
+t14 = t13 ^ t12
+t15 = y8 & y10
+t16 = t15 ^ t12
+t17 = t4 ^ t14
+t18 = t6 ^ t16
+t19 = t9 ^ t14
+t20 = t11 ^ t16
+t21 = t17 ^ y20
+t22 = t18 ^ y19
+t23 = t19 ^ y21
+t24 = t20 ^ y18
+t25 = t21 ^ t22
+t26 = t21 & t23
+t27 = t24 ^ t26
+t28 = t25 & t27
+t29 = t28 ^ t22
+t30 = t23 ^ t24
+t31 = t22 ^ t26
+t32 = t31 & t30
+t33 = t32 ^ t24
+t34 = t23 ^ t33
+t35 = t27 ^ t33
+t36 = t24 & t35
+t37 = t36 ^ t34
+t38 = t27 ^ t36
+t39 = t29 & t38
+t40 = t25 ^ t39
+t41 = t40 ^ t37
+t42 = t29 ^ t33
+t43 = t29 ^ t40
+t44 = t33 ^ t37
+t45 = t42 ^ t41
+z0 = t44 & y15
+z1 = t37 & y6
+z2 = t33 & x7
+z3 = t43 & y16
+z4 = t40 & y1
+z5 = t29 & y7
+z6 = t42 & y11
+z7 = t45 & y17
+z8 = t41 & y10
+z9 = t44 & y12
+z10 = t37 & y3
+z11 = t33 & y4
+z12 = t43 & y13
+z13 = t40 & y5
+z14 = t29 & y2
+z15 = t42 & y9
+z16 = t45 & y14
+z17 = t41 & y8
+t46 = z15 ^ z16
+t47 = z10 ^ z11
+t48 = z5 ^ z13
+t49 = z9 ^ z10
+t50 = z2 ^ z12
+t51 = z2 ^ z5
+t52 = z7 ^ z8
+t53 = z0 ^ z3
+t54 = z6 ^ z7
+t55 = z16 ^ z17
+t56 = z12 ^ t48
+t57 = t50 ^ t53
+t58 = z4 ^ t46
+t59 = z3 ^ t54
+t60 = t46 ^ t57
+t61 = z14 ^ t57
+t62 = t52 ^ t58
+t63 = t49 ^ t58
+t64 = z4 ^ t59
+t65 = t61 ^ t62
+t66 = z1 ^ t63
+s0 = t59 ^ t63
+s6 = t56 ^ ~t62
+s7 = t48 ^ ~t60
+t67 = t64 ^ t65
+s3 = t53 ^ t66
+s4 = t51 ^ t66
+s5 = t47 ^ t65
+s1 = t64 ^ ~s3
+s2 = t55 ^ ~t67
+"""
+
+# ----------------------------------------------------------
+
+Gate = Tuple[str, str, str, str]
+
+
+def parse_circuit(text: str) -> List[Gate]:
+    """
+    Returns (target, left, operator, right) per gate, with operator one of
+    '^', '&', and '^~'.
+    """
+    gates = []
+
+    for line in text.strip().splitlines():
+        target, expression = line.split(" = ")
+        left, operator, right = expression.split(" ")
+
+        if right.startswith("~"):
+            operator += "~"
+            right = right[1:]
+
+        gates.append((target, left, operator, right))
+
+    return gates
+
+
+def evaluate(gates: List[Gate], x: int) -> int:
+    values: Dict[str, int] = {f"x{i}": (x >> (7 - i)) & 1 for i in range(8)}
+
+    for target, left, operator, right in gates:
+        a = values[left]
+        b = values[right]
+
+        if operator == "&":
+            values[target] = a & b
+        elif operator == "^":
+            values[target] = a ^ b
+        else:
+            values[target] = a ^ b ^ 1
+
+    return sum(values[f"s{i}"] << (7 - i) for i in range(8))
+
+
+# ----------------------------------------------------------
+
+def aes_mul(x: int, y: int) -> int:
+    result = 0
+
+    while y:
+        if y & 1:
+            result ^= x
+
+        y >>= 1
+        x <<= 1
+
+        if x >> 8:
+            x ^= AES_POLYNOMIAL
+
+    return result
+
+
+def aes_inverse(x: int) -> int:
+    return next((y for y in range(256) if aes_mul(x, y) == 1), 0)
+
+
+def rotate_left(x: int, r: int) -> int:
+    return ((x << r) | (x >> (8 - r))) & 0xFF
+
+
+def aes_affine(x: int) -> int:
+    return (x ^ rotate_left(x, 1) ^ rotate_left(x, 2) ^ rotate_left(x, 3)
+            ^ rotate_left(x, 4) ^ AFFINE_CONSTANT)
+
+
+# Inverse of the linear part of aes_affine(): output bit i is the XOR of the
+# input bits i - 1, i - 3, and i - 6 (mod 8).
+INVERSE_AFFINE_TAPS = (1, 3, 6)
+
+
+def inverse_linear(x: int) -> int:
+    result = 0
+
+    for r in INVERSE_AFFINE_TAPS:
+        result ^= rotate_left(x, r)
+
+    return result
+
+
+# ----------------------------------------------------------
+
+def print_sbox(gates: List[Gate]) -> None:
+    functions = {"^": "avx_xor", "&": "avx_and"}
+
+    print("static inline void bitsliced_sub_bytes(__m256i state[8]) {")
+    print("    const __m256i ones = avx_set8(-1);")
+
+    for i in range(8):
+        print(f"    const __m256i x{i} = state[{7 - i}];")
+
+    for target, left, operator, right in gates:
+        if operator == "^~":
+            value = f"avx_xor3({left}, {right}, ones)"
+        else:
+            value = f"{functions[operator]}({left}, {right})"
+
+        print(f"    const __m256i {target} = {value};")
+
+    for i in range(8):
+        print(f"    state[{7 - i}] = s{i};")
+
+    print("}")
+
+
+def print_inverse_affine(constant: int) -> None:
+    print("static inline void bitsliced_inverse_affine(__m256i state[8]) {")
+    print("    const __m256i ones = avx_set8(-1);")
+    print("    __m256i x[8];")
+
+    for i in range(8):
+        print(f"    x[{i}] = state[{i}];")
+
+    for i in range(8):
+        taps = [f"x[{(i - r) % 8}]" for r in INVERSE_AFFINE_TAPS]
+        value = f"avx_xor3({', '.join(taps)})"
+
+        if (constant >> i) & 1:
+            value = f"avx_xor({value}, ones)"
+
+        print(f"    state[{i}] = {value};")
+
+    print("}")
+
+
+# ----------------------------------------------------------
+
+def main() -> None:
+    gates = parse_circuit(SBOX_CIRCUIT)
+
+    def sbox(x: int) -> int:
+        return evaluate(gates, x)
+
+    inverse_constant = inverse_linear(AFFINE_CONSTANT)
+
+    def inverse_affine(x: int) -> int:
+        return inverse_linear(x) ^ inverse_constant
+
+    for x in range(256):
+        assert inverse_affine(aes_affine(x)) == x
+        assert sbox(x) == aes_affine(aes_inverse(x))
+        assert inverse_affine(sbox(inverse_affine(x))) == aes_inverse(
+            inverse_affine(x))
+
+    num_and = sum(1 for gate in gates if gate[2] == "&")
+    num_xnor = sum(1 for gate in gates if gate[2] == "^~")
+    num_xor = len(gates) - num_and - num_xnor
+
+    print(f"// {num_and} AND, {num_xor} XOR, and {num_xnor} XNOR gates")
+    print_sbox(gates)
+    print()
+    print(f"// B(x) ^ 0x{inverse_constant:02x}, where B is the inverse of the "
+          "linear part of the affine map")
+    print_inverse_affine(inverse_constant)
+
+
+# ----------------------------------------------------------
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,31 @@
+#!/bin/sh
+# Fails if the given object files contain AES-NI, PCLMULQDQ, SSE4.1, or
+# later instructions. The dispatcher, the pool, and the helpers run before
+# or besides the variant that the CPU supports, so they must stay within the
+# SSSE3 baseline of the slowest variant.
+#
+# usage: check-baseline-isa.sh <objdump> <object>...
+
+OBJDUMP="$1"
+shift
+
+# Mnemonics in AT&T syntax. All VEX-encoded ones start with "v".
+PATTERN='^(v|aes|pclmul|ptest|pblend|blendv?p[sd]|pextr[bdq]|pinsr[bdq]|'
+PATTERN="${PATTERN}"'pmov[sz]x|pmaxs[bd]|pmaxu[wd]|pmins[bd]|pminu[wd]|pmulld|'
+PATTERN="${PATTERN}"'pmuldq|pcmpeqq|packusdw|round[ps][sd]|dpp[sd]|insertps|'
+PATTERN="${PATTERN}"'extractps|mpsadbw|phminposuw|movntdqa|crc32|pcmpgtq|popcnt)'
+
+status=0
+
+for object in "$@"; do
+  found=`"$OBJDUMP" -d --no-show-raw-insn "$object" \
+    | awk -F'\t' 'NF >= 2 { split($2, words, " "); print words[1] }' \
+    | grep -E "$PATTERN" | sort -u | tr '\n' ' '`
+
+  if [ -n "$found" ]; then
+    echo "$object: instructions beyond SSSE3: $found"
+    status=1
+  fi
+done
+
+exit $status
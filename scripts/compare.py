@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+
+"""
+Compares two runs of bin/benchmark-zcz or bin/benchmark-deoxysbc with --json
+or --csv, e.g., of the current and a new build, per mode and message length.
+
+A row is a significant regression if the 95% confidence intervals of both
+medians do not overlap and the median grew by more than the threshold. The
+intervals only capture the noise within a run; the threshold covers the
+noise between runs, e.g., from frequency scaling or the placement of
+buffers. Exits with 1 if there is a regression, so that it can gate builds.
+"""
+
+import argparse
+import csv
+import json
+import sys
+from typing import Dict, List, Tuple
+
+# ----------------------------------------------------------
+
+_COMMENT_CHAR = '#'
+_METADATA_KEYS = ["benchmark", "cpu", "cpu_flags", "build_type", "revision"]
+
+# Runs are only comparable if these match.
+_SETUP_KEYS = ["benchmark", "cpu", "cpu_flags", "build_type"]
+
+Key = Tuple[str, int]
+Row = Dict[str, float]
+
+
+# ----------------------------------------------------------
+
+def read_json(text: str) -> Tuple[Dict[str, str], Dict[Key, Row]]:
+    run = json.loads(text)
+    metadata = {key: str(run.get(key)) for key in _METADATA_KEYS}
+    rows = {}
+
+    for result in run["results"]:
+        low, high = result["median_interval"]
+        rows[(result["mode"], result["bytes"])] = {
+            "unit": result["unit"],
+            "p50": result["p50"],
+            "median_low": low,
+            "median_high": high
+        }
+
+    return metadata, rows
+
+
+# ----------------------------------------------------------
+
+def read_csv(text: str) -> Tuple[Dict[str, str], Dict[Key, Row]]:
+    metadata = {}
+    lines = []
+
+    for line in text.splitlines():
+        if line.startswith(_COMMENT_CHAR):
+            key, _, value = line[1:].strip().partition("=")
+            metadata[key] = value
+        elif line.strip():
+            lines.append(line)
+
+    rows = {}
+
+    for result in csv.DictReader(lines):
+        rows[(result["mode"], int(result["bytes"]))] = {
+            "unit": result["unit"],
+            "p50": float(result["p50"]),
+            "median_low": float(result["median_low"]),
+            "median_high": float(result["median_high"])
+        }
+
+    return metadata, rows
+
+
+# ----------------------------------------------------------
+
+def read(in_path: str) -> Tuple[Dict[str, str], Dict[Key, Row]]:
+    with open(in_path, "r") as f:
+        text = f.read()
+
+    if text.lstrip().startswith("{"):
+        return read_json(text)
+
+    return read_csv(text)
+
+
+# ----------------------------------------------------------
+
+def classify(old: Row, new: Row, threshold: float) -> str:
+    change = new["p50"] / old["p50"] - 1 if old["p50"] > 0 else 0
+
+    if (new["median_low"] > old["median_high"]) and (change > threshold):
+        return "REGRESSION"
+
+    if (new["median_high"] < old["median_low"]) and (change < -threshold):
+        return "improvement"
+
+    return ""
+
+
+# ----------------------------------------------------------
+
+def compare(old_rows: Dict[Key, Row],
+            new_rows: Dict[Key, Row],
+            threshold: float) -> List[Key]:
+    regressions = []
+    print("#Mode Bytes Unit Old(p50) New(p50) Change")
+
+    for key in sorted(set(old_rows) & set(new_rows)):
+        old = old_rows[key]
+        new = new_rows[key]
+
+        if old["unit"] != new["unit"]:
+            continue
+
+        status = classify(old, new, threshold)
+        change = 100 * (new["p50"] / old["p50"] - 1) if old["p50"] > 0 else 0
+        print(f"{key[0]} {key[1]} {old['unit']} {old['p50']:.2f} "
+              f"{new['p50']:.2f} {change:+.1f}% {status}".rstrip())
+
+        if status == "REGRESSION":
+            regressions.append(key)
+
+    for key in sorted(set(old_rows) ^ set(new_rows)):
+        print(f"{_COMMENT_CHAR} {key[0]} {key[1]} is in one run only",
+              file=sys.stderr)
+
+    return regressions
+
+
+# ---------------------------------------------------------
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="""
+        Compares the median cycles per byte of two benchmark runs in JSON or
+        CSV and flags significant regressions.""")
+    parser.add_argument("old",
+                        help="Path to the run of the baseline",
+                        type=str)
+    parser.add_argument("new",
+                        help="Path to the run to check",
+                        type=str)
+    parser.add_argument("-t",
+                        "--threshold",
+                        help="Minimal relative change of the median in "
+                             "percent, 5 by default",
+                        type=float,
+                        default=5.0)
+    return parser.parse_args()
+
+
+# ---------------------------------------------------------
+
+def main():
+    args = parse_args()
+    old_metadata, old_rows = read(args.old)
+    new_metadata, new_rows = read(args.new)
+
+    for key in _SETUP_KEYS:
+        old_value = old_metadata.get(key)
+        new_value = new_metadata.get(key)
+
+        if old_value != new_value:
+            print(f"{_COMMENT_CHAR} {key} differs: {old_value} vs. "
+                  f"{new_value}", file=sys.stderr)
+
+    print(f"{_COMMENT_CHAR}Revision {old_metadata.get('revision')} -> "
+          f"{new_metadata.get('revision')}")
+    regressions = compare(old_rows, new_rows, args.threshold / 100)
+
+    if regressions:
+        print(f"{_COMMENT_CHAR} {len(regressions)} significant "
+              "regression(s)", file=sys.stderr)
+        sys.exit(1)
+
+
+# ---------------------------------------------------------
+
+if __name__ == '__main__':
+    main()
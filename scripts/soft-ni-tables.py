@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+
+"""
+Generates the nibble tables of opt/soft-ni.h, the constant-time SSSE3
+replacement for AES-NI.
+
+GF(2^8) is mapped into the tower field GF(2^4)[t] / (t^2 + t + lambda), where
+an element is a * t + b for nibbles a, b. Its inverse is
+(a * t + (a + b)) / delta, with delta = lambda * a^2 + a * b + b^2, so the
+S-box needs only nibble lookups, XORs, and products of nibbles, which are
+computed with logarithms. Every table has 16 entries and is applied with
+PSHUFB. The script checks the resulting S-boxes against their definition
+before printing the tables.
+"""
+
+from typing import Callable, List, Tuple
+
+# ----------------------------------------------------------
+
+AES_POLYNOMIAL = 0x11B
+GF16_POLYNOMIAL = 0x13
+GF16_GENERATOR = 2
+ZERO_LOG = 0x80
+
+# ----------------------------------------------------------
+
+
+def gf_mul(x: int, y: int, polynomial: int, num_bits: int) -> int:
+    result = 0
+
+    while y:
+        if y & 1:
+            result ^= x
+
+        y >>= 1
+        x <<= 1
+
+        if x >> num_bits:
+            x ^= polynomial
+
+    return result
+
+
+def gf16_mul(x: int, y: int) -> int:
+    return gf_mul(x, y, GF16_POLYNOMIAL, 4)
+
+
+def aes_mul(x: int, y: int) -> int:
+    return gf_mul(x, y, AES_POLYNOMIAL, 8)
+
+
+# ----------------------------------------------------------
+
+Tower = Tuple[int, int]
+
+
+def tower_mul(x: Tower, y: Tower, lam: int) -> Tower:
+    # (a t + b)(c t + d) = ac t^2 + (ad + bc) t + bd, with t^2 = t + lambda
+    a, b = x
+    c, d = y
+    ac = gf16_mul(a, c)
+    return (ac ^ gf16_mul(a, d) ^ gf16_mul(b, c),
+            gf16_mul(ac, lam) ^ gf16_mul(b, d))
+
+
+def tower_add(x: Tower, y: Tower) -> Tower:
+    return (x[0] ^ y[0], x[1] ^ y[1])
+
+
+def find_lambda() -> int:
+    for lam in range(1, 16):
+        if all(gf16_mul(t, t) ^ t ^ lam for t in range(16)):
+            return lam
+
+    raise ValueError("No irreducible t^2 + t + lambda")
+
+
+def find_isomorphism(lam: int) -> List[Tower]:
+    """
+    Returns the images of the bits 2^0 .. 2^7 of an AES field element, i.e.,
+    the powers beta^i of a root beta of the AES polynomial in the tower.
+    """
+    for a in range(16):
+        for b in range(16):
+            beta = (a, b)
+            powers = [(0, 1)]
+
+            for _ in range(8):
+                powers.append(tower_mul(powers[-1], beta, lam))
+
+            value = (0, 0)
+
+            for i in range(9):
+                if (AES_POLYNOMIAL >> i) & 1:
+                    value = tower_add(value, powers[i])
+
+            if value == (0, 0) and beta not in ((0, 0), (0, 1)):
+                return powers[:8]
+
+    raise ValueError("No root of the AES polynomial")
+
+
+# ----------------------------------------------------------
+
+def linear_map(images: List[int]) -> Callable[[int], int]:
+    def apply(x: int) -> int:
+        result = 0
+
+        for i, image in enumerate(images):
+            if (x >> i) & 1:
+                result ^= image
+
+        return result
+
+    return apply
+
+
+def aes_affine(x: int) -> int:
+    result = 0x63
+
+    for i in range(8):
+        bit = 0
+
+        for j in (0, 4, 5, 6, 7):
+            bit ^= (x >> ((i + j) % 8)) & 1
+
+        result ^= bit << i
+
+    return result
+
+
+def aes_inverse(x: int) -> int:
+    return next((y for y in range(256) if aes_mul(x, y) == 1), 0)
+
+
+# ----------------------------------------------------------
+
+def main() -> None:
+    lam = find_lambda()
+    powers = find_isomorphism(lam)
+
+    # phi: AES field -> tower, packed as (a << 4) | b
+    phi = linear_map([(a << 4) | b for a, b in powers])
+    phi_inverse_table = [0] * 256
+
+    for x in range(256):
+        phi_inverse_table[phi(x)] = x
+
+    def phi_inverse(y: int) -> int:
+        return phi_inverse_table[y]
+
+    affine_inverse_table = [0] * 256
+
+    for x in range(256):
+        affine_inverse_table[aes_affine(x)] = x
+
+    log = [ZERO_LOG] * 16
+    exp = [0] * 16
+    power = 1
+
+    for i in range(15):
+        exp[i] = power
+        log[power] = i
+        power = gf16_mul(power, GF16_GENERATOR)
+
+    log_inverse = [ZERO_LOG] + [(15 - log[x]) % 15 for x in range(1, 16)]
+    lambda_square = [gf16_mul(lam, gf16_mul(x, x)) for x in range(16)]
+    square = [gf16_mul(x, x) for x in range(16)]
+
+    def split(f: Callable[[int], int], shift: int) -> Tuple[List[int],
+                                                            List[int]]:
+        low = [(f(x) >> shift) & 0x0F for x in range(16)]
+        high = [(f(x << 4) >> shift) & 0x0F for x in range(16)]
+        return low, high
+
+    # Inputs of SubBytes and of InvSubBytes in the tower
+    def decryption_input(y: int) -> int:
+        return phi(affine_inverse_table[y])
+
+    # The constant of the inverse affine map lands in the low-nibble table
+    decryption_constant = decryption_input(0)
+
+    def decryption_linear(y: int) -> int:
+        return decryption_input(y) ^ decryption_constant
+
+    encrypt_a = split(phi, 4)
+    encrypt_b = split(phi, 0)
+    decrypt_a = split(decryption_linear, 4)
+    decrypt_b = split(decryption_linear, 0)
+    decrypt_a[0][:] = [x ^ (decryption_constant >> 4) for x in decrypt_a[0]]
+    decrypt_b[0][:] = [x ^ (decryption_constant & 0x0F) for x in decrypt_b[0]]
+
+    def affine_linear(x: int) -> int:
+        return aes_affine(x) ^ 0x63
+
+    sbox_p = [affine_linear(phi_inverse(p << 4)) for p in range(16)]
+    sbox_q = [affine_linear(phi_inverse(q)) ^ 0x63 for q in range(16)]
+    inverse_p = [phi_inverse(p << 4) for p in range(16)]
+    inverse_q = [phi_inverse(q) for q in range(16)]
+
+    # ------------------------------------------------------
+    # Emulate the vector code on every byte
+    # ------------------------------------------------------
+
+    def lookup(table: List[int], index: int) -> int:
+        return 0 if index & 0x80 else table[index & 0x0F]
+
+    def add_logs(x: int, y: int) -> int:
+        total = min(x + y, 0xFF)
+        return total - 15 if 15 <= total < 0x80 else total
+
+    def invert(a: int, b: int) -> Tuple[int, int]:
+        log_a = lookup(log, a)
+        log_b = lookup(log, b)
+        delta = (lookup(lambda_square, a) ^ lookup(square, b)
+                 ^ lookup(exp, add_logs(log_a, log_b)))
+        log_delta_inverse = lookup(log_inverse, delta)
+        p = lookup(exp, add_logs(log_a, log_delta_inverse))
+        q = lookup(exp, add_logs(lookup(log, a ^ b), log_delta_inverse))
+        return p, q
+
+    def apply(tables: Tuple[List[int], List[int]], x: int) -> int:
+        return tables[0][x & 0x0F] ^ tables[1][x >> 4]
+
+    for x in range(256):
+        p, q = invert(apply(encrypt_a, x), apply(encrypt_b, x))
+        assert sbox_p[p] ^ sbox_q[q] == aes_affine(aes_inverse(x))
+
+        p, q = invert(apply(decrypt_a, x), apply(decrypt_b, x))
+        assert (inverse_p[p] ^ inverse_q[q]
+                == aes_inverse(affine_inverse_table[x]))
+
+    # ------------------------------------------------------
+    # Print
+    # ------------------------------------------------------
+
+    def print_table(name: str, table: List[int]) -> None:
+        values = [f"0x{x:02x}" for x in table]
+        print(f"#define {name} \\")
+        print(f"    setr8({', '.join(values[:8])}, \\")
+        print(f"          {', '.join(values[8:])})")
+
+    print(f"// t^2 + t + 0x{lam:x} over GF(2^4) = GF(2)[y] / (y^4 + y + 1)")
+    print_table("SOFT_NI_LOG", log)
+    print_table("SOFT_NI_EXP", exp)
+    print_table("SOFT_NI_LOG_INVERSE", log_inverse)
+    print_table("SOFT_NI_LAMBDA_SQUARE", lambda_square)
+    print_table("SOFT_NI_SQUARE", square)
+    print_table("SOFT_NI_ENC_A_LO", encrypt_a[0])
+    print_table("SOFT_NI_ENC_A_HI", encrypt_a[1])
+    print_table("SOFT_NI_ENC_B_LO", encrypt_b[0])
+    print_table("SOFT_NI_ENC_B_HI", encrypt_b[1])
+    print_table("SOFT_NI_DEC_A_LO", decrypt_a[0])
+    print_table("SOFT_NI_DEC_A_HI", decrypt_a[1])
+    print_table("SOFT_NI_DEC_B_LO", decrypt_b[0])
+    print_table("SOFT_NI_DEC_B_HI", decrypt_b[1])
+    print_table("SOFT_NI_SBOX_P", sbox_p)
+    print_table("SOFT_NI_SBOX_Q", sbox_q)
+    print_table("SOFT_NI_INV_SBOX_P", inverse_p)
+    print_table("SOFT_NI_INV_SBOX_Q", inverse_q)
+
+
+# ----------------------------------------------------------
+
+if __name__ == '__main__':
+    main()
@@ -56,6 +56,7 @@ typedef struct {
     ALIGN(16)
     uint8_t key[DEOXYS_BC_128_KEYLEN];
     deoxys_bc_128_384_ctx_t ctx;
+    deoxys_bc_128_384_base_t base;
     ALIGN(16)
     uint8_t* plaintext;
     ALIGN(16)
@@ -90,6 +91,7 @@ static void initialize(benchmark_ctx_t* context, const size_t max_num_bytes) {
     context->tweak_domain = 2;
 
     deoxys_bc_128_384_setup_base_counters(&(context->ctx),
+                                          &(context->base),
                                           context->tweak_domain,
                                           context->tweak_counter);
 
@@ -121,10 +123,10 @@ static void run_operation(benchmark_ctx_t* context,
         load_eight(states, plaintext_position);
         avx_load_four(tweaks, tweak_position);
 
-        deoxys_bc_128_384_encrypt_eight(&(context->ctx),
-                                       context->tweak_counter,
-                                       tweaks,
-                                       states);
+        deoxys_bc_128_384_encrypt_eight(&(context->base),
+                                        context->tweak_counter,
+                                        tweaks,
+                                        states);
         store_eight(ciphertext_position, states);
 
         num_bytes -= NUM_BYTES_PER_CHUNK;
@@ -159,7 +161,7 @@ static void run_operation(benchmark_ctx_t* context,
 
 // ---------------------------------------------------------------------
 
-static int benchmark() {
+static int benchmark(const int use_counters, const report_format_t format) {
     // ---------------------------------------------------------------------
     // Initialization
     // ---------------------------------------------------------------------
@@ -175,19 +177,30 @@ static int benchmark() {
     // Warm up
     // ---------------------------------------------------------------------
 
+    perf_counters_t counters;
+    perf_counters_t* counters_or_null = NULL;
+
+    if (use_counters && (perf_counters_open(&counters) != 0)) {
+        fputs("Hardware counters are unavailable, timing only\n", stderr);
+    } else if (use_counters) {
+        counters_or_null = &counters;
+    }
+
     const uint64_t calibration = calibrate_timer();
     uint64_t t0;
     uint64_t t1;
 
-    puts("#Bytes cpb");
+    report_t report;
+    report_begin(
+        &report, format, "benchmark-deoxysbc", NULL, counters_or_null != NULL);
+    report_begin_mode(&report, "encrypt", 1);
 
     for (size_t i = 0; i < NUM_ITERATIONS / 4; ++i) {
         num_plaintext_bytes = 2048;
         run_operation(&ctx, num_plaintext_bytes, tweaks, states);
     }
 
-    double timings[NUM_ITERATIONS];
-    const uint32_t median = NUM_ITERATIONS / 2;
+    histogram_t* histogram = (histogram_t*)malloc(sizeof(histogram_t));
 
     // ---------------------------------------------------------------------
     // Benchmark
@@ -196,36 +209,70 @@ static int benchmark() {
     for (size_t j = 0; j < NUM_MESSAGE_LENGTHS; ++j) {
         num_plaintext_bytes = MESSAGE_LENGTHS[j];
 
-        t0 = get_time();
-        t1 = get_time();
+        histogram_reset(histogram);
 
         for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
             t0 = get_time();
             run_operation(&ctx, num_plaintext_bytes, tweaks, states);
             t1 = get_time();
-            timings[i] = (double)(t1 - t0 - calibration) / num_plaintext_bytes;
+            histogram_record(histogram, (t1 - t0 > calibration)
+                ? t1 - t0 - calibration : 0);
         }
 
-        // ---------------------------------------------------------------------
-        // Sort the measurements and print the median
-        // ---------------------------------------------------------------------
+        if (counters_or_null != NULL) {
+            // Untimed, so that reading the time stamp counter does not count
+            perf_counters_start(counters_or_null);
+
+            for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+                run_operation(&ctx, num_plaintext_bytes, tweaks, states);
+            }
+
+            perf_counters_stop(counters_or_null);
+        }
 
-        qsort(timings, NUM_ITERATIONS, sizeof(double), compare_doubles);
-        printf("%5zu %4.2lf \n", num_plaintext_bytes, timings[median]);
+        report_row(&report,
+                   histogram,
+                   counters_or_null,
+                   NUM_ITERATIONS,
+                   num_plaintext_bytes);
     }
 
     // ---------------------------------------------------------------------
     // Finalize
     // ---------------------------------------------------------------------
 
+    report_end(&report);
+
+    if (counters_or_null != NULL) {
+        perf_counters_close(counters_or_null);
+    }
+
+    free(histogram);
     finalize(&ctx);
     return 0;
 }
 
 // ---------------------------------------------------------------------
 
-int main() {
-    benchmark();
+/**
+ * Usage: benchmark-deoxysbc [--perf] [--text|--json|--csv], where --perf
+ * adds hardware counters to each row; the output is text by default.
+ */
+int main(int argc, char** argv) {
+    int use_counters = 0;
+    report_format_t format = REPORT_TEXT;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--perf") == 0) {
+            use_counters = 1;
+        } else if (report_parse_format(argv[i], &format) != 0) {
+            fprintf(stderr, "Usage: %s [--perf] [--text|--json|--csv]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    benchmark(use_counters, format);
     return 0;
 }
 
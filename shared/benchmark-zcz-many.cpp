@@ -0,0 +1,237 @@
+/*
+// @author anonymized
+// @last-modified 2018-08
+// Copyright 2018 anonymized
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+    #include "benchmark.h"
+    #include "utils-opt.h"
+    #include "zcz.h"
+}
+
+
+// ---------------------------------------------------------------------
+
+static const size_t NUM_ITERATIONS = 2000;
+static const size_t NUM_MESSAGES = 64;
+static const size_t NUM_MESSAGE_LENGTHS = 7;
+static const size_t MESSAGE_LENGTHS[NUM_MESSAGE_LENGTHS] = {
+    32, 64, 100, 128, 200, 256, 512
+};
+
+// ---------------------------------------------------------------------
+
+typedef struct {
+    ALIGN(16)
+    uint8_t key[ZCZ_NUM_KEY_BYTES];
+    zcz_ctx_t ctx;
+    uint8_t* plaintexts;
+    uint8_t* ciphertexts;
+    zcz_message_t messages[NUM_MESSAGES];
+} benchmark_ctx_t;
+
+// ---------------------------------------------------------------------
+
+static void fill(uint8_t* array, const size_t num_bytes) {
+    for (size_t i = 0; i < num_bytes; ++i) {
+        array[i] = i & 0xFF;
+    }
+}
+
+// ---------------------------------------------------------------------
+
+static size_t get_stride(const size_t num_bytes) {
+    return (num_bytes + ZCZ_NUM_BYTES_IN_DI_BLOCK - 1)
+        & ~(size_t)(ZCZ_NUM_BYTES_IN_DI_BLOCK - 1);
+}
+
+// ---------------------------------------------------------------------
+
+static void initialize(benchmark_ctx_t* context, const size_t max_num_bytes) {
+    const size_t num_bytes = NUM_MESSAGES * get_stride(max_num_bytes);
+
+    fill(context->key, ZCZ_NUM_KEY_BYTES);
+    zcz_keysetup(&(context->ctx), context->key);
+
+    context->plaintexts = (uint8_t*)malloc(num_bytes);
+    context->ciphertexts = (uint8_t*)malloc(num_bytes);
+
+    fill(context->plaintexts, num_bytes);
+}
+
+// ---------------------------------------------------------------------
+
+static void finalize(benchmark_ctx_t* context) {
+    free(context->plaintexts);
+    free(context->ciphertexts);
+}
+
+// ---------------------------------------------------------------------
+
+static void set_messages(benchmark_ctx_t* context, const size_t num_bytes) {
+    const size_t stride = get_stride(num_bytes);
+
+    for (size_t i = 0; i < NUM_MESSAGES; ++i) {
+        context->messages[i].in = context->plaintexts + i * stride;
+        context->messages[i].num_bytes = num_bytes;
+        context->messages[i].out = context->ciphertexts + i * stride;
+    }
+}
+
+// ---------------------------------------------------------------------
+
+typedef void (*operation_t)(benchmark_ctx_t* context);
+
+// ---------------------------------------------------------------------
+
+static void run_loop(benchmark_ctx_t* context) {
+    for (size_t i = 0; i < NUM_MESSAGES; ++i) {
+        const zcz_message_t* message = context->messages + i;
+        zcz_encrypt(&(context->ctx),
+                    message->in,
+                    message->num_bytes,
+                    message->out);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+static void run_many(benchmark_ctx_t* context) {
+    zcz_encrypt_many(&(context->ctx), context->messages, NUM_MESSAGES);
+}
+
+// ---------------------------------------------------------------------
+
+static double get_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Returns the median number of cycles per message, and stores the number
+ * of messages per second over all iterations in messages_per_second.
+ */
+static double measure_median(benchmark_ctx_t* context,
+                             const operation_t run_operation,
+                             const uint64_t calibration,
+                             double* timings,
+                             double* messages_per_second) {
+    uint64_t t0;
+    uint64_t t1;
+    const double start = get_seconds();
+
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        t0 = get_time();
+        run_operation(context);
+        t1 = get_time();
+        timings[i] = (double)(t1 - t0 - calibration) / NUM_MESSAGES;
+    }
+
+    *messages_per_second =
+        (double)(NUM_ITERATIONS * NUM_MESSAGES) / (get_seconds() - start);
+
+    qsort(timings, NUM_ITERATIONS, sizeof(double), compare_doubles);
+    return timings[NUM_ITERATIONS / 2];
+}
+
+// ---------------------------------------------------------------------
+
+static void measure(benchmark_ctx_t* context,
+                    const size_t num_bytes,
+                    const uint64_t calibration,
+                    double* timings) {
+    double loop_messages_per_second;
+    double many_messages_per_second;
+
+    set_messages(context, num_bytes);
+
+    const double loop_cycles = measure_median(
+        context, run_loop, calibration, timings, &loop_messages_per_second);
+    const double many_cycles = measure_median(
+        context, run_many, calibration, timings, &many_messages_per_second);
+
+    printf("%5zu %9.0lf %9.0lf %7.1lf %7.1lf %4.2lf \n",
+           num_bytes,
+           loop_messages_per_second,
+           many_messages_per_second,
+           loop_cycles,
+           many_cycles,
+           loop_cycles / many_cycles);
+}
+
+// ---------------------------------------------------------------------
+
+static int benchmark() {
+    benchmark_ctx_t ctx;
+    initialize(&ctx, MESSAGE_LENGTHS[NUM_MESSAGE_LENGTHS - 1]);
+
+    const uint64_t calibration = calibrate_timer();
+    double timings[NUM_ITERATIONS];
+
+    // ---------------------------------------------------------------------
+    // Warm up
+    // ---------------------------------------------------------------------
+
+    set_messages(&ctx, MESSAGE_LENGTHS[0]);
+
+    for (size_t i = 0; i < NUM_ITERATIONS / 4; ++i) {
+        run_loop(&ctx);
+        run_many(&ctx);
+    }
+
+    // ---------------------------------------------------------------------
+    // Benchmark
+    // ---------------------------------------------------------------------
+
+    printf("#ISA %s, %zu messages per call\n",
+           zcz_isa_name(&(ctx.ctx)),
+           NUM_MESSAGES);
+    puts("#Bytes msgs/s(loop) msgs/s(many) cpm(loop) cpm(many) speedup");
+
+    for (size_t j = 0; j < NUM_MESSAGE_LENGTHS; j++) {
+        measure(&ctx, MESSAGE_LENGTHS[j], calibration, timings);
+    }
+
+    finalize(&ctx);
+    return 0;
+}
+
+// ---------------------------------------------------------------------
+
+int main() {
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,212 @@
+/*
+// @author anonymized
+// @last-modified 2018-08
+// Copyright 2018 anonymized
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" {
+    #include "benchmark.h"
+    #include "utils-opt.h"
+    #include "zcz.h"
+}
+
+
+// ---------------------------------------------------------------------
+
+static const size_t NUM_ITERATIONS = 25;
+static const size_t NUM_MESSAGE_BYTES = 16 * 1024 * 1024;
+
+// ---------------------------------------------------------------------
+
+typedef struct {
+    ALIGN(16)
+    uint8_t key[ZCZ_NUM_KEY_BYTES];
+    zcz_ctx_t ctx;
+    uint8_t* plaintext;
+    uint8_t* ciphertext;
+} benchmark_ctx_t;
+
+// ---------------------------------------------------------------------
+
+static void fill(uint8_t* array, const size_t num_bytes) {
+    for (size_t i = 0; i < num_bytes; ++i) {
+        array[i] = i & 0xFF;
+    }
+}
+
+// ---------------------------------------------------------------------
+
+static void initialize(benchmark_ctx_t* context) {
+    fill(context->key, ZCZ_NUM_KEY_BYTES);
+    zcz_keysetup(&(context->ctx), context->key);
+
+    context->plaintext = (uint8_t*)aligned_alloc(ZCZ_WORKSPACE_ALIGNMENT,
+                                                 NUM_MESSAGE_BYTES);
+    context->ciphertext = (uint8_t*)aligned_alloc(ZCZ_WORKSPACE_ALIGNMENT,
+                                                  NUM_MESSAGE_BYTES);
+
+    fill(context->plaintext, NUM_MESSAGE_BYTES);
+}
+
+// ---------------------------------------------------------------------
+
+static void finalize(benchmark_ctx_t* context) {
+    free(context->plaintext);
+    free(context->ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+static double get_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Returns the median number of cycles per byte of the calling thread's
+ * time-stamp counter, that is, of wall-clock time, and stores the best
+ * throughput in bytes_per_second.
+ */
+static double measure_median(benchmark_ctx_t* context,
+                             zcz_pool_t* pool,
+                             const uint64_t calibration,
+                             double* timings,
+                             double* bytes_per_second) {
+    uint64_t t0;
+    uint64_t t1;
+    double best_seconds = 0;
+
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        const double start = get_seconds();
+        t0 = get_time();
+        zcz_encrypt_parallel(&(context->ctx),
+                             pool,
+                             context->plaintext,
+                             NUM_MESSAGE_BYTES,
+                             context->ciphertext);
+        t1 = get_time();
+        const double seconds = get_seconds() - start;
+
+        timings[i] = (double)(t1 - t0 - calibration) / NUM_MESSAGE_BYTES;
+
+        if ((i == 0) || (seconds < best_seconds)) {
+            best_seconds = seconds;
+        }
+    }
+
+    *bytes_per_second = (double)NUM_MESSAGE_BYTES / best_seconds;
+
+    qsort(timings, NUM_ITERATIONS, sizeof(double), compare_doubles);
+    return timings[NUM_ITERATIONS / 2];
+}
+
+// ---------------------------------------------------------------------
+
+static int run_scaling_benchmark(const size_t max_num_threads) {
+    benchmark_ctx_t ctx;
+    initialize(&ctx);
+
+    const uint64_t calibration = calibrate_timer();
+    double timings[NUM_ITERATIONS];
+    double single_thread_cycles = 0;
+
+    printf("#ISA %s, %zu bytes per message\n",
+           zcz_isa_name(&(ctx.ctx)),
+           NUM_MESSAGE_BYTES);
+    puts("#Threads cpb MiB/s speedup");
+
+    for (size_t num_threads = 1; num_threads <= max_num_threads;
+         ++num_threads) {
+        zcz_pool_t* pool = zcz_pool_create(num_threads);
+
+        if (pool == NULL) {
+            fprintf(stderr, "Cannot start %zu threads\n", num_threads);
+            break;
+        }
+
+        double bytes_per_second;
+
+        // Warm up
+        zcz_encrypt_parallel(&(ctx.ctx),
+                             pool,
+                             ctx.plaintext,
+                             NUM_MESSAGE_BYTES,
+                             ctx.ciphertext);
+
+        const double cycles = measure_median(
+            &ctx, pool, calibration, timings, &bytes_per_second);
+
+        if (num_threads == 1) {
+            single_thread_cycles = cycles;
+        }
+
+        printf("%8zu %5.3lf %7.0lf %5.2lf\n",
+               num_threads,
+               cycles,
+               bytes_per_second / (1024 * 1024),
+               single_thread_cycles / cycles);
+
+        zcz_pool_destroy(pool);
+    }
+
+    finalize(&ctx);
+    return 0;
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Usage: benchmark-zcz-parallel [max_num_threads], by default the number of
+ * online CPUs.
+ */
+int main(int argc, char** argv) {
+    long max_num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (argc > 1) {
+        max_num_threads = strtol(argv[1], NULL, 10);
+    }
+
+    if (max_num_threads < 1) {
+        max_num_threads = 1;
+    }
+
+    if (max_num_threads > ZCZ_POOL_MAX_NUM_THREADS) {
+        max_num_threads = ZCZ_POOL_MAX_NUM_THREADS;
+    }
+
+    run_scaling_benchmark((size_t)max_num_threads);
+    return 0;
+}
@@ -50,21 +50,58 @@ static const size_t MESSAGE_LENGTHS[NUM_MESSAGE_LENGTHS] = {
 };
 static const size_t NUM_BYTES_PER_INTERVAL = 32;
 
+typedef struct {
+    const char* name;
+    zcz_isa_t isa;
+} isa_option_t;
+
+static const size_t NUM_ISA_OPTIONS = 6;
+static const isa_option_t ISA_OPTIONS[NUM_ISA_OPTIONS] = {
+    { "auto", ZCZ_ISA_AUTO },
+    { "ssse3", ZCZ_ISA_SSSE3 },
+    { "avx2_bitsliced", ZCZ_ISA_AVX2_BITSLICED },
+    { "sse4", ZCZ_ISA_SSE4 },
+    { "avx2", ZCZ_ISA_AVX2 },
+    { "avx512", ZCZ_ISA_AVX512 }
+};
+
 // ---------------------------------------------------------------------
 
 typedef struct {
     ALIGN(16)
     uint8_t key[ZCZ_NUM_KEY_BYTES];
     zcz_ctx_t ctx;
+    zcz_isa_t isa;
     ALIGN(16)
     uint8_t* plaintext;
     uint8_t* ciphertext;
     size_t num_bytes;
     size_t max_num_bytes;
+    perf_counters_t* counters;
+    report_t* report;
 } benchmark_ctx_t;
 
 // ---------------------------------------------------------------------
 
+typedef void (*operation_t)(benchmark_ctx_t* context,
+                            const size_t num_bytes);
+
+/**
+ * One operation to time. Modes time messages of up to max_num_bytes bytes
+ * of the message-length grid and report cycles per byte; modes with
+ * max_num_bytes = 0 do not depend on the message and report cycles. Modes
+ * with layer_names report the mean cycles per byte of each zcz_stats_t
+ * phase instead.
+ */
+typedef struct {
+    const char* name;
+    operation_t run_operation;
+    size_t max_num_bytes;
+    const char* const* layer_names;
+} benchmark_mode_t;
+
+// ---------------------------------------------------------------------
+
 static void fill(uint8_t* array, const size_t num_bytes) {
     for (size_t i = 0; i < num_bytes; ++i) {
         array[i] = i & 0xFF;
@@ -73,27 +110,40 @@ static void fill(uint8_t* array, const size_t num_bytes) {
 
 // ---------------------------------------------------------------------
 
-static void initialize(benchmark_ctx_t* context, const size_t max_num_bytes) {
+static int initialize(benchmark_ctx_t* context,
+                      const size_t max_num_bytes,
+                      const zcz_isa_t isa) {
     fill(context->key, ZCZ_NUM_KEY_BYTES);
-    zcz_keysetup(&(context->ctx), context->key);
 
+    if (zcz_keysetup_isa(&(context->ctx), context->key, isa) != 0) {
+        return -1;
+    }
+
+    context->isa = isa;
+    context->counters = NULL;
     context->plaintext = (uint8_t*)malloc(max_num_bytes);
     context->ciphertext = (uint8_t*)malloc(max_num_bytes);
 
     fill(context->plaintext, max_num_bytes);
+    fill(context->ciphertext, max_num_bytes);
+    return 0;
 }
 
 // ---------------------------------------------------------------------
 
 static void finalize(benchmark_ctx_t* context) {
+    if (context->counters != NULL) {
+        perf_counters_close(context->counters);
+    }
+
     free(context->plaintext);
     free(context->ciphertext);
 }
 
 // ---------------------------------------------------------------------
 
-static void run_operation(benchmark_ctx_t* context,
-                          const size_t num_plaintext_bytes) {
+static void run_encryption(benchmark_ctx_t* context,
+                           const size_t num_plaintext_bytes) {
     uint8_t* plaintext = context->plaintext;
     uint8_t* ciphertext = context->ciphertext;
 
@@ -102,99 +152,396 @@ static void run_operation(benchmark_ctx_t* context,
 
 // ---------------------------------------------------------------------
 
-static int benchmark() {
-    // ---------------------------------------------------------------------
-    // Initialization
-    // ---------------------------------------------------------------------
+static void run_decryption(benchmark_ctx_t* context,
+                           const size_t num_ciphertext_bytes) {
+    uint8_t* plaintext = context->plaintext;
+    uint8_t* ciphertext = context->ciphertext;
 
-    size_t num_plaintext_bytes;
-    benchmark_ctx_t ctx;
-    initialize(&ctx, MESSAGE_LENGTHS[NUM_MESSAGE_LENGTHS-1]);
+    zcz_decrypt(&(context->ctx), ciphertext, num_ciphertext_bytes, plaintext);
+}
 
-    // ---------------------------------------------------------------------
-    // Warm up
-    // ---------------------------------------------------------------------
+// ---------------------------------------------------------------------
 
-    const uint64_t calibration = calibrate_timer();
+static void run_basic_encryption(benchmark_ctx_t* context,
+                                 const size_t num_plaintext_bytes) {
+    uint8_t* plaintext = context->plaintext;
+    uint8_t* ciphertext = context->ciphertext;
+
+    zcz_basic_encrypt(&(context->ctx),
+                      plaintext,
+                      num_plaintext_bytes,
+                      ciphertext);
+}
+
+// ---------------------------------------------------------------------
+
+static void run_basic_decryption(benchmark_ctx_t* context,
+                                 const size_t num_ciphertext_bytes) {
+    uint8_t* plaintext = context->plaintext;
+    uint8_t* ciphertext = context->ciphertext;
+
+    zcz_basic_decrypt(&(context->ctx),
+                      ciphertext,
+                      num_ciphertext_bytes,
+                      plaintext);
+}
+
+// ---------------------------------------------------------------------
+
+static void run_keysetup(benchmark_ctx_t* context, const size_t num_bytes) {
+    (void)num_bytes;
+    zcz_keysetup_isa(&(context->ctx), context->key, context->isa);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * The cost of a new connection: a key setup followed by its first message.
+ */
+static void run_keysetup_and_encryption(benchmark_ctx_t* context,
+                                        const size_t num_plaintext_bytes) {
+    run_keysetup(context, num_plaintext_bytes);
+    run_encryption(context, num_plaintext_bytes);
+}
+
+// ---------------------------------------------------------------------
+
+#ifdef ZCZ_STATS
+static const char* const ENCRYPTION_LAYER_NAMES[ZCZ_STATS_NUM_PHASES] = {
+    "top", "top_last", "middle_bottom", "bottom_last", "partial"
+};
+static const char* const DECRYPTION_LAYER_NAMES[ZCZ_STATS_NUM_PHASES] = {
+    "bottom", "bottom_last", "middle_top", "top_last", "partial"
+};
+
+static const size_t NUM_MODES = 8;
+#else
+static const size_t NUM_MODES = 6;
+#endif  // ZCZ_STATS
+
+static const size_t BASIC_MAX = ZCZ_BASIC_MAX_NUM_MESSAGE_BYTES;
+static const benchmark_mode_t MODES[NUM_MODES] = {
+    { "encrypt", run_encryption, MAX_BUFFER_LEN, NULL },
+    { "decrypt", run_decryption, MAX_BUFFER_LEN, NULL },
+    { "basic_encrypt", run_basic_encryption, BASIC_MAX, NULL },
+    { "basic_decrypt", run_basic_decryption, BASIC_MAX, NULL },
+    { "keysetup", run_keysetup, 0, NULL },
+    { "keysetup_encrypt", run_keysetup_and_encryption, MAX_BUFFER_LEN, NULL },
+#ifdef ZCZ_STATS
+    { "layers_encrypt", run_encryption, MAX_BUFFER_LEN,
+      ENCRYPTION_LAYER_NAMES },
+    { "layers_decrypt", run_decryption, MAX_BUFFER_LEN,
+      DECRYPTION_LAYER_NAMES },
+#endif  // ZCZ_STATS
+};
+
+// ---------------------------------------------------------------------
+
+/**
+ * Records the cycles of NUM_ITERATIONS runs in histogram.
+ */
+static void measure_histogram(benchmark_ctx_t* context,
+                              const operation_t run_operation,
+                              const size_t num_bytes,
+                              const uint64_t calibration,
+                              histogram_t* histogram) {
     uint64_t t0;
     uint64_t t1;
 
-    puts("#Bytes cpb");
+    histogram_reset(histogram);
+
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        t0 = get_time();
+        run_operation(context, num_bytes);
+        t1 = get_time();
+        histogram_record(histogram,
+                         (t1 - t0 > calibration) ? t1 - t0 - calibration : 0);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Counts the events of another NUM_ITERATIONS runs, untimed so that the
+ * reading of the time stamp counter does not add to them.
+ */
+static void measure_counters(benchmark_ctx_t* context,
+                             const operation_t run_operation,
+                             const size_t num_bytes) {
+    perf_counters_start(context->counters);
+
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        run_operation(context, num_bytes);
+    }
+
+    perf_counters_stop(context->counters);
+}
+
+// ---------------------------------------------------------------------
+
+#ifdef ZCZ_STATS
+/**
+ * Prints the mean cycles per byte of each phase over NUM_ITERATIONS runs,
+ * and their sum.
+ */
+static void measure_layers(benchmark_ctx_t* context,
+                           const benchmark_mode_t* mode,
+                           const size_t num_bytes) {
+    zcz_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    zcz_set_stats(&(context->ctx), &stats);
+
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        mode->run_operation(context, num_bytes);
+    }
+
+    zcz_set_stats(&(context->ctx), NULL);
+
+    const double divisor = (double)stats.num_calls * num_bytes;
+    double total = 0;
+    printf("%5zu", num_bytes);
+
+    for (size_t i = 0; i < ZCZ_STATS_NUM_PHASES; ++i) {
+        printf(" %4.2lf", stats.cycles[i] / divisor);
+        total += stats.cycles[i] / divisor;
+    }
+
+    printf(" %4.2lf \n", total);
+}
+
+// ---------------------------------------------------------------------
+
+static void print_layers_header(const benchmark_mode_t* mode) {
+    fputs("#Bytes", stdout);
+
+    for (size_t i = 0; i < ZCZ_STATS_NUM_PHASES; ++i) {
+        printf(" cpb(%s)", mode->layer_names[i]);
+    }
+
+    puts(" cpb(total)");
+}
+#endif  // ZCZ_STATS
+
+// ---------------------------------------------------------------------
+
+static void measure(benchmark_ctx_t* context,
+                    const benchmark_mode_t* mode,
+                    const size_t num_bytes,
+                    const uint64_t calibration,
+                    histogram_t* histogram) {
+#ifdef ZCZ_STATS
+    if (mode->layer_names != NULL) {
+        measure_layers(context, mode, num_bytes);
+        return;
+    }
+#endif  // ZCZ_STATS
+
+    measure_histogram(
+        context, mode->run_operation, num_bytes, calibration, histogram);
+
+    if (context->counters != NULL) {
+        measure_counters(context, mode->run_operation, num_bytes);
+    }
+
+    report_row(context->report,
+               histogram,
+               context->counters,
+               NUM_ITERATIONS,
+               num_bytes);
+}
+
+// ---------------------------------------------------------------------
+
+static void benchmark_mode(benchmark_ctx_t* context,
+                           const benchmark_mode_t* mode,
+                           const uint64_t calibration,
+                           histogram_t* histogram) {
+#ifdef ZCZ_STATS
+    if ((mode->layer_names != NULL)
+        && (context->report->format != REPORT_TEXT)) {
+        fprintf(stderr, "Skipping %s, which prints text only\n", mode->name);
+        return;
+    }
+#endif  // ZCZ_STATS
+
+    // ---------------------------------------------------------------------
+    // Warm up
+    // ---------------------------------------------------------------------
+
+    const size_t num_warm_up_bytes = (mode->max_num_bytes == 0) ? 0 : 2048;
 
     for (size_t i = 0; i < NUM_ITERATIONS / 4; ++i) {
-        num_plaintext_bytes = 2048;
-        run_operation(&ctx, num_plaintext_bytes);
+        mode->run_operation(context, num_warm_up_bytes);
     }
 
-    double timings[NUM_ITERATIONS];
-    const uint32_t median = NUM_ITERATIONS / 2;
+    if (mode->max_num_bytes == 0) {
+        report_begin_mode(context->report, mode->name, 0);
+        measure(context, mode, 0, calibration, histogram);
+        return;
+    }
 
-    const size_t min_num_bytes = MESSAGE_LENGTHS[0];
+#ifdef ZCZ_STATS
+    if (mode->layer_names != NULL) {
+        printf("#Mode %s\n", mode->name);
+        print_layers_header(mode);
+    }
+#endif  // ZCZ_STATS
+
+    if (mode->layer_names == NULL) {
+        // The first value column keeps the median cpb for plot.py.
+        report_begin_mode(context->report, mode->name, 1);
+    }
 
     // ---------------------------------------------------------------------
     // Benchmark
     // ---------------------------------------------------------------------
 
-    for (size_t j = min_num_bytes;
+    for (size_t j = MESSAGE_LENGTHS[0];
         j <= MAX_NUM_BYTES_CONTINUOUS;
         j += NUM_BYTES_PER_INTERVAL) {
-        num_plaintext_bytes = j;
+        measure(context, mode, j, calibration, histogram);
+    }
 
-        t0 = get_time();
-        t1 = get_time();
+    // ---------------------------------------------------------------------
+    // Benchmark
+    // ---------------------------------------------------------------------
 
-        for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
-            t0 = get_time();
-            run_operation(&ctx, num_plaintext_bytes);
-            t1 = get_time();
-            timings[i] = (double)(t1 - t0 - calibration) / num_plaintext_bytes;
+    for (size_t j = 7; j < NUM_MESSAGE_LENGTHS; j++) {
+        if (MESSAGE_LENGTHS[j] > mode->max_num_bytes) {
+            break;
         }
 
-        // ---------------------------------------------------------------------
-        // Sort the measurements and print the median
-        // ---------------------------------------------------------------------
-
-        qsort(timings, NUM_ITERATIONS, sizeof(double), compare_doubles);
-        printf("%5zu %4.2lf \n", num_plaintext_bytes, timings[median]);
+        measure(context, mode, MESSAGE_LENGTHS[j], calibration, histogram);
     }
+}
 
+// ---------------------------------------------------------------------
+
+static int benchmark(const zcz_isa_t isa,
+                     const int* is_mode_selected,
+                     const int use_counters,
+                     const report_format_t format) {
     // ---------------------------------------------------------------------
-    // Benchmark
+    // Initialization
     // ---------------------------------------------------------------------
 
-    for (size_t j = 7; j < NUM_MESSAGE_LENGTHS; j++) {
-        num_plaintext_bytes = MESSAGE_LENGTHS[j];
+    benchmark_ctx_t ctx;
 
-        t0 = get_time();
-        t1 = get_time();
+    if (initialize(&ctx, MESSAGE_LENGTHS[NUM_MESSAGE_LENGTHS-1], isa) != 0) {
+        fputs("The CPU does not support the instruction set\n", stderr);
+        return 1;
+    }
 
-        for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
-            t0 = get_time();
-            run_operation(&ctx, num_plaintext_bytes);
-            t1 = get_time();
-            timings[i] = (double)(t1 - t0 - calibration) / num_plaintext_bytes;
-        }
+    perf_counters_t counters;
 
-        // ---------------------------------------------------------------------
-        // Sort the measurements and print the median
-        // ---------------------------------------------------------------------
+    if (use_counters && (perf_counters_open(&counters) != 0)) {
+        fputs("Hardware counters are unavailable, timing only\n", stderr);
+    } else if (use_counters) {
+        ctx.counters = &counters;
+    }
 
-        qsort(timings, NUM_ITERATIONS, sizeof(double), compare_doubles);
-        printf("%5zu %4.2lf \n", num_plaintext_bytes, timings[median]);
+    const uint64_t calibration = calibrate_timer();
+    histogram_t* histogram = (histogram_t*)malloc(sizeof(histogram_t));
+
+    report_t report;
+    ctx.report = &report;
+    report_begin(&report,
+                 format,
+                 "benchmark-zcz",
+                 zcz_isa_name(&(ctx.ctx)),
+                 ctx.counters != NULL);
+
+    for (size_t i = 0; i < NUM_MODES; ++i) {
+        if (is_mode_selected[i]) {
+            benchmark_mode(&ctx, &(MODES[i]), calibration, histogram);
+        }
     }
 
     // ---------------------------------------------------------------------
     // Finalize
     // ---------------------------------------------------------------------
 
+    report_end(&report);
+    free(histogram);
     finalize(&ctx);
     return 0;
 }
 
 // ---------------------------------------------------------------------
 
-int main() {
-    benchmark();
-    return 0;
+static void print_usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [--perf] [--text|--json|--csv] [isa] [mode...]\n",
+            program);
+    fputs("isa:", stderr);
+
+    for (size_t i = 0; i < NUM_ISA_OPTIONS; ++i) {
+        fprintf(stderr, " %s", ISA_OPTIONS[i].name);
+    }
+
+    fputs("\nmode:", stderr);
+
+    for (size_t i = 0; i < NUM_MODES; ++i) {
+        fprintf(stderr, " %s", MODES[i].name);
+    }
+
+    fputs("\n", stderr);
 }
 
+// ---------------------------------------------------------------------
+
+/**
+ * Usage: benchmark-zcz [--perf] [--text|--json|--csv] [isa] [mode...],
+ * where isa is one of the names in ISA_OPTIONS, by default auto, and the
+ * modes are names in MODES, by default all of them. --perf adds hardware
+ * counters to each row; the output is text by default.
+ */
+int main(int argc, char** argv) {
+    zcz_isa_t isa = ZCZ_ISA_AUTO;
+    int is_mode_selected[NUM_MODES] = { 0 };
+    int has_selected_modes = 0;
+    int use_counters = 0;
+    report_format_t format = REPORT_TEXT;
+
+    for (int i = 1; i < argc; ++i) {
+        int is_known = 0;
+
+        if (strcmp(argv[i], "--perf") == 0) {
+            use_counters = 1;
+            continue;
+        }
+
+        if (report_parse_format(argv[i], &format) == 0) {
+            continue;
+        }
+
+        for (size_t j = 0; j < NUM_ISA_OPTIONS; ++j) {
+            if (strcmp(argv[i], ISA_OPTIONS[j].name) == 0) {
+                isa = ISA_OPTIONS[j].isa;
+                is_known = 1;
+            }
+        }
+
+        for (size_t j = 0; j < NUM_MODES; ++j) {
+            if (strcmp(argv[i], MODES[j].name) == 0) {
+                is_mode_selected[j] = 1;
+                has_selected_modes = 1;
+                is_known = 1;
+            }
+        }
+
+        if (!is_known) {
+            fprintf(stderr, "Unknown instruction set or mode %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!has_selected_modes) {
+        for (size_t j = 0; j < NUM_MODES; ++j) {
+            is_mode_selected[j] = 1;
+        }
+    }
+
+    return benchmark(isa, is_mode_selected, use_counters, format);
+}
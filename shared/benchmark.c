@@ -27,14 +27,790 @@
 //
 // For more information, please refer to <http://unlicense.org/>
 */
+
+// For syscall() and ssize_t under -std=c11
+#define _GNU_SOURCE
+
+#include <cpuid.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "benchmark.h"
 
+// ---------------------------------------------------------------------
+// Histograms
+// ---------------------------------------------------------------------
+
+#define NUM_LINEAR_BUCKETS      (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define NUM_SUB_BUCKETS         (1 << (HISTOGRAM_SUB_BUCKET_BITS - 1))
+
+// ---------------------------------------------------------------------
+
+static size_t get_bucket(const uint64_t value) {
+    if (value < NUM_LINEAR_BUCKETS) {
+        return (size_t)value;
+    }
+
+    const size_t exponent = 63 - __builtin_clzll(value);
+
+    if (exponent >= HISTOGRAM_MAX_EXPONENT) {
+        return HISTOGRAM_NUM_BUCKETS - 1;
+    }
+
+    // The upper HISTOGRAM_SUB_BUCKET_BITS bits, starting with the leading 1
+    const size_t shift = exponent - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+    const size_t mantissa = (size_t)(value >> shift);
+
+    return NUM_LINEAR_BUCKETS
+        + (exponent - HISTOGRAM_SUB_BUCKET_BITS) * NUM_SUB_BUCKETS
+        + (mantissa - NUM_SUB_BUCKETS);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Returns the middle of the values that fall into the given bucket.
+ */
+static uint64_t get_bucket_value(const size_t bucket) {
+    if (bucket < NUM_LINEAR_BUCKETS) {
+        return bucket;
+    }
+
+    const size_t i = bucket - NUM_LINEAR_BUCKETS;
+    const size_t exponent = HISTOGRAM_SUB_BUCKET_BITS + i / NUM_SUB_BUCKETS;
+    const size_t shift = exponent - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+    const uint64_t mantissa = NUM_SUB_BUCKETS + i % NUM_SUB_BUCKETS;
+
+    return (mantissa << shift) + (((uint64_t)1 << shift) - 1) / 2;
+}
+
+// ---------------------------------------------------------------------
+
+void histogram_reset(histogram_t* histogram) {
+    memset(histogram->counts, 0, sizeof(histogram->counts));
+    histogram->num_samples = 0;
+    histogram->min = UINT64_MAX;
+    histogram->max = 0;
+}
+
+// ---------------------------------------------------------------------
+
+void histogram_record(histogram_t* histogram, const uint64_t value) {
+    histogram->counts[get_bucket(value)]++;
+    histogram->num_samples++;
+
+    if (value < histogram->min) {
+        histogram->min = value;
+    }
+
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+// ---------------------------------------------------------------------
+
+uint64_t histogram_percentile(const histogram_t* histogram,
+                              const double percentage) {
+    if (histogram->num_samples == 0) {
+        return 0;
+    }
+
+    if (percentage <= 0) {
+        return histogram->min;
+    }
+
+    if (percentage >= 100) {
+        return histogram->max;
+    }
+
+    // The rank of the sample, counted from 1
+    uint64_t rank = (uint64_t)(percentage * histogram->num_samples / 100);
+
+    if ((double)rank * 100 < percentage * histogram->num_samples) {
+        rank++;
+    }
+
+    uint64_t num_samples = 0;
+
+    for (size_t i = 0; i < HISTOGRAM_NUM_BUCKETS; ++i) {
+        num_samples += histogram->counts[i];
+
+        if (num_samples >= rank) {
+            const uint64_t value = get_bucket_value(i);
+
+            if (value < histogram->min) {
+                return histogram->min;
+            }
+
+            return (value > histogram->max) ? histogram->max : value;
+        }
+    }
+
+    return histogram->max;
+}
+
+// ---------------------------------------------------------------------
+
+uint64_t histogram_count_above(const histogram_t* histogram,
+                               const uint64_t value) {
+    uint64_t num_samples = 0;
+
+    for (size_t i = get_bucket(value) + 1; i < HISTOGRAM_NUM_BUCKETS; ++i) {
+        num_samples += histogram->counts[i];
+    }
+
+    return num_samples;
+}
+
+// ---------------------------------------------------------------------
+
+void histogram_median_interval(const histogram_t* histogram,
+                               uint64_t* low,
+                               uint64_t* high) {
+    // Normal approximation of the binomial distribution of the rank
+    const double half_width = (histogram->num_samples == 0)
+        ? 0 : 98 / sqrt((double)histogram->num_samples);
+
+    *low = histogram_percentile(histogram, 50 - half_width);
+    *high = histogram_percentile(histogram, 50 + half_width);
+}
+
+// ---------------------------------------------------------------------
+
+void histogram_print_header(const char* unit) {
+    printf("#Bytes %s(p50) %s(min) %s(p90) %s(p99) %s(p99.9) %s(max) "
+           "outliers",
+           unit, unit, unit, unit, unit, unit);
+}
+
+// ---------------------------------------------------------------------
+
+void histogram_print_row(const histogram_t* histogram,
+                         const size_t num_bytes) {
+    const double divisor = (num_bytes == 0) ? 1 : (double)num_bytes;
+    const uint64_t median = histogram_percentile(histogram, 50);
+    const uint64_t num_outliers = histogram_count_above(
+        histogram, HISTOGRAM_OUTLIER_FACTOR * median);
+
+    printf("%5zu %4.2lf %4.2lf %4.2lf %4.2lf %4.2lf %4.2lf %llu",
+           num_bytes,
+           median / divisor,
+           histogram->min / divisor,
+           histogram_percentile(histogram, 90) / divisor,
+           histogram_percentile(histogram, 99) / divisor,
+           histogram_percentile(histogram, 99.9) / divisor,
+           histogram->max / divisor,
+           (unsigned long long)num_outliers);
+}
+
+// ---------------------------------------------------------------------
+// Performance counters
+// ---------------------------------------------------------------------
+
+#ifdef __linux__
+#define CACHE_READ_MISSES(cache) \
+    ((cache) \
+     | (PERF_COUNT_HW_CACHE_OP_READ << 8) \
+     | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+// The generic events have no L2 cache; last-level cache misses are those
+// that go to memory.
+static const uint32_t COUNTER_TYPES[NUM_COUNTERS] = {
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HW_CACHE,
+    PERF_TYPE_HW_CACHE,
+    PERF_TYPE_HARDWARE
+};
+static const uint64_t COUNTER_CONFIGS[NUM_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    CACHE_READ_MISSES(PERF_COUNT_HW_CACHE_L1D),
+    CACHE_READ_MISSES(PERF_COUNT_HW_CACHE_LL),
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+// ---------------------------------------------------------------------
+
+static int open_counter(const uint32_t type, const uint64_t config) {
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+#endif  // __linux__
+
+// ---------------------------------------------------------------------
+
+int perf_counters_open(perf_counters_t* counters) {
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+#ifdef __linux__
+        counters->fds[i] = open_counter(COUNTER_TYPES[i], COUNTER_CONFIGS[i]);
+#else
+        counters->fds[i] = -1;
+#endif
+        counters->values[i] = 0;
+    }
+
+    if (counters->fds[COUNTER_CORE_CYCLES] < 0) {
+        perf_counters_close(counters);
+        return -1;
+    }
+
+    return 0;
+}
+
+// ---------------------------------------------------------------------
+
+void perf_counters_close(perf_counters_t* counters) {
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+#ifdef __linux__
+        if (counters->fds[i] >= 0) {
+            close(counters->fds[i]);
+        }
+#endif
+        counters->fds[i] = -1;
+    }
+}
+
+// ---------------------------------------------------------------------
+
+void perf_counters_start(perf_counters_t* counters) {
+#ifdef __linux__
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+        }
+    }
+
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)counters;
+#endif
+}
+
+// ---------------------------------------------------------------------
+
+void perf_counters_stop(perf_counters_t* counters) {
+#ifdef __linux__
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+        // The value, the time enabled, and the time running
+        uint64_t result[3] = { 0, 0, 0 };
+        counters->values[i] = 0;
+
+        if ((counters->fds[i] < 0)
+            || (read(counters->fds[i], result, sizeof(result))
+                != (ssize_t)sizeof(result))
+            || (result[2] == 0)) {
+            continue;
+        }
+
+        counters->values[i] = (double)result[0] * result[1] / result[2];
+    }
+#else
+    (void)counters;
+#endif
+}
+
+// ---------------------------------------------------------------------
+
+// The columns of perf_counters_print_row() and the report, where the
+// instructions per cycle need two counters
+#define NUM_COUNTER_COLUMNS     6
+#define COUNTER_COLUMN_IPC      2
+
+static const counter_t COUNTER_COLUMNS[NUM_COUNTER_COLUMNS] = {
+    COUNTER_CORE_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_L1D_MISSES,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES
+};
+
+// ---------------------------------------------------------------------
+
+/**
+ * Sets value to the given column per run, or per byte for core cycles and
+ * instructions if num_bytes is not 0. Returns -1 if the counters of the
+ * column are unavailable, and 0 otherwise.
+ */
+static int get_counter_column(const perf_counters_t* counters,
+                              const size_t column,
+                              const size_t num_runs,
+                              const size_t num_bytes,
+                              double* value) {
+    const counter_t counter = COUNTER_COLUMNS[column];
+
+    if (counters->fds[counter] < 0) {
+        return -1;
+    }
+
+    if (column == COUNTER_COLUMN_IPC) {
+        if (counters->values[COUNTER_CORE_CYCLES] <= 0) {
+            return -1;
+        }
+
+        *value = counters->values[COUNTER_INSTRUCTIONS]
+            / counters->values[COUNTER_CORE_CYCLES];
+        return 0;
+    }
+
+    *value = counters->values[counter] / (double)num_runs;
+
+    if ((num_bytes != 0)
+        && ((counter == COUNTER_CORE_CYCLES)
+            || (counter == COUNTER_INSTRUCTIONS))) {
+        *value /= (double)num_bytes;
+    }
+
+    return 0;
+}
+
+// ---------------------------------------------------------------------
+
+void perf_counters_print_header(const int is_per_byte) {
+    if (is_per_byte) {
+        fputs(" core_cpb instructions_pb", stdout);
+    } else {
+        fputs(" core_cycles instructions", stdout);
+    }
+
+    fputs(" ipc l1d_misses llc_misses branch_misses", stdout);
+}
+
+// ---------------------------------------------------------------------
+
+void perf_counters_print_row(const perf_counters_t* counters,
+                             const size_t num_runs,
+                             const size_t num_bytes) {
+    double value;
+
+    for (size_t i = 0; i < NUM_COUNTER_COLUMNS; ++i) {
+        if (get_counter_column(counters, i, num_runs, num_bytes, &value)) {
+            fputs(" -", stdout);
+        } else {
+            printf(" %4.2lf", value);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+// Reports
+// ---------------------------------------------------------------------
+
+// Set by CMakeLists.txt
+#ifndef BENCHMARK_BUILD_TYPE
+#define BENCHMARK_BUILD_TYPE    "unknown"
+#endif
+
+#ifndef BENCHMARK_REVISION
+#define BENCHMARK_REVISION      "unknown"
+#endif
+
+#ifdef ZCZ_STATS
+#define BUILD_TYPE              BENCHMARK_BUILD_TYPE "+ZCZ_STATS"
+#else
+#define BUILD_TYPE              BENCHMARK_BUILD_TYPE
+#endif
+
+#define CPU_MODEL_LEN           48
+#define CPU_FLAGS_LEN           128
+#define NUM_CPU_FLAGS           9
+#define NUM_STATISTICS          6
+
+static const char* const STATISTIC_NAMES[NUM_STATISTICS] = {
+    "p50", "min", "p90", "p99", "p99.9", "max"
+};
+static const char* const COUNTER_COLUMN_NAMES[NUM_COUNTER_COLUMNS] = {
+    "core_cycles",
+    "instructions",
+    "ipc",
+    "l1d_misses",
+    "llc_misses",
+    "branch_misses"
+};
+
+/**
+ * The values of a row in the unit of the report.
+ */
+typedef struct {
+    double statistics[NUM_STATISTICS];
+    uint64_t num_outliers;
+    double median_low;
+    double median_high;
+} row_statistics_t;
+
+// ---------------------------------------------------------------------
+
+/**
+ * Reads the processor brand string with cpuid.
+ */
+static void get_cpu_model(char model[CPU_MODEL_LEN + 1]) {
+    unsigned int registers[12];
+
+    if (__get_cpuid_max(0x80000000, NULL) < 0x80000004) {
+        strcpy(model, "unknown");
+        return;
+    }
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        __get_cpuid(0x80000002 + i,
+                    &registers[4 * i],
+                    &registers[4 * i + 1],
+                    &registers[4 * i + 2],
+                    &registers[4 * i + 3]);
+    }
+
+    memcpy(model, registers, CPU_MODEL_LEN);
+    model[CPU_MODEL_LEN] = '\0';
+
+    const char* start = model;
+
+    while (*start == ' ') {
+        start++;
+    }
+
+    memmove(model, start, strlen(start) + 1);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Lists the supported extensions among those that select the variant of
+ * opt/dispatch.c, separated by spaces.
+ */
+static void get_cpu_flags(char flags[CPU_FLAGS_LEN]) {
+    __builtin_cpu_init();
+
+    // __builtin_cpu_supports() takes string literals only.
+    const char* const names[NUM_CPU_FLAGS] = {
+        "ssse3", "sse4.1", "aes", "pclmul", "avx2", "avx512f", "avx512bw",
+        "vaes", "vpclmulqdq"
+    };
+    const int is_supported[NUM_CPU_FLAGS] = {
+        __builtin_cpu_supports("ssse3"),
+        __builtin_cpu_supports("sse4.1"),
+        __builtin_cpu_supports("aes"),
+        __builtin_cpu_supports("pclmul"),
+        __builtin_cpu_supports("avx2"),
+        __builtin_cpu_supports("avx512f"),
+        __builtin_cpu_supports("avx512bw"),
+        __builtin_cpu_supports("vaes"),
+        __builtin_cpu_supports("vpclmulqdq")
+    };
+
+    flags[0] = '\0';
+
+    for (size_t i = 0; i < NUM_CPU_FLAGS; ++i) {
+        if (!is_supported[i]) {
+            continue;
+        }
+
+        if (flags[0] != '\0') {
+            strcat(flags, " ");
+        }
+
+        strcat(flags, names[i]);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+static void print_json_string(const char* string) {
+    if (string == NULL) {
+        fputs("null", stdout);
+        return;
+    }
+
+    putchar('"');
+
+    for (const char* c = string; *c != '\0'; ++c) {
+        if ((*c == '"') || (*c == '\\')) {
+            putchar('\\');
+            putchar(*c);
+        } else if ((unsigned char)*c < 0x20) {
+            printf("\\u%04x", (unsigned int)*c);
+        } else {
+            putchar(*c);
+        }
+    }
+
+    putchar('"');
+}
+
+// ---------------------------------------------------------------------
+
+int report_parse_format(const char* option, report_format_t* format) {
+    if (strcmp(option, "--text") == 0) {
+        *format = REPORT_TEXT;
+    } else if (strcmp(option, "--json") == 0) {
+        *format = REPORT_JSON;
+    } else if (strcmp(option, "--csv") == 0) {
+        *format = REPORT_CSV;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+// ---------------------------------------------------------------------
+
+void report_begin(report_t* report,
+                  const report_format_t format,
+                  const char* benchmark,
+                  const char* isa,
+                  const int has_counters) {
+    report->format = format;
+    report->benchmark = benchmark;
+    report->isa = isa;
+    report->mode = NULL;
+    report->is_per_byte = 1;
+    report->has_counters = has_counters;
+    report->num_rows = 0;
+
+    if (format == REPORT_TEXT) {
+        if (isa != NULL) {
+            printf("#ISA %s\n", isa);
+        }
+
+        return;
+    }
+
+    char model[CPU_MODEL_LEN + 1];
+    char flags[CPU_FLAGS_LEN];
+    get_cpu_model(model);
+    get_cpu_flags(flags);
+
+    if (format == REPORT_CSV) {
+        printf("# benchmark=%s\n", benchmark);
+        printf("# cpu=%s\n", model);
+        printf("# cpu_flags=%s\n", flags);
+        printf("# build_type=%s\n", BUILD_TYPE);
+        printf("# revision=%s\n", BENCHMARK_REVISION);
+        fputs("benchmark,isa,mode,bytes,unit", stdout);
+
+        for (size_t i = 0; i < NUM_STATISTICS; ++i) {
+            printf(",%s", STATISTIC_NAMES[i]);
+        }
+
+        fputs(",outliers,median_low,median_high", stdout);
+
+        for (size_t i = 0; has_counters && (i < NUM_COUNTER_COLUMNS); ++i) {
+            printf(",%s", COUNTER_COLUMN_NAMES[i]);
+        }
+
+        puts("");
+        return;
+    }
+
+    fputs("{\n  \"benchmark\": ", stdout);
+    print_json_string(benchmark);
+    fputs(",\n  \"isa\": ", stdout);
+    print_json_string(isa);
+    fputs(",\n  \"cpu\": ", stdout);
+    print_json_string(model);
+    fputs(",\n  \"cpu_flags\": ", stdout);
+    print_json_string(flags);
+    fputs(",\n  \"build_type\": ", stdout);
+    print_json_string(BUILD_TYPE);
+    fputs(",\n  \"revision\": ", stdout);
+    print_json_string(BENCHMARK_REVISION);
+    fputs(",\n  \"results\": [", stdout);
+}
+
+// ---------------------------------------------------------------------
+
+void report_begin_mode(report_t* report,
+                       const char* mode,
+                       const int is_per_byte) {
+    report->mode = mode;
+    report->is_per_byte = is_per_byte;
+
+    if (report->format != REPORT_TEXT) {
+        return;
+    }
+
+    printf("#Mode %s\n", mode);
+    histogram_print_header(is_per_byte ? "cpb" : "cycles");
+
+    if (report->has_counters) {
+        perf_counters_print_header(is_per_byte);
+    }
+
+    puts("");
+}
+
+// ---------------------------------------------------------------------
+
+static void print_csv_row(const report_t* report,
+                          const row_statistics_t* row,
+                          const perf_counters_t* counters,
+                          const size_t num_runs,
+                          const size_t num_bytes) {
+    double value;
+
+    printf("%s,%s,%s,%zu,%s",
+           report->benchmark,
+           (report->isa == NULL) ? "" : report->isa,
+           report->mode,
+           num_bytes,
+           report->is_per_byte ? "cpb" : "cycles");
+
+    for (size_t i = 0; i < NUM_STATISTICS; ++i) {
+        printf(",%.4lf", row->statistics[i]);
+    }
+
+    printf(",%llu,%.4lf,%.4lf",
+           (unsigned long long)row->num_outliers,
+           row->median_low,
+           row->median_high);
+
+    for (size_t i = 0; report->has_counters && (i < NUM_COUNTER_COLUMNS);
+        ++i) {
+        if (get_counter_column(counters, i, num_runs, num_bytes, &value)) {
+            putchar(',');
+        } else {
+            printf(",%.4lf", value);
+        }
+    }
+
+    puts("");
+}
+
+// ---------------------------------------------------------------------
+
+static void print_json_row(const report_t* report,
+                           const row_statistics_t* row,
+                           const perf_counters_t* counters,
+                           const size_t num_runs,
+                           const size_t num_bytes) {
+    double value;
+
+    fputs((report->num_rows == 0) ? "\n    {\"mode\": " : ",\n    {\"mode\": ",
+          stdout);
+    print_json_string(report->mode);
+    printf(", \"bytes\": %zu, \"unit\": \"%s\"",
+           num_bytes,
+           report->is_per_byte ? "cpb" : "cycles");
+
+    for (size_t i = 0; i < NUM_STATISTICS; ++i) {
+        printf(", \"%s\": %.4lf", STATISTIC_NAMES[i], row->statistics[i]);
+    }
+
+    printf(", \"outliers\": %llu, \"median_interval\": [%.4lf, %.4lf]",
+           (unsigned long long)row->num_outliers,
+           row->median_low,
+           row->median_high);
+
+    if (report->has_counters) {
+        fputs(", \"counters\": {", stdout);
+
+        for (size_t i = 0; i < NUM_COUNTER_COLUMNS; ++i) {
+            printf("%s\"%s\": ", (i == 0) ? "" : ", ", COUNTER_COLUMN_NAMES[i]);
+
+            if (get_counter_column(counters, i, num_runs, num_bytes, &value)) {
+                fputs("null", stdout);
+            } else {
+                printf("%.4lf", value);
+            }
+        }
+
+        putchar('}');
+    }
+
+    putchar('}');
+}
+
+// ---------------------------------------------------------------------
+
+void report_row(report_t* report,
+                const histogram_t* histogram,
+                const perf_counters_t* counters,
+                const size_t num_runs,
+                const size_t num_bytes) {
+    if (report->format == REPORT_TEXT) {
+        histogram_print_row(histogram, num_bytes);
+
+        if (report->has_counters) {
+            perf_counters_print_row(counters, num_runs, num_bytes);
+        }
+
+        puts("");
+        return;
+    }
+
+    const double divisor = (num_bytes == 0) ? 1 : (double)num_bytes;
+    const uint64_t median = histogram_percentile(histogram, 50);
+    uint64_t median_low;
+    uint64_t median_high;
+    histogram_median_interval(histogram, &median_low, &median_high);
+
+    const row_statistics_t row = {
+        {
+            median / divisor,
+            histogram->min / divisor,
+            histogram_percentile(histogram, 90) / divisor,
+            histogram_percentile(histogram, 99) / divisor,
+            histogram_percentile(histogram, 99.9) / divisor,
+            histogram->max / divisor
+        },
+        histogram_count_above(histogram, HISTOGRAM_OUTLIER_FACTOR * median),
+        median_low / divisor,
+        median_high / divisor
+    };
+
+    if (report->format == REPORT_CSV) {
+        print_csv_row(report, &row, counters, num_runs, num_bytes);
+    } else {
+        print_json_row(report, &row, counters, num_runs, num_bytes);
+    }
+
+    report->num_rows++;
+}
+
+// ---------------------------------------------------------------------
+
+void report_end(report_t* report) {
+    if (report->format == REPORT_JSON) {
+        fputs("\n  ]\n}\n", stdout);
+    }
+
+    fflush(stdout);
+}
+
 // ---------------------------------------------------------------------
 
 int compare_doubles(const void *aPtr, const void *bPtr) {
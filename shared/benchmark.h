@@ -57,6 +57,235 @@
     #define ALIGN(n)
 #endif
 
+// ---------------------------------------------------------------------
+// Histograms
+// ---------------------------------------------------------------------
+
+// Values below 2^HISTOGRAM_SUB_BUCKET_BITS have a bucket each. Above, every
+// power of two is split into 2^{HISTOGRAM_SUB_BUCKET_BITS - 1} buckets, so a
+// bucket is less than 1% wide relative to its values. Values from
+// 2^HISTOGRAM_MAX_EXPONENT on share the last bucket.
+#define HISTOGRAM_SUB_BUCKET_BITS   8
+#define HISTOGRAM_MAX_EXPONENT      40
+#define HISTOGRAM_NUM_BUCKETS \
+    ((1 << HISTOGRAM_SUB_BUCKET_BITS) \
+     + (HISTOGRAM_MAX_EXPONENT - HISTOGRAM_SUB_BUCKET_BITS) \
+       * (1 << (HISTOGRAM_SUB_BUCKET_BITS - 1)))
+
+// Samples above this multiple of the median count as outliers, e.g., from
+// interrupts or frequency changes.
+#define HISTOGRAM_OUTLIER_FACTOR    2
+
+/**
+ * Counts samples, e.g., cycles per run, in log-linear buckets, in the style
+ * of HdrHistogram. Recording is O(1) and needs no per-sample storage or
+ * sorting.
+ */
+typedef struct {
+    uint64_t counts[HISTOGRAM_NUM_BUCKETS];
+    uint64_t num_samples;
+    uint64_t min;
+    uint64_t max;
+} histogram_t;
+
+// ---------------------------------------------------------------------
+
+void histogram_reset(histogram_t* histogram);
+
+// ---------------------------------------------------------------------
+
+void histogram_record(histogram_t* histogram, const uint64_t value);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Returns the value below or at which the given percentage of the samples
+ * lies, up to the width of its bucket; 0 returns the minimum and 100 the
+ * maximum.
+ */
+uint64_t histogram_percentile(const histogram_t* histogram,
+                              const double percentage);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Returns the number of samples in buckets above the one of value.
+ */
+uint64_t histogram_count_above(const histogram_t* histogram,
+                               const uint64_t value);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Sets low and high to the distribution-free 95% confidence interval of the
+ * median, i.e., the samples of rank n/2 -/+ 0.98 sqrt(n), up to the width of
+ * their buckets.
+ */
+void histogram_median_interval(const histogram_t* histogram,
+                               uint64_t* low,
+                               uint64_t* high);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Prints the column names of histogram_print_row() after #Bytes, in the
+ * given unit, without the line break, so that further columns can follow.
+ */
+void histogram_print_header(const char* unit);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Prints num_bytes, the median, minimum, 90th, 99th, and 99.9th percentile,
+ * and the maximum divided by num_bytes, or undivided if num_bytes is 0, and
+ * the number of outliers, without the line break.
+ */
+void histogram_print_row(const histogram_t* histogram,
+                         const size_t num_bytes);
+
+// ---------------------------------------------------------------------
+// Performance counters
+// ---------------------------------------------------------------------
+
+typedef enum {
+    COUNTER_CORE_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_L1D_MISSES,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    NUM_COUNTERS
+} counter_t;
+
+/**
+ * Hardware counters of the calling thread in user space from
+ * perf_event_open(2). Unlike get_time(), which counts reference cycles,
+ * core cycles follow the actual clock under turbo and frequency scaling.
+ * Counters that the kernel or the CPU does not provide have the file
+ * descriptor -1.
+ */
+typedef struct {
+    int fds[NUM_COUNTERS];
+    double values[NUM_COUNTERS];
+} perf_counters_t;
+
+// ---------------------------------------------------------------------
+
+/**
+ * Opens the counters. Returns 0 if at least the core cycles can be counted,
+ * and -1 otherwise, e.g., in virtual machines without a PMU or with a too
+ * restrictive /proc/sys/kernel/perf_event_paranoid.
+ */
+int perf_counters_open(perf_counters_t* counters);
+
+// ---------------------------------------------------------------------
+
+void perf_counters_close(perf_counters_t* counters);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Resets and enables the counters.
+ */
+void perf_counters_start(perf_counters_t* counters);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Disables the counters and reads them into values, scaled up if the kernel
+ * had to multiplex them.
+ */
+void perf_counters_stop(perf_counters_t* counters);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Prints the column names of perf_counters_print_row(), per byte or per run,
+ * without the line break.
+ */
+void perf_counters_print_header(const int is_per_byte);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Prints the core cycles and instructions per run divided by num_bytes, or
+ * undivided if num_bytes is 0, the instructions per cycle, and the L1D,
+ * last-level cache, and branch misses per run, without the line break.
+ * Unavailable counters are printed as -.
+ */
+void perf_counters_print_row(const perf_counters_t* counters,
+                             const size_t num_runs,
+                             const size_t num_bytes);
+
+// ---------------------------------------------------------------------
+// Reports
+// ---------------------------------------------------------------------
+
+typedef enum {
+    REPORT_TEXT,
+    REPORT_JSON,
+    REPORT_CSV
+} report_format_t;
+
+/**
+ * Writes the rows of a benchmark to stdout: as the text of
+ * histogram_print_row() that plot.py reads, or as JSON or CSV that also
+ * hold the CPU model and flags, the build type, the git revision, and the
+ * confidence interval of the median for scripts/compare.py.
+ */
+typedef struct {
+    report_format_t format;
+    const char* benchmark;
+    const char* isa;
+    const char* mode;
+    int is_per_byte;
+    int has_counters;
+    size_t num_rows;
+} report_t;
+
+// ---------------------------------------------------------------------
+
+/**
+ * Sets format and returns 0 if option is --text, --json, or --csv, and
+ * returns -1 otherwise.
+ */
+int report_parse_format(const char* option, report_format_t* format);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Prints the header of the report. isa may be NULL.
+ */
+void report_begin(report_t* report,
+                  const report_format_t format,
+                  const char* benchmark,
+                  const char* isa,
+                  const int has_counters);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Starts the rows of a mode, in cycles per byte or in cycles per run.
+ */
+void report_begin_mode(report_t* report,
+                       const char* mode,
+                       const int is_per_byte);
+
+// ---------------------------------------------------------------------
+
+/**
+ * Prints the statistics of num_runs runs on num_bytes bytes each. counters
+ * are ignored unless the report has them.
+ */
+void report_row(report_t* report,
+                const histogram_t* histogram,
+                const perf_counters_t* counters,
+                const size_t num_runs,
+                const size_t num_bytes);
+
+// ---------------------------------------------------------------------
+
+void report_end(report_t* report);
+
 // ---------------------------------------------------------------------
 
 int compare_doubles(const void *aPtr, const void *bPtr);
@@ -40,6 +40,7 @@
 
 extern "C" {
     #include "deoxysbc.h"
+    #include "soft-ni.h"
     #include "utils-opt.h"
 }
 
@@ -53,6 +54,15 @@ enum DeoxysBCVariant {
     DEOXYS_BC_128_384
 };
 
+typedef void (*sixteen_fn)(const deoxys_bc_128_384_base_t* base,
+                           const size_t tweak_counter,
+                           const __m128i tweak_blocks[16],
+                           __m128i states[16]);
+
+typedef void (*sixteen_one_fn)(const deoxys_bc_128_384_base_t* base,
+                               const size_t tweak_counter,
+                               __m128i states[16]);
+
 // ---------------------------------------------------------------------
 // Static functions
 // ---------------------------------------------------------------------
@@ -158,10 +168,12 @@ static void test_deoxysbc_128_384_ecb_encryption(const std::string& json_path) {
     size_t tweak_counter = context.get_tweak_counter();
 
     deoxys_bc_128_384_ctx_t ctx;
+    deoxys_bc_128_384_base_t base;
     deoxys_bc_128_384_setup_key(&ctx, key);
 
     size_t num_bytes = context.get_num_plaintext_bytes();
     deoxys_bc_128_384_setup_base_counters(&ctx,
+                                          &base,
                                           context.get_tweak_domain(),
                                           tweak_counter);
 
@@ -169,10 +181,10 @@ static void test_deoxysbc_128_384_ecb_encryption(const std::string& json_path) {
         load_eight(states, plaintext_position);
         avx_load_four(tweaks, tweak_position);
 
-        deoxys_bc_128_384_encrypt_eight(&ctx,
-                                       tweak_counter,
-                                       tweaks,
-                                       states);
+        deoxys_bc_128_384_encrypt_eight(&base,
+                                        tweak_counter,
+                                        tweaks,
+                                        states);
         store_eight(ciphertext_position, states);
 
         num_bytes -= NUM_BYTES_PER_CHUNK;
@@ -186,10 +198,10 @@ static void test_deoxysbc_128_384_ecb_encryption(const std::string& json_path) {
         load_four(states, plaintext_position);
         avx_load_two(tweaks, tweak_position);
 
-        deoxys_bc_128_384_encrypt_four(&ctx,
-                                        tweak_counter,
-                                        tweaks,
-                                        states);
+        deoxys_bc_128_384_encrypt_four(&base,
+                                       tweak_counter,
+                                       tweaks,
+                                       states);
         store_four(ciphertext_position, states);
 
         num_bytes -= 4 * DEOXYS_BC_BLOCKLEN;
@@ -248,9 +260,11 @@ static void test_deoxysbc_128_384_ecb_decryption(const std::string& json_path) {
     size_t tweak_counter = context.get_tweak_counter();
 
     deoxys_bc_128_384_ctx_t ctx;
+    deoxys_bc_128_384_base_t base;
     deoxys_bc_128_384_setup_key(&ctx, key);
     deoxys_bc_128_384_setup_decryption_key(&ctx);
     deoxys_bc_128_384_setup_base_counters(&ctx,
+                                          &base,
                                           context.get_tweak_domain(),
                                           tweak_counter);
 
@@ -260,10 +274,10 @@ static void test_deoxysbc_128_384_ecb_decryption(const std::string& json_path) {
         load_eight(states, ciphertext_position);
         avx_load_four(tweaks, tweak_position);
 
-        deoxys_bc_128_384_decrypt_eight(&ctx,
-                                       tweak_counter,
-                                       tweaks,
-                                       states);
+        deoxys_bc_128_384_decrypt_eight(&base,
+                                        tweak_counter,
+                                        tweaks,
+                                        states);
         store_eight(plaintext_position, states);
 
         num_bytes -= NUM_BYTES_PER_CHUNK;
@@ -277,10 +291,10 @@ static void test_deoxysbc_128_384_ecb_decryption(const std::string& json_path) {
         load_four(states, ciphertext_position);
         avx_load_two(tweaks, tweak_position);
 
-        deoxys_bc_128_384_decrypt_four(&ctx,
-                                        tweak_counter,
-                                        tweaks,
-                                        states);
+        deoxys_bc_128_384_decrypt_four(&base,
+                                       tweak_counter,
+                                       tweaks,
+                                       states);
         store_four(plaintext_position, states);
 
         num_bytes -= 4 * DEOXYS_BC_BLOCKLEN;
@@ -317,6 +331,580 @@ static void test_deoxysbc_128_384_ecb_decryption(const std::string& json_path) {
     free_if_used(plaintext_array, context.get_num_plaintext_bytes());
 }
 
+static void test_deoxysbc_128_384_sixteen_encryption(
+    const std::string& json_path,
+    const sixteen_fn encrypt_sixteen) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    DeoxysBCOptTestCaseContext context =
+        json_parser.create_deoxys_bc_opt_test_case(json_data);
+
+    const size_t NUM_BLOCKS_PER_CHUNK = 16;
+    const size_t NUM_BYTES_PER_CHUNK = NUM_BLOCKS_PER_CHUNK * DEOXYS_BC_BLOCKLEN;
+
+    __m128i key = load(context.key);
+    __m128i tweaks[NUM_BLOCKS_PER_CHUNK];
+    __m128i states[NUM_BLOCKS_PER_CHUNK];
+
+    uint8_t* ciphertext_array = (uint8_t*)malloc(context.get_num_ciphertext_bytes());
+    uint8_t* plaintext_position = context.plaintext;
+    uint8_t* ciphertext_position = ciphertext_array;
+    uint8_t* tweak_position = context.tweak;
+    size_t tweak_counter = context.get_tweak_counter();
+
+    deoxys_bc_128_384_ctx_t ctx;
+    deoxys_bc_128_384_base_t base;
+    deoxys_bc_128_384_setup_key(&ctx, key);
+    deoxys_bc_128_384_setup_base_counters(&ctx,
+                                          &base,
+                                          context.get_tweak_domain(),
+                                          tweak_counter);
+
+    size_t num_bytes = context.get_num_plaintext_bytes();
+
+    while (num_bytes >= NUM_BYTES_PER_CHUNK) {
+        memcpy(states, plaintext_position, NUM_BYTES_PER_CHUNK);
+        memcpy(tweaks, tweak_position, NUM_BYTES_PER_CHUNK);
+
+        encrypt_sixteen(&base, tweak_counter, tweaks, states);
+        memcpy(ciphertext_position, states, NUM_BYTES_PER_CHUNK);
+
+        num_bytes -= NUM_BYTES_PER_CHUNK;
+        ciphertext_position += NUM_BYTES_PER_CHUNK;
+        plaintext_position += NUM_BYTES_PER_CHUNK;
+        tweak_position += NUM_BYTES_PER_CHUNK;
+        tweak_counter += NUM_BLOCKS_PER_CHUNK;
+    }
+
+    while (num_bytes >= DEOXYS_BC_BLOCKLEN) {
+        deoxys_bc_128_384_encrypt(&ctx,
+                                  context.get_tweak_domain(),
+                                  tweak_counter,
+                                  loadu(tweak_position),
+                                  loadu(plaintext_position),
+                                  states);
+        storeu(ciphertext_position, states[0]);
+
+        num_bytes -= DEOXYS_BC_BLOCKLEN;
+        ciphertext_position += DEOXYS_BC_BLOCKLEN;
+        plaintext_position += DEOXYS_BC_BLOCKLEN;
+        tweak_position += DEOXYS_BC_BLOCKLEN;
+        tweak_counter += 1;
+    }
+
+    assert_arrays_equal(context.ciphertext,
+                        ciphertext_array,
+                        context.get_num_ciphertext_bytes());
+
+    free_if_used(ciphertext_array, context.get_num_ciphertext_bytes());
+}
+
+// ---------------------------------------------------------------------
+
+static void test_deoxysbc_128_384_sixteen_decryption(
+    const std::string& json_path,
+    const sixteen_fn decrypt_sixteen) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    DeoxysBCOptTestCaseContext context =
+        json_parser.create_deoxys_bc_opt_test_case(json_data);
+
+    const size_t NUM_BLOCKS_PER_CHUNK = 16;
+    const size_t NUM_BYTES_PER_CHUNK = NUM_BLOCKS_PER_CHUNK * DEOXYS_BC_BLOCKLEN;
+
+    __m128i key = load(context.key);
+    __m128i tweaks[NUM_BLOCKS_PER_CHUNK];
+    __m128i states[NUM_BLOCKS_PER_CHUNK];
+
+    uint8_t* plaintext_array = (uint8_t*)malloc(context.get_num_plaintext_bytes());
+    uint8_t* ciphertext_position = context.ciphertext;
+    uint8_t* plaintext_position = plaintext_array;
+    uint8_t* tweak_position = context.tweak;
+    size_t tweak_counter = context.get_tweak_counter();
+
+    deoxys_bc_128_384_ctx_t ctx;
+    deoxys_bc_128_384_base_t base;
+    deoxys_bc_128_384_setup_key(&ctx, key);
+    deoxys_bc_128_384_setup_decryption_key(&ctx);
+    deoxys_bc_128_384_setup_base_counters(&ctx,
+                                          &base,
+                                          context.get_tweak_domain(),
+                                          tweak_counter);
+
+    size_t num_bytes = context.get_num_plaintext_bytes();
+
+    while (num_bytes >= NUM_BYTES_PER_CHUNK) {
+        memcpy(states, ciphertext_position, NUM_BYTES_PER_CHUNK);
+        memcpy(tweaks, tweak_position, NUM_BYTES_PER_CHUNK);
+
+        decrypt_sixteen(&base, tweak_counter, tweaks, states);
+        memcpy(plaintext_position, states, NUM_BYTES_PER_CHUNK);
+
+        num_bytes -= NUM_BYTES_PER_CHUNK;
+        ciphertext_position += NUM_BYTES_PER_CHUNK;
+        plaintext_position += NUM_BYTES_PER_CHUNK;
+        tweak_position += NUM_BYTES_PER_CHUNK;
+        tweak_counter += NUM_BLOCKS_PER_CHUNK;
+    }
+
+    while (num_bytes >= DEOXYS_BC_BLOCKLEN) {
+        deoxys_bc_128_384_decrypt(&ctx,
+                                  context.get_tweak_domain(),
+                                  tweak_counter,
+                                  loadu(tweak_position),
+                                  loadu(ciphertext_position),
+                                  states);
+        storeu(plaintext_position, states[0]);
+
+        num_bytes -= DEOXYS_BC_BLOCKLEN;
+        ciphertext_position += DEOXYS_BC_BLOCKLEN;
+        plaintext_position += DEOXYS_BC_BLOCKLEN;
+        tweak_position += DEOXYS_BC_BLOCKLEN;
+        tweak_counter += 1;
+    }
+
+    assert_arrays_equal(context.plaintext,
+                        plaintext_array,
+                        context.get_num_plaintext_bytes());
+
+    free_if_used(plaintext_array, context.get_num_plaintext_bytes());
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Compares the sixteen-block middle-layer kernel, which encrypts the same
+ * block under 16 consecutive counters and a fixed tweak block, with the
+ * single-block cipher.
+ */
+static void test_deoxysbc_128_384_sixteen_one_encryption(
+    const std::string& json_path,
+    const sixteen_one_fn encrypt_sixteen_one) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    DeoxysBCOptTestCaseContext context =
+        json_parser.create_deoxys_bc_opt_test_case(json_data);
+
+    const size_t NUM_BLOCKS_PER_CHUNK = 16;
+
+    const __m128i key = loadu(context.key);
+    const __m128i tweak = loadu(context.tweak);
+    const __m128i plaintext = loadu(context.plaintext);
+    const uint8_t tweak_domain = context.get_tweak_domain();
+    const size_t tweak_counter = context.get_tweak_counter();
+
+    __m128i states[NUM_BLOCKS_PER_CHUNK];
+    __m128i expected;
+
+    deoxys_bc_128_384_ctx_t ctx;
+    deoxys_bc_128_384_base_t counter_base;
+    deoxys_bc_128_384_base_t base;
+    deoxys_bc_128_384_setup_key(&ctx, key);
+    deoxys_bc_128_384_setup_base_counters(&ctx,
+                                          &counter_base,
+                                          tweak_domain,
+                                          tweak_counter);
+    deoxys_bc_128_384_setup_middle_base(&base, &counter_base, tweak);
+
+    for (size_t i = 0; i < NUM_BLOCKS_PER_CHUNK; ++i) {
+        states[i] = plaintext;
+    }
+
+    encrypt_sixteen_one(&base, tweak_counter, states);
+
+    for (size_t i = 0; i < NUM_BLOCKS_PER_CHUNK; ++i) {
+        deoxys_bc_128_384_encrypt(&ctx,
+                                  tweak_domain,
+                                  tweak_counter + i,
+                                  tweak,
+                                  plaintext,
+                                  &expected);
+        assert_equal(expected, states[i]);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Checks the batch functions against single-block calls for all batch sizes,
+ * with a different domain, counter, and tweak block per lane.
+ */
+static void test_deoxysbc_128_384_batch(const std::string& json_path) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    DeoxysBCOptTestCaseContext context =
+        json_parser.create_deoxys_bc_opt_test_case(json_data);
+
+    const __m128i key = loadu(context.key);
+    const __m128i tweak = loadu(context.tweak);
+    const __m128i plaintext = loadu(context.plaintext);
+    const uint8_t tweak_domain = context.get_tweak_domain();
+    const size_t tweak_counter = context.get_tweak_counter();
+
+    uint8_t domains[DEOXYS_BC_MAX_BATCH_SIZE];
+    size_t counters[DEOXYS_BC_MAX_BATCH_SIZE];
+    __m128i tweaks[DEOXYS_BC_MAX_BATCH_SIZE];
+    __m128i plaintexts[DEOXYS_BC_MAX_BATCH_SIZE];
+    __m128i states[DEOXYS_BC_MAX_BATCH_SIZE];
+    __m128i expected;
+
+    deoxys_bc_128_384_ctx_t ctx;
+    deoxys_bc_128_384_setup_key(&ctx, key);
+    deoxys_bc_128_384_setup_decryption_key(&ctx);
+
+    for (size_t j = 0; j < DEOXYS_BC_MAX_BATCH_SIZE; ++j) {
+        domains[j] = (tweak_domain + j) & 0x0F;
+        counters[j] = tweak_counter + 301 * j;
+        tweaks[j] = vxor(tweak, set64((uint64_t)j, (uint64_t)0));
+        plaintexts[j] = vxor(plaintext, set64((uint64_t)0, (uint64_t)j));
+    }
+
+    for (size_t n = 1; n <= DEOXYS_BC_MAX_BATCH_SIZE; ++n) {
+        memcpy(states, plaintexts, n * sizeof(__m128i));
+        deoxys_bc_128_384_encrypt_batch(&ctx,
+                                        n,
+                                        domains,
+                                        counters,
+                                        tweaks,
+                                        states);
+
+        for (size_t j = 0; j < n; ++j) {
+            deoxys_bc_128_384_encrypt(&ctx,
+                                      domains[j],
+                                      counters[j],
+                                      tweaks[j],
+                                      plaintexts[j],
+                                      &expected);
+            assert_equal(expected, states[j]);
+        }
+
+        deoxys_bc_128_384_decrypt_batch(&ctx,
+                                        n,
+                                        domains,
+                                        counters,
+                                        tweaks,
+                                        states);
+
+        for (size_t j = 0; j < n; ++j) {
+            assert_equal(plaintexts[j], states[j]);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Encrypts and decrypts the test vector with the two- or four-block tail
+ * kernels, which must agree with the vector and with each other.
+ */
+static void test_deoxysbc_128_384_narrow(const std::string& json_path,
+                                         const size_t num_lanes) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    DeoxysBCOptTestCaseContext context =
+        json_parser.create_deoxys_bc_opt_test_case(json_data);
+
+    const size_t num_bytes_per_chunk = num_lanes * DEOXYS_BC_BLOCKLEN;
+    const size_t num_bytes = context.get_num_plaintext_bytes();
+    ASSERT_EQ(0U, num_bytes % num_bytes_per_chunk);
+
+    __m128i key = load(context.key);
+    __m128i tweaks[4];
+    __m128i states[4];
+
+    uint8_t* ciphertext_array = (uint8_t*)malloc(num_bytes);
+    uint8_t* plaintext_array = (uint8_t*)malloc(num_bytes);
+    size_t tweak_counter = context.get_tweak_counter();
+
+    deoxys_bc_128_384_ctx_t ctx;
+    deoxys_bc_128_384_base_t base;
+    deoxys_bc_128_384_setup_key(&ctx, key);
+    deoxys_bc_128_384_setup_decryption_key(&ctx);
+    deoxys_bc_128_384_setup_base_counters(&ctx,
+                                          &base,
+                                          context.get_tweak_domain(),
+                                          tweak_counter);
+
+    for (size_t i = 0; i < num_bytes; i += num_bytes_per_chunk) {
+        const size_t counter = tweak_counter + i / DEOXYS_BC_BLOCKLEN;
+
+        memcpy(states, context.plaintext + i, num_bytes_per_chunk);
+        memcpy(tweaks, context.tweak + i, num_bytes_per_chunk);
+
+        if (num_lanes == 2) {
+            deoxys_bc_128_384_encrypt_two(&base, counter, tweaks, states);
+        } else {
+            deoxys_bc_128_384_encrypt_four_four(&base,
+                                                counter,
+                                                tweaks,
+                                                states);
+        }
+
+        memcpy(ciphertext_array + i, states, num_bytes_per_chunk);
+
+        if (num_lanes == 2) {
+            deoxys_bc_128_384_decrypt_two(&base, counter, tweaks, states);
+        } else {
+            deoxys_bc_128_384_decrypt_four_four(&base,
+                                                counter,
+                                                tweaks,
+                                                states);
+        }
+
+        memcpy(plaintext_array + i, states, num_bytes_per_chunk);
+    }
+
+    assert_arrays_equal(context.ciphertext, ciphertext_array, num_bytes);
+    assert_arrays_equal(context.plaintext, plaintext_array, num_bytes);
+
+    free(ciphertext_array);
+    free(plaintext_array);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Encrypts and decrypts the test vector with the eight-, four-, and
+ * single-block kernels, in that order of preference, so that vectors of 257
+ * blocks reach all three.
+ */
+static void test_deoxysbc_128_128_ecb(const std::string& json_path) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    DeoxysBCTestCaseContext context =
+        json_parser.create_deoxys_bc_test_case(json_data);
+
+    const size_t num_bytes = context.get_num_plaintext_bytes();
+    const size_t num_blocks = num_bytes / DEOXYS_BC_BLOCKLEN;
+    __m128i states[8];
+
+    uint8_t* ciphertext_array = (uint8_t*)malloc(num_bytes);
+    uint8_t* plaintext_array = (uint8_t*)malloc(num_bytes);
+
+    deoxys_bc_128_128_ctx_t ctx;
+    deoxys_bc_128_128_setup_key(&ctx, loadu(context.key));
+    deoxys_bc_128_128_setup_decryption_key(&ctx);
+
+    for (size_t i = 0; i < num_blocks; ) {
+        const size_t offset = i * DEOXYS_BC_BLOCKLEN;
+        const size_t num_lanes = (num_blocks - i >= 8) ? 8
+            : (num_blocks - i >= 4) ? 4 : 1;
+        const size_t num_chunk_bytes = num_lanes * DEOXYS_BC_BLOCKLEN;
+
+        memcpy(states, context.plaintext + offset, num_chunk_bytes);
+
+        if (num_lanes == 8) {
+            deoxys_bc_128_128_encrypt_eight(&ctx, states);
+        } else if (num_lanes == 4) {
+            deoxys_bc_128_128_encrypt_four(&ctx, states);
+        } else {
+            deoxys_bc_128_128_encrypt(&ctx, states[0], states);
+        }
+
+        memcpy(ciphertext_array + offset, states, num_chunk_bytes);
+
+        if (num_lanes == 8) {
+            deoxys_bc_128_128_decrypt_eight(&ctx, states);
+        } else if (num_lanes == 4) {
+            deoxys_bc_128_128_decrypt_four(&ctx, states);
+        } else {
+            deoxys_bc_128_128_decrypt(&ctx, states[0], states);
+        }
+
+        memcpy(plaintext_array + offset, states, num_chunk_bytes);
+        i += num_lanes;
+    }
+
+    assert_arrays_equal(context.ciphertext, ciphertext_array, num_bytes);
+    assert_arrays_equal(context.plaintext, plaintext_array, num_bytes);
+
+    free(ciphertext_array);
+    free(plaintext_array);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * As test_deoxysbc_128_128_ecb(), with one tweak per block.
+ */
+static void test_deoxysbc_128_256_ecb(const std::string& json_path) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    DeoxysBCTestCaseContext context =
+        json_parser.create_deoxys_bc_test_case(json_data);
+
+    const size_t num_bytes = context.get_num_plaintext_bytes();
+    const size_t num_blocks = num_bytes / DEOXYS_BC_BLOCKLEN;
+    ASSERT_EQ(num_bytes, context.get_num_tweak_bytes());
+
+    __m128i tweaks[8];
+    __m128i states[8];
+
+    uint8_t* ciphertext_array = (uint8_t*)malloc(num_bytes);
+    uint8_t* plaintext_array = (uint8_t*)malloc(num_bytes);
+
+    deoxys_bc_128_256_ctx_t ctx;
+    deoxys_bc_128_256_setup_key(&ctx, loadu(context.key));
+    deoxys_bc_128_256_setup_decryption_key(&ctx);
+
+    for (size_t i = 0; i < num_blocks; ) {
+        const size_t offset = i * DEOXYS_BC_BLOCKLEN;
+        const size_t num_lanes = (num_blocks - i >= 8) ? 8
+            : (num_blocks - i >= 4) ? 4 : 1;
+        const size_t num_chunk_bytes = num_lanes * DEOXYS_BC_BLOCKLEN;
+
+        memcpy(states, context.plaintext + offset, num_chunk_bytes);
+        memcpy(tweaks, context.tweak + offset, num_chunk_bytes);
+
+        if (num_lanes == 8) {
+            deoxys_bc_128_256_encrypt_eight(&ctx, tweaks, states);
+        } else if (num_lanes == 4) {
+            deoxys_bc_128_256_encrypt_four(&ctx, tweaks, states);
+        } else {
+            deoxys_bc_128_256_encrypt(&ctx, tweaks[0], states[0], states);
+        }
+
+        memcpy(ciphertext_array + offset, states, num_chunk_bytes);
+
+        if (num_lanes == 8) {
+            deoxys_bc_128_256_decrypt_eight(&ctx, tweaks, states);
+        } else if (num_lanes == 4) {
+            deoxys_bc_128_256_decrypt_four(&ctx, tweaks, states);
+        } else {
+            deoxys_bc_128_256_decrypt(&ctx, tweaks[0], states[0], states);
+        }
+
+        memcpy(plaintext_array + offset, states, num_chunk_bytes);
+        i += num_lanes;
+    }
+
+    assert_arrays_equal(context.ciphertext, ciphertext_array, num_bytes);
+    assert_arrays_equal(context.plaintext, plaintext_array, num_bytes);
+
+    free(ciphertext_array);
+    free(plaintext_array);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Compares the constant-time software instructions of the SSSE3 variant with
+ * AES-NI and PCLMULQDQ on pseudo-random inputs.
+ */
+static void test_soft_ni(const size_t num_inputs) {
+    uint64_t seed = 0x0123456789abcdefULL;
+    __m128i values[2];
+
+    for (size_t i = 0; i < num_inputs; ++i) {
+        for (size_t j = 0; j < 2; ++j) {
+            // xorshift64
+            uint64_t words[2];
+
+            for (size_t k = 0; k < 2; ++k) {
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                words[k] = seed;
+            }
+
+            values[j] = set64(words[1], words[0]);
+        }
+
+        const __m128i x = values[0];
+        const __m128i y = values[1];
+
+        assert_equal(_mm_aesenc_si128(x, y), soft_ni_aesenc(x, y));
+        assert_equal(_mm_aesenclast_si128(x, y), soft_ni_aesenclast(x, y));
+        assert_equal(_mm_aesdec_si128(x, y), soft_ni_aesdec(x, y));
+        assert_equal(_mm_aesdeclast_si128(x, y), soft_ni_aesdeclast(x, y));
+        assert_equal(_mm_aesimc_si128(x), soft_ni_aesimc(x));
+        assert_equal(_mm_clmulepi64_si128(x, y, 0x00),
+                     soft_ni_clmul(x, y, 0x00));
+        assert_equal(_mm_clmulepi64_si128(x, y, 0x01),
+                     soft_ni_clmul(x, y, 0x01));
+        assert_equal(_mm_clmulepi64_si128(x, y, 0x10),
+                     soft_ni_clmul(x, y, 0x10));
+        assert_equal(_mm_clmulepi64_si128(x, y, 0x11),
+                     soft_ni_clmul(x, y, 0x11));
+    }
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Encrypts the blocks of the test case with the eight-block kernel, or with
+ * encrypt_sixteen if given, from the given counter on instead of that of the
+ * test case, and compares them with single-block calls. Counters beyond 32
+ * bits need messages of many GiB in ZCZ, but no memory here.
+ */
+static void test_deoxysbc_128_384_large_counter(
+    const std::string& json_path,
+    const size_t first_tweak_counter,
+    const sixteen_fn encrypt_sixteen) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    DeoxysBCOptTestCaseContext context =
+        json_parser.create_deoxys_bc_opt_test_case(json_data);
+
+    const size_t num_blocks_per_chunk = (encrypt_sixteen != NULL) ? 16 : 8;
+    const size_t num_blocks =
+        context.get_num_plaintext_bytes() / DEOXYS_BC_BLOCKLEN;
+    const uint8_t tweak_domain = context.get_tweak_domain();
+
+    __m128i key = loadu(context.key);
+    __m256i avx_tweaks[4];
+    __m128i tweaks[16];
+    __m128i states[16];
+    __m128i expected;
+
+    deoxys_bc_128_384_ctx_t ctx;
+    deoxys_bc_128_384_base_t base;
+    deoxys_bc_128_384_setup_key(&ctx, key);
+
+    for (size_t i = 0; i + num_blocks_per_chunk <= num_blocks;
+         i += num_blocks_per_chunk) {
+        const size_t tweak_counter = first_tweak_counter + i;
+        const uint8_t* plaintext_position =
+            context.plaintext + i * DEOXYS_BC_BLOCKLEN;
+        const uint8_t* tweak_position = context.tweak + i * DEOXYS_BC_BLOCKLEN;
+
+        // The kernels only add to the lowest counter byte.
+        if ((i == 0) || ((tweak_counter & 0xFF) == 0)) {
+            deoxys_bc_128_384_setup_base_counters(&ctx,
+                                                  &base,
+                                                  tweak_domain,
+                                                  tweak_counter);
+        }
+
+        memcpy(states, plaintext_position,
+               num_blocks_per_chunk * DEOXYS_BC_BLOCKLEN);
+
+        if (encrypt_sixteen != NULL) {
+            memcpy(tweaks, tweak_position, 16 * DEOXYS_BC_BLOCKLEN);
+            encrypt_sixteen(&base, tweak_counter, tweaks, states);
+        } else {
+            avx_load_four(avx_tweaks, tweak_position);
+            deoxys_bc_128_384_encrypt_eight(&base,
+                                            tweak_counter,
+                                            avx_tweaks,
+                                            states);
+        }
+
+        for (size_t j = 0; j < num_blocks_per_chunk; ++j) {
+            deoxys_bc_128_384_encrypt(&ctx,
+                                      tweak_domain,
+                                      tweak_counter + j,
+                                      loadu(tweak_position),
+                                      loadu(plaintext_position),
+                                      &expected);
+            assert_equal(expected, states[j]);
+
+            tweak_position += DEOXYS_BC_BLOCKLEN;
+            plaintext_position += DEOXYS_BC_BLOCKLEN;
+        }
+    }
+}
+
 // ---------------------------------------------------------------------
 // Single-block test cases
 // ---------------------------------------------------------------------
@@ -367,6 +955,219 @@ TEST(DeoxysBC_128_384, decrypt_256_blocks_zero_ctr) {
     );
 }
 
+// ---------------------------------------------------------------------
+// Sixteen-block test cases. They are skipped on CPUs without VAES and
+// AVX-512; run them under Intel SDE (e.g., sde64 -icx --) on such hosts.
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_sixteen_256_blocks_zero_ctr) {
+    if (!deoxys_bc_128_384_sixteen_supported()) {
+        GTEST_SKIP();
+    }
+
+    test_deoxysbc_128_384_sixteen_encryption(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json",
+        deoxys_bc_128_384_encrypt_sixteen
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, decrypt_sixteen_256_blocks_zero_ctr) {
+    if (!deoxys_bc_128_384_sixteen_supported()) {
+        GTEST_SKIP();
+    }
+
+    test_deoxysbc_128_384_sixteen_decryption(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json",
+        deoxys_bc_128_384_decrypt_sixteen
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_sixteen_one) {
+    if (!deoxys_bc_128_384_sixteen_supported()) {
+        GTEST_SKIP();
+    }
+
+    test_deoxysbc_128_384_sixteen_one_encryption(
+        "testdata/deoxysbc_128_384_encrypt_opt.json",
+        deoxys_bc_128_384_encrypt_sixteen_one
+    );
+}
+
+// ---------------------------------------------------------------------
+// Bitsliced sixteen-block test cases. They are skipped on CPUs without AVX2.
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_sixteen_bitsliced_256_blocks_zero_ctr) {
+    if (!deoxys_bc_128_384_bitsliced_supported()) {
+        GTEST_SKIP();
+    }
+
+    test_deoxysbc_128_384_sixteen_encryption(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json",
+        deoxys_bc_128_384_encrypt_sixteen_bitsliced
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, decrypt_sixteen_bitsliced_256_blocks_zero_ctr) {
+    if (!deoxys_bc_128_384_bitsliced_supported()) {
+        GTEST_SKIP();
+    }
+
+    test_deoxysbc_128_384_sixteen_decryption(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json",
+        deoxys_bc_128_384_decrypt_sixteen_bitsliced
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_sixteen_one_bitsliced) {
+    if (!deoxys_bc_128_384_bitsliced_supported()) {
+        GTEST_SKIP();
+    }
+
+    test_deoxysbc_128_384_sixteen_one_encryption(
+        "testdata/deoxysbc_128_384_encrypt_opt.json",
+        deoxys_bc_128_384_encrypt_sixteen_one_bitsliced
+    );
+}
+
+// ---------------------------------------------------------------------
+// Large counter test cases. The first one crosses 2^32 blocks.
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_eight_256_blocks_ctr_above_2_32) {
+    test_deoxysbc_128_384_large_counter(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json",
+        0xFFFFFF80ULL,
+        NULL
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_eight_256_blocks_max_ctr) {
+    test_deoxysbc_128_384_large_counter(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json",
+        0xFFFFFFFFFFFFFF00ULL,
+        NULL
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_sixteen_256_blocks_ctr_above_2_32) {
+    if (!deoxys_bc_128_384_sixteen_supported()) {
+        GTEST_SKIP();
+    }
+
+    test_deoxysbc_128_384_large_counter(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json",
+        0xFFFFFF80ULL,
+        deoxys_bc_128_384_encrypt_sixteen
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_sixteen_bitsliced_256_blocks_ctr_above_2_32) {
+    if (!deoxys_bc_128_384_bitsliced_supported()) {
+        GTEST_SKIP();
+    }
+
+    test_deoxysbc_128_384_large_counter(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json",
+        0xFFFFFF80ULL,
+        deoxys_bc_128_384_encrypt_sixteen_bitsliced
+    );
+}
+
+// ---------------------------------------------------------------------
+// Tail kernel test cases
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_decrypt_two_256_blocks_zero_ctr) {
+    test_deoxysbc_128_384_narrow(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json", 2
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_decrypt_four_four_256_blocks_zero_ctr) {
+    test_deoxysbc_128_384_narrow(
+        "testdata/deoxysbc_128_384_encrypt_256_blocks_zero_ctr_opt.json", 4
+    );
+}
+
+// ---------------------------------------------------------------------
+// Batch test cases
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_384, encrypt_decrypt_batch) {
+    test_deoxysbc_128_384_batch("testdata/deoxysbc_128_384_encrypt_opt.json");
+}
+
+// ---------------------------------------------------------------------
+// Deoxys-BC-128-128 and Deoxys-BC-128-256 test cases
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_128, encrypt_decrypt) {
+    test_deoxysbc_128_128_ecb("testdata/deoxysbc_128_128_encrypt.json");
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_128, encrypt_decrypt_four_blocks) {
+    test_deoxysbc_128_128_ecb(
+        "testdata/deoxysbc_128_128_encrypt_4_blocks.json"
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_128, encrypt_decrypt_257_blocks) {
+    test_deoxysbc_128_128_ecb(
+        "testdata/deoxysbc_128_128_encrypt_257_blocks.json"
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_256, encrypt_decrypt) {
+    test_deoxysbc_128_256_ecb("testdata/deoxysbc_128_256_encrypt.json");
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_256, encrypt_decrypt_four_blocks) {
+    test_deoxysbc_128_256_ecb(
+        "testdata/deoxysbc_128_256_encrypt_4_blocks.json"
+    );
+}
+
+// ---------------------------------------------------------------------
+
+TEST(DeoxysBC_128_256, encrypt_decrypt_257_blocks) {
+    test_deoxysbc_128_256_ecb(
+        "testdata/deoxysbc_128_256_encrypt_257_blocks.json"
+    );
+}
+
+// ---------------------------------------------------------------------
+// Software AES-NI test cases
+// ---------------------------------------------------------------------
+
+TEST(SoftNI, matches_aes_ni_and_pclmulqdq) {
+    test_soft_ni(4096);
+}
+
 // ---------------------------------------------------------------------
 
 int main(int argc, char** argv) {
@@ -304,6 +304,75 @@ static void test_gf_times_four_opt_multi(const std::string& json_path) {
 
 // ---------------------------------------------------------------------
 
+static void load_blocks(__m128i* blocks,
+                        const GFDoublingTestCaseContext& context,
+                        const size_t num_blocks) {
+    EXPECT_EQ(num_blocks * BLOCKLEN, context.get_num_input_bytes());
+
+    for (size_t i = 0; i < num_blocks; ++i) {
+        blocks[i] = loadu((context.input + i * BLOCKLEN));
+    }
+}
+
+// ---------------------------------------------------------------------
+
+static void test_gf_sixteen_opt(const std::string& json_path,
+                                __m128i (*hash_sixteen)(__m128i, __m128i*)) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    GFDoublingTestCaseContext context = 
+        json_parser.create_gf_doubling_test_case(json_data);
+
+    __m128i blocks[16];
+    load_blocks(blocks, context, 16);
+
+    uint8_t actual_hash[BLOCKLEN];
+    storeu(actual_hash, hash_sixteen(vzero, blocks));
+    assert_arrays_equal(context.output, actual_hash, BLOCKLEN);
+}
+
+// ---------------------------------------------------------------------
+
+static void test_gf_double_and_times_four_opt(const size_t num_blocks) {
+    JSONParser json_parser;
+    GFDoublingTestCaseContext double_context =
+        json_parser.create_gf_doubling_test_case(
+            json_parser.parse("testdata/gf_doubling_16_blocks.json"));
+    GFDoublingTestCaseContext times_four_context =
+        json_parser.create_gf_doubling_test_case(
+            json_parser.parse("testdata/gf_times_four_16_blocks.json"));
+
+    __m128i x[16];
+    __m128i y[16];
+    load_blocks(x, double_context, 16);
+    load_blocks(y, times_four_context, 16);
+
+    __m128i hash_double = vzero;
+    __m128i hash_times_four = vzero;
+
+    if (num_blocks == 16) {
+        gf_2_128_double_and_times_four_sixteen(&hash_double,
+                                               &hash_times_four,
+                                               x,
+                                               y);
+    } else {
+        for (size_t i = 0; i < 16; i += 8) {
+            gf_2_128_double_and_times_four_eight(&hash_double,
+                                                 &hash_times_four,
+                                                 (x + i),
+                                                 (y + i));
+        }
+    }
+
+    uint8_t actual_hash[BLOCKLEN];
+    storeu(actual_hash, hash_double);
+    assert_arrays_equal(double_context.output, actual_hash, BLOCKLEN);
+    storeu(actual_hash, hash_times_four);
+    assert_arrays_equal(times_four_context.output, actual_hash, BLOCKLEN);
+}
+
+// ---------------------------------------------------------------------
+
 // ---------------------------------------------------------------------
 // GF Doubling test cases
 // ---------------------------------------------------------------------
@@ -420,6 +489,131 @@ TEST(GF_TIMES_FOUR, opt_16_blocks_multi) {
     test_gf_times_four_opt_multi("testdata/gf_times_four_16_blocks.json");
 }
 
+// ---------------------------------------------------------------------
+// GF power multiplication test cases
+// ---------------------------------------------------------------------
+
+/**
+ * Hashes the input in two halves, as two threads would, and combines them
+ * with gf_2_128_times_two_power() or gf_2_128_times_four_power().
+ */
+static void test_gf_power_opt_split(const std::string& json_path,
+                                    const bool times_four) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+
+    GFDoublingTestCaseContext context =
+        json_parser.create_gf_doubling_test_case(json_data);
+
+    const size_t num_blocks = context.get_num_input_bytes() / BLOCKLEN;
+    const size_t num_first_blocks = num_blocks / 2;
+    const size_t num_second_blocks = num_blocks - num_first_blocks;
+
+    ASSERT_LE(1U, num_first_blocks);
+
+    uint8_t first_hash[BLOCKLEN];
+    uint8_t second_hash[BLOCKLEN];
+    uint8_t actual_hash[BLOCKLEN];
+
+    if (times_four) {
+        gf_times_four_opt(first_hash,
+                          context.input,
+                          num_first_blocks * BLOCKLEN);
+        gf_times_four_opt(second_hash,
+                          context.input + num_first_blocks * BLOCKLEN,
+                          num_second_blocks * BLOCKLEN);
+    } else {
+        gf_double_opt(first_hash,
+                      context.input,
+                      num_first_blocks * BLOCKLEN);
+        gf_double_opt(second_hash,
+                      context.input + num_first_blocks * BLOCKLEN,
+                      num_second_blocks * BLOCKLEN);
+    }
+
+    __m128i hash = loadu(first_hash);
+
+    if (times_four) {
+        hash = gf_2_128_times_four_power(hash, num_second_blocks);
+    } else {
+        hash = gf_2_128_times_two_power(hash, num_second_blocks);
+    }
+
+    storeu(actual_hash, vxor(hash, loadu(second_hash)));
+    assert_arrays_equal(context.output, actual_hash, BLOCKLEN);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(GF_POWER, opt_double_16_blocks_split) {
+    test_gf_power_opt_split("testdata/gf_doubling_16_blocks.json", false);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(GF_POWER, opt_times_four_9_blocks_split) {
+    test_gf_power_opt_split("testdata/gf_times_four_9_blocks.json", true);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(GF_POWER, opt_matches_repeated_doubling) {
+    const size_t exponents[] = { 0, 1, 2, 7, 63, 64, 65, 127, 128, 129, 1000 };
+    const __m128i x = set32(0x80000000, 0x12345678, 0x9ABCDEF0, 0x0F1E2D3C);
+
+    for (size_t exponent : exponents) {
+        __m128i expected = x;
+        __m128i expected_four = x;
+        __m128i tmp;
+
+        for (size_t i = 0; i < exponent; ++i) {
+            gf_2_128_double(expected, expected, tmp);
+            gf_2_128_times_four(expected_four, expected_four, tmp);
+        }
+
+        uint8_t expected_bytes[BLOCKLEN];
+        uint8_t actual_bytes[BLOCKLEN];
+
+        storeu(expected_bytes, expected);
+        storeu(actual_bytes, gf_2_128_times_two_power(x, exponent));
+        assert_arrays_equal(expected_bytes, actual_bytes, BLOCKLEN);
+
+        storeu(expected_bytes, expected_four);
+        storeu(actual_bytes, gf_2_128_times_four_power(x, exponent));
+        assert_arrays_equal(expected_bytes, actual_bytes, BLOCKLEN);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+// ---------------------------------------------------------------------
+// Test sixteen blocks per call, and both hashes folded together
+// ---------------------------------------------------------------------
+
+TEST(GF_DOUBLING, opt_16_blocks_sixteen) {
+    test_gf_sixteen_opt("testdata/gf_doubling_16_blocks.json",
+                        gf_2_128_double_sixteen);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(GF_TIMES_FOUR, opt_16_blocks_sixteen) {
+    test_gf_sixteen_opt("testdata/gf_times_four_16_blocks.json",
+                        gf_2_128_times_four_sixteen);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(GF_DOUBLE_AND_TIMES_FOUR, opt_16_blocks_eight) {
+    test_gf_double_and_times_four_opt(8);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(GF_DOUBLE_AND_TIMES_FOUR, opt_16_blocks_sixteen) {
+    test_gf_double_and_times_four_opt(16);
+}
+
 // ---------------------------------------------------------------------
 
 int main(int argc, char** argv) {
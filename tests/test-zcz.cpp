@@ -32,7 +32,9 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <thread>
 #include <vector>
 
 extern "C" {
@@ -303,11 +305,9 @@ TEST(ZCZ, encrypt_512_blocks) {
 
 // ---------------------------------------------------------------------
 
-#ifndef NI_ENABLED  // Our optimized version works only for at most 512 blocks
 TEST(ZCZ, encrypt_1024_blocks) {
     run_zcz_encryption_test("testdata/zcz_encrypt_1024_blocks.json");
 }
-#endif
 
 // ---------------------------------------------------------------------
 // Decryption test cases with the non-basic version
@@ -373,10 +373,735 @@ TEST(ZCZ, decrypt_512_blocks) {
 
 // ---------------------------------------------------------------------
 
-#ifndef NI_ENABLED  // Our optimized version works only for at most 512 blocks
 TEST(ZCZ, decrypt_1024_blocks) {
     run_zcz_decryption_test("testdata/zcz_decrypt_1024_blocks.json");
 }
+
+// ---------------------------------------------------------------------
+// Large-message test cases
+// ---------------------------------------------------------------------
+
+/**
+ * Fills the buffer with a xorshift64 stream, so that large test vectors need
+ * not store their plaintexts.
+ */
+static void fill_large_message(uint8_t* buffer, const size_t num_bytes) {
+    uint64_t state = 0x0123456789ABCDEFULL;
+
+    for (size_t i = 0; i < num_bytes; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        buffer[i] = (uint8_t)state;
+    }
+}
+
+// ---------------------------------------------------------------------
+
+#define FNV1A64_OFFSET_BASIS    0xCBF29CE484222325ULL
+
+/**
+ * Continues an FNV-1a-64 digest, starting at FNV1A64_OFFSET_BASIS, with the
+ * given bytes, so that streamed outputs can be hashed piece by piece.
+ */
+static uint64_t update_fnv1a64(uint64_t digest,
+                               const uint8_t* buffer,
+                               const size_t num_bytes) {
+    for (size_t i = 0; i < num_bytes; ++i) {
+        digest ^= buffer[i];
+        digest *= 0x100000001B3ULL;
+    }
+
+    return digest;
+}
+
+// ---------------------------------------------------------------------
+
+static std::string format_fnv1a64(const uint64_t digest) {
+    char hex_string[17];
+    snprintf(hex_string,
+             sizeof(hex_string),
+             "%016llx",
+             (unsigned long long)digest);
+    return std::string(hex_string);
+}
+
+// ---------------------------------------------------------------------
+
+static std::string to_fnv1a64_digest(const uint8_t* buffer,
+                                     const size_t num_bytes) {
+    return format_fnv1a64(
+        update_fnv1a64(FNV1A64_OFFSET_BASIS, buffer, num_bytes));
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * The test vectors of large messages store only the FNV-1a-64 digests of the
+ * plaintext from fill_large_message() and of its ciphertext. Encrypts and
+ * decrypts in place, so that only one copy of the message is in memory.
+ */
+static void run_zcz_large_test(const std::string& json_path) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+    const size_t num_bytes = json_data["num_message_bytes"].asUInt64();
+
+    std::vector<uint8_t> buffer(num_bytes);
+    fill_large_message(buffer.data(), num_bytes);
+    ASSERT_EQ(json_data["plaintext_digest"].asString(),
+              to_fnv1a64_digest(buffer.data(), num_bytes));
+
+    zcz_ctx_t ctx;
+    zcz_keysetup(&ctx, context.key);
+
+    zcz_encrypt(&ctx, buffer.data(), num_bytes, buffer.data());
+    EXPECT_EQ(json_data["ciphertext_digest"].asString(),
+              to_fnv1a64_digest(buffer.data(), num_bytes));
+
+    zcz_decrypt(&ctx, buffer.data(), num_bytes, buffer.data());
+    EXPECT_EQ(json_data["plaintext_digest"].asString(),
+              to_fnv1a64_digest(buffer.data(), num_bytes));
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Large, encrypt_decrypt_4_mib_plus_17_bytes) {
+    run_zcz_large_test("testdata/zcz_encrypt_4_mib_plus_17_bytes.json");
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Large, encrypt_decrypt_16_mib) {
+    run_zcz_large_test("testdata/zcz_encrypt_16_mib.json");
+}
+
+// ---------------------------------------------------------------------
+
+// Needs 2 GiB of memory and minutes with the reference implementation, so it
+// only runs if the environment variable ZCZ_TEST_LARGE is set.
+TEST(ZCZ_Large, encrypt_decrypt_2_gib) {
+    if (getenv("ZCZ_TEST_LARGE") == NULL) {
+        GTEST_SKIP();
+    }
+
+    run_zcz_large_test("testdata/zcz_encrypt_2_gib.json");
+}
+
+// ---------------------------------------------------------------------
+// In-place test cases
+// ---------------------------------------------------------------------
+
+#ifdef NI_ENABLED
+static void run_zcz_in_place_test(const std::string& json_path) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+    const size_t num_bytes = context.get_num_plaintext_bytes();
+
+    uint8_t* buffer = (uint8_t*)aligned_alloc(ZCZ_NUM_BYTES_IN_DI_BLOCK,
+                                              num_bytes);
+    memcpy(buffer, context.plaintext, num_bytes);
+
+    zcz_ctx_t ctx;
+    zcz_keysetup(&ctx, context.key);
+
+    zcz_encrypt(&ctx, buffer, num_bytes, buffer);
+    assert_arrays_equal(context.ciphertext, buffer, num_bytes);
+
+    zcz_decrypt(&ctx, buffer, num_bytes, buffer);
+    assert_arrays_equal(context.plaintext, buffer, num_bytes);
+
+    free(buffer);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_InPlace, encrypt_decrypt_256_blocks) {
+    run_zcz_in_place_test("testdata/zcz_encrypt_256_blocks.json");
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_InPlace, encrypt_decrypt_511_blocks) {
+    run_zcz_in_place_test("testdata/zcz_encrypt_511_blocks.json");
+}
+#endif
+
+// ---------------------------------------------------------------------
+// Workspace test cases
+// ---------------------------------------------------------------------
+
+#ifdef NI_ENABLED
+static void run_zcz_workspace_test(const std::string& json_path) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+    const size_t num_bytes = context.get_num_plaintext_bytes();
+
+    // All layers work in place, so the workspace may be NULL.
+    ASSERT_EQ(0u, zcz_workspace_size(num_bytes));
+    uint8_t* workspace = NULL;
+
+    std::vector<uint8_t> ciphertext(num_bytes);
+    std::vector<uint8_t> plaintext(num_bytes);
+
+    zcz_ctx_t ctx;
+    zcz_keysetup(&ctx, context.key);
+
+    zcz_encrypt_ws(&ctx,
+                   context.plaintext,
+                   num_bytes,
+                   ciphertext.data(),
+                   workspace);
+    assert_arrays_equal(context.ciphertext, ciphertext.data(), num_bytes);
+
+    zcz_decrypt_ws(&ctx,
+                   ciphertext.data(),
+                   num_bytes,
+                   plaintext.data(),
+                   workspace);
+    assert_arrays_equal(context.plaintext, plaintext.data(), num_bytes);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Workspace, encrypt_decrypt_256_blocks) {
+    run_zcz_workspace_test("testdata/zcz_encrypt_256_blocks.json");
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Workspace, encrypt_decrypt_511_blocks) {
+    run_zcz_workspace_test("testdata/zcz_encrypt_511_blocks.json");
+}
+#endif
+
+// ---------------------------------------------------------------------
+// Shared context test cases
+// ---------------------------------------------------------------------
+
+#ifdef NI_ENABLED
+static void run_zcz_shared_context_test(const std::string& json_path,
+                                        const size_t num_threads) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+    const size_t num_bytes = context.get_num_plaintext_bytes();
+
+    zcz_ctx_t ctx;
+    zcz_keysetup(&ctx, context.key);
+    const zcz_ctx_t* shared_ctx = &ctx;
+
+    std::vector<std::vector<uint8_t> > ciphertexts(
+        num_threads, std::vector<uint8_t>(num_bytes));
+    std::vector<std::vector<uint8_t> > plaintexts(
+        num_threads, std::vector<uint8_t>(num_bytes));
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            for (size_t j = 0; j < 16; ++j) {
+                zcz_encrypt(shared_ctx,
+                            context.plaintext,
+                            num_bytes,
+                            ciphertexts[i].data());
+                zcz_decrypt(shared_ctx,
+                            ciphertexts[i].data(),
+                            num_bytes,
+                            plaintexts[i].data());
+            }
+        }));
+    }
+
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads[i].join();
+        assert_arrays_equal(context.ciphertext,
+                            ciphertexts[i].data(),
+                            num_bytes);
+        assert_arrays_equal(context.plaintext,
+                            plaintexts[i].data(),
+                            num_bytes);
+    }
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ, shared_context_from_multiple_threads) {
+    run_zcz_shared_context_test("testdata/zcz_encrypt_511_blocks.json", 4);
+}
+#endif
+
+// ---------------------------------------------------------------------
+// Instruction set test cases
+// ---------------------------------------------------------------------
+
+#ifdef NI_ENABLED
+static void run_zcz_isa_test(const std::string& json_path,
+                             const zcz_isa_t isa) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+    const size_t num_bytes = context.get_num_plaintext_bytes();
+
+    zcz_ctx_t ctx;
+
+    if (zcz_keysetup_isa(&ctx, context.key, isa) != 0) {
+        GTEST_SKIP();
+    }
+
+    std::vector<uint8_t> ciphertext(num_bytes);
+    std::vector<uint8_t> plaintext(num_bytes);
+
+    zcz_encrypt(&ctx, context.plaintext, num_bytes, ciphertext.data());
+    assert_arrays_equal(context.ciphertext, ciphertext.data(), num_bytes);
+
+    zcz_decrypt(&ctx, ciphertext.data(), num_bytes, plaintext.data());
+    assert_arrays_equal(context.plaintext, plaintext.data(), num_bytes);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, sse4_511_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_511_blocks.json", ZCZ_ISA_SSE4);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, avx2_511_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_511_blocks.json", ZCZ_ISA_AVX2);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, avx512_511_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_511_blocks.json", ZCZ_ISA_AVX512);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, sse4_1024_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_1024_blocks.json", ZCZ_ISA_SSE4);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, avx2_1024_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_1024_blocks.json", ZCZ_ISA_AVX2);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, avx512_1024_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_1024_blocks.json", ZCZ_ISA_AVX512);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, sse4_basic_256_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_256_blocks.json", ZCZ_ISA_SSE4);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, ssse3_511_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_511_blocks.json", ZCZ_ISA_SSSE3);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, ssse3_1024_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_1024_blocks.json", ZCZ_ISA_SSSE3);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, ssse3_basic_256_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_256_blocks.json", ZCZ_ISA_SSSE3);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, avx2_bitsliced_511_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_511_blocks.json",
+                     ZCZ_ISA_AVX2_BITSLICED);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, avx2_bitsliced_1024_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_1024_blocks.json",
+                     ZCZ_ISA_AVX2_BITSLICED);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_ISA, avx2_bitsliced_basic_256_blocks) {
+    run_zcz_isa_test("testdata/zcz_encrypt_256_blocks.json",
+                     ZCZ_ISA_AVX2_BITSLICED);
+}
+#endif
+
+// ---------------------------------------------------------------------
+// Multi-message test cases
+// ---------------------------------------------------------------------
+
+#ifdef NI_ENABLED
+static void run_zcz_many_test(const std::string& json_path,
+                              const zcz_isa_t isa) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+
+    // Basic and partial lengths, the limits of the interleaved path, and
+    // some that are too short or too long for it
+    const size_t lengths[] = {
+        32, 33, 47, 63, 64, 100, 128, 200, 255, 256, 257, 300,
+        511, 512, 513, 543, 544, 1000, 16, 96, 160, 224, 288, 480
+    };
+    const size_t num_messages = sizeof(lengths) / sizeof(lengths[0]);
+
+    zcz_ctx_t ctx;
+
+    if (zcz_keysetup_isa(&ctx, context.key, isa) != 0) {
+        GTEST_SKIP();
+    }
+
+    std::vector<std::vector<uint8_t> > expected(num_messages);
+    std::vector<std::vector<uint8_t> > ciphertexts(num_messages);
+    std::vector<std::vector<uint8_t> > plaintexts(num_messages);
+    std::vector<zcz_message_t> messages(num_messages);
+
+    for (size_t i = 0; i < num_messages; ++i) {
+        const uint8_t* source = context.plaintext + i * ZCZ_NUM_BYTES_IN_BLOCK;
+
+        ASSERT_LE(i * ZCZ_NUM_BYTES_IN_BLOCK + lengths[i],
+                  context.get_num_plaintext_bytes());
+        // Messages that are too short stay untouched
+        expected[i].assign(source, source + lengths[i]);
+        ciphertexts[i].assign(source, source + lengths[i]);
+        plaintexts[i].resize(lengths[i]);
+
+        zcz_encrypt(&ctx, source, lengths[i], expected[i].data());
+
+        // Every message has a different plaintext and is encrypted in place
+        messages[i].in = ciphertexts[i].data();
+        messages[i].num_bytes = lengths[i];
+        messages[i].out = ciphertexts[i].data();
+    }
+
+    zcz_encrypt_many(&ctx, messages.data(), num_messages);
+
+    for (size_t i = 0; i < num_messages; ++i) {
+        assert_arrays_equal(expected[i].data(),
+                            ciphertexts[i].data(),
+                            lengths[i]);
+
+        messages[i].in = ciphertexts[i].data();
+        messages[i].out = plaintexts[i].data();
+    }
+
+    zcz_decrypt_many(&ctx, messages.data(), num_messages);
+
+    for (size_t i = 0; i < num_messages; ++i) {
+        if (lengths[i] >= ZCZ_MIN_NUM_MESSAGE_BYTES) {
+            assert_arrays_equal(context.plaintext + i * ZCZ_NUM_BYTES_IN_BLOCK,
+                                plaintexts[i].data(),
+                                lengths[i]);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Many, ssse3_encrypt_decrypt) {
+    run_zcz_many_test("testdata/zcz_encrypt_511_blocks.json", ZCZ_ISA_SSSE3);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Many, avx2_bitsliced_encrypt_decrypt) {
+    run_zcz_many_test("testdata/zcz_encrypt_511_blocks.json",
+                      ZCZ_ISA_AVX2_BITSLICED);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Many, sse4_encrypt_decrypt) {
+    run_zcz_many_test("testdata/zcz_encrypt_511_blocks.json", ZCZ_ISA_SSE4);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Many, avx2_encrypt_decrypt) {
+    run_zcz_many_test("testdata/zcz_encrypt_511_blocks.json", ZCZ_ISA_AVX2);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Many, avx512_encrypt_decrypt) {
+    run_zcz_many_test("testdata/zcz_encrypt_511_blocks.json", ZCZ_ISA_AVX512);
+}
+#endif
+
+// ---------------------------------------------------------------------
+// Recompute test cases
+// ---------------------------------------------------------------------
+
+#ifdef NI_ENABLED
+static void append_output(void* output_context,
+                          const uint8_t* bytes,
+                          const size_t num_bytes) {
+    std::vector<uint8_t>* output = (std::vector<uint8_t>*)output_context;
+    ASSERT_LE(num_bytes, (size_t)ZCZ_NUM_BYTES_IN_CHUNK);
+    output->insert(output->end(), bytes, bytes + num_bytes);
+}
+
+// ---------------------------------------------------------------------
+
+static void run_zcz_recompute_test(const std::string& json_path) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+    const size_t num_bytes = context.get_num_plaintext_bytes();
+
+    std::vector<uint8_t> ciphertext;
+    std::vector<uint8_t> plaintext;
+
+    zcz_ctx_t ctx;
+    zcz_keysetup(&ctx, context.key);
+
+    zcz_encrypt_recompute(&ctx,
+                          context.plaintext,
+                          num_bytes,
+                          append_output,
+                          &ciphertext);
+    ASSERT_EQ(num_bytes, ciphertext.size());
+    assert_arrays_equal(context.ciphertext, ciphertext.data(), num_bytes);
+
+    zcz_decrypt_recompute(&ctx,
+                          context.ciphertext,
+                          num_bytes,
+                          append_output,
+                          &plaintext);
+    ASSERT_EQ(num_bytes, plaintext.size());
+    assert_arrays_equal(context.plaintext, plaintext.data(), num_bytes);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Recompute, encrypt_decrypt_3_blocks) {
+    run_zcz_recompute_test("testdata/zcz_encrypt_3_blocks.json");
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Recompute, encrypt_decrypt_256_blocks) {
+    run_zcz_recompute_test("testdata/zcz_encrypt_256_blocks.json");
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Recompute, encrypt_decrypt_257_blocks) {
+    run_zcz_recompute_test("testdata/zcz_encrypt_257_blocks.json");
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Recompute, encrypt_decrypt_511_blocks) {
+    run_zcz_recompute_test("testdata/zcz_encrypt_511_blocks.json");
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Recompute, encrypt_decrypt_1024_blocks) {
+    run_zcz_recompute_test("testdata/zcz_encrypt_1024_blocks.json");
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Hashes the output as it streams in, so that the ciphertext of a large
+ * message is never held in memory.
+ */
+static void hash_output(void* output_context,
+                        const uint8_t* bytes,
+                        const size_t num_bytes) {
+    uint64_t* digest = (uint64_t*)output_context;
+    *digest = update_fnv1a64(*digest, bytes, num_bytes);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Recompute, encrypt_4_mib_plus_17_bytes) {
+    JSONParser json_parser;
+    const Json::Value json_data =
+        json_parser.parse("testdata/zcz_encrypt_4_mib_plus_17_bytes.json");
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+    const size_t num_bytes = json_data["num_message_bytes"].asUInt64();
+
+    std::vector<uint8_t> plaintext(num_bytes);
+    fill_large_message(plaintext.data(), num_bytes);
+
+    zcz_ctx_t ctx;
+    zcz_keysetup(&ctx, context.key);
+
+    uint64_t digest = FNV1A64_OFFSET_BASIS;
+
+    zcz_encrypt_recompute(&ctx,
+                          plaintext.data(),
+                          num_bytes,
+                          hash_output,
+                          &digest);
+    EXPECT_EQ(json_data["ciphertext_digest"].asString(),
+              format_fnv1a64(digest));
+}
+#endif
+
+// ---------------------------------------------------------------------
+// Parallel test cases
+// ---------------------------------------------------------------------
+
+#ifdef NI_ENABLED
+static void run_zcz_parallel_test(const std::string& json_path,
+                                  const size_t num_threads) {
+    JSONParser json_parser;
+    const Json::Value json_data = json_parser.parse(json_path);
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+    const size_t num_bytes = context.get_num_plaintext_bytes();
+
+    std::vector<uint8_t> ciphertext(num_bytes);
+    std::vector<uint8_t> plaintext(num_bytes);
+
+    zcz_ctx_t ctx;
+    zcz_keysetup(&ctx, context.key);
+
+    zcz_pool_t* pool = zcz_pool_create(num_threads);
+    ASSERT_NE(nullptr, pool);
+
+    zcz_encrypt_parallel(&ctx,
+                         pool,
+                         context.plaintext,
+                         num_bytes,
+                         ciphertext.data());
+    assert_arrays_equal(context.ciphertext, ciphertext.data(), num_bytes);
+
+    zcz_decrypt_parallel(&ctx,
+                         pool,
+                         ciphertext.data(),
+                         num_bytes,
+                         plaintext.data());
+    assert_arrays_equal(context.plaintext, plaintext.data(), num_bytes);
+
+    zcz_pool_destroy(pool);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Parallel, encrypt_decrypt_256_blocks_1_thread) {
+    run_zcz_parallel_test("testdata/zcz_encrypt_256_blocks.json", 1);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Parallel, encrypt_decrypt_256_blocks_4_threads) {
+    run_zcz_parallel_test("testdata/zcz_encrypt_256_blocks.json", 4);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Parallel, encrypt_decrypt_511_blocks_3_threads) {
+    run_zcz_parallel_test("testdata/zcz_encrypt_511_blocks.json", 3);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Parallel, encrypt_decrypt_1024_blocks_8_threads) {
+    run_zcz_parallel_test("testdata/zcz_encrypt_1024_blocks.json", 8);
+}
+
+// ---------------------------------------------------------------------
+
+/**
+ * Messages around ZCZ_PARALLEL_MIN_NUM_BYTES have no test vectors; they are
+ * compared with zcz_encrypt() instead.
+ */
+static void run_zcz_parallel_vs_serial_test(const size_t num_bytes,
+                                            const size_t num_threads) {
+    uint8_t key[ZCZ_NUM_KEY_BYTES];
+    std::vector<uint8_t> plaintext(num_bytes);
+    std::vector<uint8_t> expected(num_bytes);
+    std::vector<uint8_t> actual(num_bytes);
+
+    fill_large_message(key, ZCZ_NUM_KEY_BYTES);
+    fill_large_message(plaintext.data(), num_bytes);
+
+    zcz_ctx_t ctx;
+    zcz_keysetup(&ctx, key);
+    zcz_encrypt(&ctx, plaintext.data(), num_bytes, expected.data());
+
+    zcz_pool_t* pool = zcz_pool_create(num_threads);
+    ASSERT_NE(nullptr, pool);
+
+    zcz_encrypt_parallel(&ctx,
+                         pool,
+                         plaintext.data(),
+                         num_bytes,
+                         actual.data());
+    assert_arrays_equal(expected.data(), actual.data(), num_bytes);
+
+    zcz_decrypt_parallel(&ctx, pool, actual.data(), num_bytes, actual.data());
+    assert_arrays_equal(plaintext.data(), actual.data(), num_bytes);
+
+    zcz_pool_destroy(pool);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Parallel, encrypt_decrypt_at_threshold_2_threads) {
+    run_zcz_parallel_vs_serial_test(ZCZ_PARALLEL_MIN_NUM_BYTES, 2);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Parallel, encrypt_decrypt_40005_bytes_3_threads) {
+    run_zcz_parallel_vs_serial_test(40005, 3);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Parallel, encrypt_decrypt_1_mib_plus_31_bytes_64_threads) {
+    run_zcz_parallel_vs_serial_test((1 << 20) + 31, 64);
+}
+
+// ---------------------------------------------------------------------
+
+TEST(ZCZ_Parallel, encrypt_decrypt_4_mib_plus_17_bytes) {
+    JSONParser json_parser;
+    const Json::Value json_data =
+        json_parser.parse("testdata/zcz_encrypt_4_mib_plus_17_bytes.json");
+    ZCZTestCaseContext context = json_parser.create_zcz_test_case(json_data);
+    const size_t num_bytes = json_data["num_message_bytes"].asUInt64();
+
+    std::vector<uint8_t> buffer(num_bytes);
+    fill_large_message(buffer.data(), num_bytes);
+
+    zcz_ctx_t ctx;
+    zcz_keysetup(&ctx, context.key);
+
+    zcz_pool_t* pool = zcz_pool_create(5);
+    ASSERT_NE(nullptr, pool);
+
+    zcz_encrypt_parallel(&ctx, pool, buffer.data(), num_bytes, buffer.data());
+    EXPECT_EQ(json_data["ciphertext_digest"].asString(),
+              to_fnv1a64_digest(buffer.data(), num_bytes));
+
+    zcz_decrypt_parallel(&ctx, pool, buffer.data(), num_bytes, buffer.data());
+    EXPECT_EQ(json_data["plaintext_digest"].asString(),
+              to_fnv1a64_digest(buffer.data(), num_bytes));
+
+    zcz_pool_destroy(pool);
+}
 #endif
 
 // ---------------------------------------------------------------------